@@ -25,8 +25,14 @@
 #include "uvm_ats_faults.h"
 #include "uvm_migrate_pageable.h"
 
+// Faults in the same VMA and in the same naturally-aligned window of this size
+// are serviced with a single call to uvm_migrate_pageable. Pages between the
+// faulting pages of a window are populated, too.
+#define UVM_ATS_FAULT_WINDOW_SIZE UVM_VA_BLOCK_SIZE
+
 static NV_STATUS uvm_ats_service_fault(uvm_gpu_va_space_t *gpu_va_space,
-                                       NvU64 fault_addr,
+                                       NvU64 start,
+                                       NvU64 length,
                                        uvm_fault_access_type_t access_type)
 {
     uvm_va_space_t *va_space = gpu_va_space->va_space;
@@ -66,8 +72,8 @@ static NV_STATUS uvm_ats_service_fault(uvm_gpu_va_space_t *gpu_va_space,
     {
         .va_space               = va_space,
         .mm                     = mm,
-        .start                  = fault_addr,
-        .length                 = PAGE_SIZE,
+        .start                  = start,
+        .length                 = length,
         .dst_id                 = gpu_va_space->gpu->parent->id,
         .dst_node_id            = -1,
         .populate_permissions   = write ? UVM_POPULATE_PERMISSIONS_WRITE : UVM_POPULATE_PERMISSIONS_ANY,
@@ -79,8 +85,6 @@ static NV_STATUS uvm_ats_service_fault(uvm_gpu_va_space_t *gpu_va_space,
 
     UVM_ASSERT(uvm_ats_can_service_faults(gpu_va_space, mm));
 
-    // TODO: Bug 2103669: Service more than a single fault at a time
-    //
     // We are trying to use migrate_vma API in the kernel (if it exists) to
     // populate and map the faulting region on the GPU. We want to do this only
     // on the first touch. That is, pages which are not already mapped. So, we
@@ -95,14 +99,157 @@ static NV_STATUS uvm_ats_service_fault(uvm_gpu_va_space_t *gpu_va_space,
     return status;
 }
 
+// ATS lookups are disabled on all addresses within the same
+// UVM_GMMU_ATS_GRANULARITY as existing GMMU mappings (see documentation in
+// uvm_mmu.h). Returns whether address falls in such a region. The result is
+// cached in ats_context, if not NULL.
+static bool uvm_ats_fault_in_gmmu_region(uvm_va_space_t *va_space,
+                                         NvU64 address,
+                                         uvm_ats_fault_context_t *ats_context)
+{
+    NvU64 gmmu_region_base = UVM_ALIGN_DOWN(address, UVM_GMMU_ATS_GRANULARITY);
+    bool in_gmmu_region;
+
+    if (ats_context &&
+        ats_context->gmmu_region_va_space == va_space &&
+        ats_context->gmmu_region_base == gmmu_region_base)
+        return ats_context->in_gmmu_region;
+
+    in_gmmu_region = !uvm_va_space_range_empty(va_space,
+                                               gmmu_region_base,
+                                               gmmu_region_base + UVM_GMMU_ATS_GRANULARITY - 1);
+
+    if (ats_context) {
+        ats_context->gmmu_region_va_space = va_space;
+        ats_context->gmmu_region_base = gmmu_region_base;
+        ats_context->in_gmmu_region = in_gmmu_region;
+    }
+
+    return in_gmmu_region;
+}
+
+static bool uvm_ats_fault_in_window(uvm_ats_fault_context_t *ats_context, uvm_fault_buffer_entry_t *entry)
+{
+    return ats_context &&
+           ats_context->window_va_space == entry->va_space &&
+           entry->fault_address >= ats_context->window_start &&
+           entry->fault_address < ats_context->window_end;
+}
+
+// Returns whether the fault has already been serviced by
+// uvm_ats_service_fault_window with the given access type
+static bool uvm_ats_fault_window_serviced(uvm_ats_fault_context_t *ats_context,
+                                          uvm_fault_buffer_entry_t *entry,
+                                          uvm_fault_access_type_t access_type)
+{
+    if (!uvm_ats_fault_in_window(ats_context, entry) || !ats_context->window_serviced)
+        return false;
+
+    return ats_context->window_write || access_type <= UVM_FAULT_ACCESS_TYPE_READ;
+}
+
+void uvm_ats_fault_context_reset(uvm_ats_fault_context_t *ats_context)
+{
+    memset(ats_context, 0, sizeof(*ats_context));
+}
+
+NV_STATUS uvm_ats_service_fault_window(uvm_gpu_va_space_t *gpu_va_space,
+                                       uvm_fault_buffer_entry_t **entries,
+                                       NvU32 num_entries,
+                                       uvm_ats_fault_context_t *ats_context)
+{
+    uvm_fault_buffer_entry_t *first_entry = entries[0];
+    uvm_va_space_t *va_space = first_entry->va_space;
+    struct mm_struct *mm = va_space->va_space_mm.mm;
+    uvm_fault_access_type_t access_type = UVM_FAULT_ACCESS_TYPE_READ;
+    struct vm_area_struct *vma;
+    NvU64 window_start;
+    NvU64 window_end;
+    NvU64 last_address;
+    NvU64 start_time;
+    NvU32 i;
+    NV_STATUS status;
+    uvm_replayable_fault_buffer_info_t *replayable = &gpu_va_space->gpu->parent->fault_buffer_info.replayable;
+
+    UVM_ASSERT(g_uvm_global.ats.enabled);
+    UVM_ASSERT(gpu_va_space->ats.enabled);
+    UVM_ASSERT(uvm_ats_can_service_faults(gpu_va_space, mm));
+    UVM_ASSERT(num_entries > 0);
+    UVM_ASSERT(ats_context);
+
+    // Faults in the last window, serviced or not, are not considered again
+    if (uvm_ats_fault_in_window(ats_context, first_entry))
+        return NV_OK;
+
+    if (uvm_ats_fault_in_gmmu_region(va_space, first_entry->fault_address, ats_context))
+        return NV_OK;
+
+    vma = find_vma(mm, first_entry->fault_address);
+    if (!vma || vma->vm_start > first_entry->fault_address)
+        return NV_OK;
+
+    // The window never crosses a UVM_GMMU_ATS_GRANULARITY boundary, so the
+    // GMMU region check above covers all the faults in it.
+    BUILD_BUG_ON(UVM_GMMU_ATS_GRANULARITY % UVM_ATS_FAULT_WINDOW_SIZE != 0);
+    window_start = first_entry->fault_address;
+    window_end = min((NvU64)vma->vm_end,
+                     UVM_ALIGN_DOWN(window_start, UVM_ATS_FAULT_WINDOW_SIZE) + UVM_ATS_FAULT_WINDOW_SIZE);
+    last_address = window_start;
+
+    // Faults are sorted by VA space and address
+    for (i = 0; i < num_entries; i++) {
+        uvm_fault_buffer_entry_t *entry = entries[i];
+
+        if (entry->va_space != va_space || entry->fault_address >= window_end)
+            break;
+
+        if (entry->fault_access_type != UVM_FAULT_ACCESS_TYPE_PREFETCH)
+            access_type = max(access_type, entry->fault_access_type);
+
+        last_address = entry->fault_address;
+    }
+
+    ats_context->window_va_space = va_space;
+    ats_context->window_start = window_start;
+    ats_context->window_end = last_address + PAGE_SIZE;
+    ats_context->window_serviced = false;
+    ats_context->window_write = access_type > UVM_FAULT_ACCESS_TYPE_READ;
+
+    // Let the per-fault path handle isolated faults
+    if (last_address == window_start)
+        return NV_OK;
+
+    start_time = NV_GETTIME();
+
+    status = uvm_ats_service_fault(gpu_va_space, window_start, ats_context->window_end - window_start, access_type);
+
+    // Faults in windows that cannot be serviced as a whole, for example
+    // because of write faults on read-only pages, are serviced individually so
+    // that the fatal ones can be identified.
+    if (status == NV_ERR_INVALID_ADDRESS)
+        return NV_OK;
+
+    if (status != NV_OK)
+        return status;
+
+    ats_context->window_serviced = true;
+
+    ++replayable->stats.num_ats_windows;
+    replayable->stats.num_ats_window_pages += (ats_context->window_end - window_start) / PAGE_SIZE;
+    replayable->stats.ats_window_ns += NV_GETTIME() - start_time;
+
+    return NV_OK;
+}
+
 NV_STATUS uvm_ats_service_fault_entry(uvm_gpu_va_space_t *gpu_va_space,
                                       uvm_fault_buffer_entry_t *current_entry,
+                                      uvm_ats_fault_context_t *ats_context,
                                       uvm_ats_fault_invalidate_t *ats_invalidate)
 {
-    NvU64 gmmu_region_base;
     bool in_gmmu_region;
     NV_STATUS status = NV_OK;
     uvm_fault_access_type_t service_access_type;
+    const NvU64 fault_page = current_entry->fault_address;
 
     UVM_ASSERT(g_uvm_global.ats.enabled);
     UVM_ASSERT(gpu_va_space->ats.enabled);
@@ -113,25 +260,21 @@ NV_STATUS uvm_ats_service_fault_entry(uvm_gpu_va_space_t *gpu_va_space,
 
     service_access_type = current_entry->fault_access_type;
 
-    // ATS lookups are disabled on all addresses within the same
-    // UVM_GMMU_ATS_GRANULARITY as existing GMMU mappings (see documentation in
-    // uvm_mmu.h). User mode is supposed to reserve VAs as appropriate to
-    // prevent any system memory allocations from falling within the NO_ATS
-    // range of other GMMU mappings, so this shouldn't happen during normal
-    // operation. However, since this scenario may lead to infinite fault loops,
-    // we handle it by canceling the fault.
-    //
-    // TODO: Bug 2103669: Remove redundant VA range lookups
-    gmmu_region_base = UVM_ALIGN_DOWN(current_entry->fault_address, UVM_GMMU_ATS_GRANULARITY);
-    in_gmmu_region = !uvm_va_space_range_empty(current_entry->va_space,
-                                               gmmu_region_base,
-                                               gmmu_region_base + UVM_GMMU_ATS_GRANULARITY - 1);
+    // User mode is supposed to reserve VAs as appropriate to prevent any
+    // system memory allocations from falling within the NO_ATS range of other
+    // GMMU mappings, so this shouldn't happen during normal operation.
+    // However, since this scenario may lead to infinite fault loops, we handle
+    // it by canceling the fault.
+    in_gmmu_region = uvm_ats_fault_in_gmmu_region(current_entry->va_space, fault_page, ats_context);
     if (in_gmmu_region) {
         status = NV_ERR_INVALID_ADDRESS;
     }
+    else if (uvm_ats_fault_window_serviced(ats_context, current_entry, service_access_type)) {
+        // Already serviced by uvm_ats_service_fault_window
+        status = NV_OK;
+    }
     else {
-        // TODO: Bug 2103669: Service more than a single fault at a time
-        status = uvm_ats_service_fault(gpu_va_space, current_entry->fault_address, service_access_type);
+        status = uvm_ats_service_fault(gpu_va_space, fault_page, PAGE_SIZE, service_access_type);
     }
 
     // Do not flag prefetch faults as fatal unless something fatal happened
@@ -154,7 +297,8 @@ NV_STATUS uvm_ats_service_fault_entry(uvm_gpu_va_space_t *gpu_va_space,
                     current_entry->fault_access_type > UVM_FAULT_ACCESS_TYPE_READ &&
                     uvm_fault_access_type_mask_test(current_entry->access_type_mask, UVM_FAULT_ACCESS_TYPE_READ)) {
                     status = uvm_ats_service_fault(gpu_va_space,
-                                                   current_entry->fault_address,
+                                                   fault_page,
+                                                   PAGE_SIZE,
                                                    UVM_FAULT_ACCESS_TYPE_READ);
 
                     // If read accesses are also invalid, cancel the fault. If a
@@ -26,10 +26,33 @@
 #include "uvm_global.h"
 #include "uvm_va_space.h"
 
+// Service the ATS fault in current_entry. ats_context may be NULL. Otherwise,
+// the fault is not serviced again if it falls in the window already serviced
+// by uvm_ats_service_fault_window, and the GMMU region check is cached.
 NV_STATUS uvm_ats_service_fault_entry(uvm_gpu_va_space_t *gpu_va_space,
                                       uvm_fault_buffer_entry_t *current_entry,
+                                      uvm_ats_fault_context_t *ats_context,
                                       uvm_ats_fault_invalidate_t *ats_invalidate);
 
+// Service the ATS faults in entries, which must be sorted by VA space and
+// address, with a single migration. The window starts at the first fault and
+// includes all the following faults in the same VA space, VMA and
+// naturally-aligned UVM_VA_BLOCK_SIZE region. On success, the serviced window
+// is recorded in ats_context, and uvm_ats_service_fault_entry must still be
+// called on every fault in the window to complete fault bookkeeping.
+//
+// Windows that contain a single page, or that cannot be serviced as a whole,
+// are not recorded and NV_OK is returned: their faults are serviced
+// individually by uvm_ats_service_fault_entry. Other errors are returned.
+NV_STATUS uvm_ats_service_fault_window(uvm_gpu_va_space_t *gpu_va_space,
+                                       uvm_fault_buffer_entry_t **entries,
+                                       NvU32 num_entries,
+                                       uvm_ats_fault_context_t *ats_context);
+
+// Forget the serviced window and the cached GMMU region check. Must be called
+// at the beginning of every fault batch.
+void uvm_ats_fault_context_reset(uvm_ats_fault_context_t *ats_context);
+
 // This function performs pending TLB invalidations for ATS and clears the
 // ats_invalidate->write_faults_in_batch flag
 NV_STATUS uvm_ats_invalidate_tlbs(uvm_gpu_va_space_t *gpu_va_space,
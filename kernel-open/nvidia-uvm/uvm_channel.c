@@ -62,6 +62,11 @@ static NV_STATUS manager_create_procfs_dirs(uvm_channel_manager_t *manager);
 static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager);
 static NV_STATUS channel_create_procfs(uvm_channel_t *channel);
 
+// How long channel reservations spin waiting for a GPFIFO entry to free up
+// before napping between progress updates, and how long each nap is.
+#define UVM_CHANNEL_RESERVE_SPIN_NS (50 * 1000ULL)
+#define UVM_CHANNEL_RESERVE_NAP_US 20
+
 typedef enum
 {
     // Only remove completed GPFIFO entries from the pushbuffer
@@ -97,6 +102,8 @@ static NvU32 uvm_channel_update_progress_with_max(uvm_channel_t *channel,
 
         uvm_pushbuffer_mark_completed(channel->pool->manager->pushbuffer, entry);
         list_add_tail(&entry->push_info->available_list_node, &channel->available_push_infos);
+        UVM_ASSERT(channel->pending_bytes >= entry->pushbuffer_size);
+        channel->pending_bytes -= entry->pushbuffer_size;
         gpu_get = (gpu_get + 1) % channel->num_gpfifo_entries;
         ++completed_count;
     }
@@ -159,6 +166,38 @@ static bool channel_is_available(uvm_channel_t *channel)
     return (next_put != channel->gpu_get);
 }
 
+// Number of GPFIFO entries either pending on the GPU or claimed by on-going
+// pushes.
+static NvU32 channel_get_occupancy(uvm_channel_t *channel)
+{
+    NvU32 pending_gpfifos;
+
+    uvm_assert_spinlock_locked(&channel->pool->lock);
+
+    if (channel->cpu_put >= channel->gpu_get)
+        pending_gpfifos = channel->cpu_put - channel->gpu_get;
+    else
+        pending_gpfifos = channel->num_gpfifo_entries - channel->gpu_get + channel->cpu_put;
+
+    return pending_gpfifos + channel->current_pushes_count;
+}
+
+static void channel_claim(uvm_channel_t *channel, NvU32 occupancy)
+{
+    NvU32 bucket;
+
+    uvm_assert_spinlock_locked(&channel->pool->lock);
+    UVM_ASSERT(channel_is_available(channel));
+
+    ++channel->current_pushes_count;
+
+    bucket = (NvU32)(((NvU64)occupancy * UVM_CHANNEL_OCCUPANCY_BUCKETS) / channel->num_gpfifo_entries);
+    UVM_ASSERT(bucket < UVM_CHANNEL_OCCUPANCY_BUCKETS);
+
+    ++channel->stats.reservations;
+    ++channel->stats.occupancy[bucket];
+}
+
 static bool try_claim_channel(uvm_channel_t *channel)
 {
     bool claimed = false;
@@ -166,7 +205,7 @@ static bool try_claim_channel(uvm_channel_t *channel)
     uvm_spin_lock(&channel->pool->lock);
 
     if (channel_is_available(channel)) {
-        ++channel->current_pushes_count;
+        channel_claim(channel, channel_get_occupancy(channel));
         claimed = true;
     }
 
@@ -175,15 +214,68 @@ static bool try_claim_channel(uvm_channel_t *channel)
     return claimed;
 }
 
-static void lock_push(uvm_channel_t *channel)
+// Claim the least busy available channel in the pool, if any. Channels are
+// ordered by the number of occupied GPFIFO entries first, and by the number of
+// pushbuffer bytes in flight second. The scan starts at a rotating index so
+// that ties are broken in a round-robin fashion across callers.
+static uvm_channel_t *try_claim_least_busy_channel(uvm_channel_pool_t *pool)
 {
+    uvm_channel_t *best = NULL;
+    NvU32 best_occupancy = 0;
+    NvU32 start;
+    NvU32 i;
+
+    start = (NvU32)atomic_inc_return(&pool->next_channel) % pool->num_channels;
+
+    uvm_spin_lock(&pool->lock);
 
+    for (i = 0; i < pool->num_channels; i++) {
+        uvm_channel_t *channel = pool->channels + (start + i) % pool->num_channels;
+        NvU32 occupancy;
 
+        if (!channel_is_available(channel))
+            continue;
+
+        occupancy = channel_get_occupancy(channel);
+        if (best == NULL ||
+            occupancy < best_occupancy ||
+            (occupancy == best_occupancy && channel->pending_bytes < best->pending_bytes)) {
+            best = channel;
+            best_occupancy = occupancy;
 
+            // Can't do better than an idle channel
+            if (occupancy == 0)
+                break;
+        }
+    }
 
+    if (best)
+        channel_claim(best, best_occupancy);
+
+    uvm_spin_unlock(&pool->lock);
+
+    return best;
 }
 
-static void unlock_push(uvm_channel_t *channel)
+// Back off between attempts to reserve a GPFIFO entry.
+//
+// Short waits spin, as GPFIFO entries usually complete quickly. Completions
+// are only noticed when the caller updates the channel progress, so longer
+// waits nap for a few tens of microseconds at a time rather than sleeping
+// until a wakeup that may never come. usleep_range is used because msleep
+// and timed waits have jiffy granularity, which is orders of magnitude longer
+// than a typical push takes to complete.
+static void channel_reserve_wait(uvm_spin_loop_t *spin)
+{
+    if (NV_MAY_SLEEP() && uvm_spin_loop_elapsed(spin) >= UVM_CHANNEL_RESERVE_SPIN_NS)
+        usleep_range(UVM_CHANNEL_RESERVE_NAP_US, 2 * UVM_CHANNEL_RESERVE_NAP_US);
+
+    // Still go through the spin loop helper to get the periodic warning when
+    // stuck waiting for too long.
+    UVM_SPIN_LOOP(spin);
+}
+
+static void lock_push(uvm_channel_t *channel)
 {
 
 
@@ -191,13 +283,12 @@ static void unlock_push(uvm_channel_t *channel)
 
 }
 
-static bool trylock_push(uvm_channel_t *channel)
+static void unlock_push(uvm_channel_t *channel)
 {
 
 
 
 
-    return true;
 }
 
 // Reserve a channel in the specified pool
@@ -208,22 +299,11 @@ static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool, uvm_channel_t
 
     UVM_ASSERT(pool);
 
-    uvm_for_each_channel_in_pool(channel, pool) {
-        // TODO: Bug 1764953: Prefer idle/less busy channels
-
-
-
-
-
-        if (trylock_push(channel)) {
-            if (try_claim_channel(channel)) {
-                *channel_out = channel;
-                return NV_OK;
-            }
-            else {
-                unlock_push(channel);
-            }
-        }
+    channel = try_claim_least_busy_channel(pool);
+    if (channel) {
+        lock_push(channel);
+        *channel_out = channel;
+        return NV_OK;
     }
 
     uvm_spin_loop_init(&spin);
@@ -233,19 +313,20 @@ static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool, uvm_channel_t
 
             uvm_channel_update_progress(channel);
 
-            if (try_claim_channel(channel)) {
-                lock_push(channel);
-                *channel_out = channel;
-
-                return NV_OK;
-            }
-
             status = uvm_channel_check_errors(channel);
             if (status != NV_OK)
                 return status;
+        }
 
-            UVM_SPIN_LOOP(&spin);
+        channel = try_claim_least_busy_channel(pool);
+        if (channel) {
+            lock_push(channel);
+            *channel_out = channel;
+
+            return NV_OK;
         }
+
+        channel_reserve_wait(&spin);
     }
 
     UVM_ASSERT_MSG(0, "Cannot get here?!\n");
@@ -438,6 +519,8 @@ void uvm_channel_end_push(uvm_push_t *push)
     entry->pushbuffer_size = push_size;
     entry->push_info = &channel->push_infos[push->push_info_index];
 
+    channel->pending_bytes += push_size;
+
     UVM_ASSERT(channel->current_pushes_count > 0);
     --channel->current_pushes_count;
 
@@ -479,7 +562,7 @@ NV_STATUS uvm_channel_reserve(uvm_channel_t *channel)
 
     uvm_spin_loop_init(&spin);
     while (!try_claim_channel(channel) && status == NV_OK) {
-        UVM_SPIN_LOOP(&spin);
+        channel_reserve_wait(&spin);
         status = uvm_channel_check_errors(channel);
         uvm_channel_update_progress(channel);
     }
@@ -916,6 +999,7 @@ static NV_STATUS channel_pool_add(uvm_channel_manager_t *channel_manager,
     pool->pool_type = pool_type;
 
     uvm_spin_lock_init(&pool->lock, UVM_LOCK_ORDER_CHANNEL);
+    atomic_set(&pool->next_channel, 0);
 
     num_channels = channel_pool_type_num_channels(pool_type);
 
@@ -1550,6 +1634,8 @@ const char *uvm_channel_pool_type_to_string(uvm_channel_pool_type_t channel_pool
 static void uvm_channel_print_info(uvm_channel_t *channel, struct seq_file *s)
 {
     uvm_channel_manager_t *manager = channel->pool->manager;
+    NvU32 i;
+
     UVM_SEQ_OR_DBG_PRINT(s, "Channel %s\n", channel->name);
 
     uvm_spin_lock(&channel->pool->lock);
@@ -1562,6 +1648,16 @@ static void uvm_channel_print_info(uvm_channel_t *channel, struct seq_file *s)
     UVM_SEQ_OR_DBG_PRINT(s, "get                %u\n", channel->gpu_get);
     UVM_SEQ_OR_DBG_PRINT(s, "put                %u\n", channel->cpu_put);
     UVM_SEQ_OR_DBG_PRINT(s, "Semaphore GPU VA   0x%llx\n", uvm_channel_tracking_semaphore_get_gpu_va(channel));
+    UVM_SEQ_OR_DBG_PRINT(s, "pending bytes      %llu\n", channel->pending_bytes);
+    UVM_SEQ_OR_DBG_PRINT(s, "reservations       %llu\n", channel->stats.reservations);
+
+    for (i = 0; i < UVM_CHANNEL_OCCUPANCY_BUCKETS; i++) {
+        UVM_SEQ_OR_DBG_PRINT(s,
+                             "occupancy %3u-%3u%% %llu\n",
+                             (i * 100) / UVM_CHANNEL_OCCUPANCY_BUCKETS,
+                             ((i + 1) * 100) / UVM_CHANNEL_OCCUPANCY_BUCKETS,
+                             channel->stats.occupancy[i]);
+    }
 
     uvm_spin_unlock(&channel->pool->lock);
 }
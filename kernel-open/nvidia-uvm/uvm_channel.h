@@ -111,6 +111,9 @@ typedef enum
     UVM_CHANNEL_POOL_TYPE_MASK  = ((1U << UVM_CHANNEL_POOL_TYPE_COUNT) - 1)
 } uvm_channel_pool_type_t;
 
+// Number of buckets in the per-channel GPFIFO occupancy histogram
+#define UVM_CHANNEL_OCCUPANCY_BUCKETS 8
+
 struct uvm_gpfifo_entry_struct
 {
     // Offset of the pushbuffer in the pushbuffer allocation used by this entry
@@ -151,6 +154,11 @@ typedef struct
 
     // Lock protecting the state of channels in the pool
     uvm_spinlock_t lock;
+
+    // Rotating start index used when selecting a channel, so that concurrent
+    // reservations spread over equally loaded channels instead of all
+    // landing on the first one.
+    atomic_t next_channel;
 } uvm_channel_pool_t;
 
 struct uvm_channel_struct
@@ -200,6 +208,24 @@ struct uvm_channel_struct
     // Each push on the channel increments the semaphore, see
     // uvm_channel_end_push().
     uvm_gpu_tracking_semaphore_t tracking_sem;
+
+    // Pushbuffer bytes submitted on the channel and not yet completed. Used,
+    // together with the number of pending GPFIFO entries, to pick the least
+    // busy channel of the pool. Protected by the pool lock.
+    NvU64 pending_bytes;
+
+    // Utilization statistics reported in the procfs info file. Protected by
+    // the pool lock.
+    struct
+    {
+        // Number of times the channel has been reserved
+        NvU64 reservations;
+
+        // Histogram of the GPFIFO occupancy (pending plus on-going pushes)
+        // observed at reservation time. Bucket i covers the range
+        // [i, i + 1) / UVM_CHANNEL_OCCUPANCY_BUCKETS of the GPFIFO entries.
+        NvU64 occupancy[UVM_CHANNEL_OCCUPANCY_BUCKETS];
+    } stats;
 
 
 
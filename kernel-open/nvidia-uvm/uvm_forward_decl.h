@@ -85,6 +85,7 @@ typedef struct uvm_fault_service_batch_context_struct uvm_fault_service_batch_co
 typedef struct uvm_service_block_context_struct uvm_service_block_context_t;
 
 typedef struct uvm_ats_fault_invalidate_struct uvm_ats_fault_invalidate_t;
+typedef struct uvm_ats_fault_context_struct uvm_ats_fault_context_t;
 
 typedef struct uvm_replayable_fault_buffer_info_struct uvm_replayable_fault_buffer_info_t;
 typedef struct uvm_non_replayable_fault_buffer_info_struct uvm_non_replayable_fault_buffer_info_t;
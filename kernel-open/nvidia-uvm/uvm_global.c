@@ -118,6 +118,24 @@ NV_STATUS uvm_global_init(void)
         goto error;
     }
 
+    status = uvm_kvmalloc_procfs_init();
+    if (status != NV_OK) {
+        UVM_ERR_PRINT("uvm_kvmalloc_procfs_init() failed: %s\n", nvstatusToString(status));
+        goto error;
+    }
+
+    status = uvm_thread_context_procfs_init();
+    if (status != NV_OK) {
+        UVM_ERR_PRINT("uvm_thread_context_procfs_init() failed: %s\n", nvstatusToString(status));
+        goto error;
+    }
+
+    status = uvm_va_space_procfs_init();
+    if (status != NV_OK) {
+        UVM_ERR_PRINT("uvm_va_space_procfs_init() failed: %s\n", nvstatusToString(status));
+        goto error;
+    }
+
     status = uvm_rm_locked_call(nvUvmInterfaceSessionCreate(&g_uvm_global.rm_session_handle, &platform_info));
     if (status != NV_OK) {
         UVM_ERR_PRINT("nvUvmInterfaceSessionCreate() failed: %s\n", nvstatusToString(status));
@@ -532,6 +532,8 @@ gpu_fault_stats_print_common(uvm_parent_gpu_t *parent_gpu, struct seq_file *s)
 {
     NvU64 num_pages_in;
     NvU64 num_pages_out;
+    NvU64 num_ats_window_pages;
+    NvU64 ats_window_ns;
 
     UVM_ASSERT(uvm_procfs_is_debug_enabled());
 
@@ -559,6 +561,25 @@ gpu_fault_stats_print_common(uvm_parent_gpu_t *parent_gpu, struct seq_file *s)
                          parent_gpu->fault_buffer_info.replayable.stats.num_replays);
     UVM_SEQ_OR_DBG_PRINT(s, "  start_ack_all        %llu\n",
                          parent_gpu->fault_buffer_info.replayable.stats.num_replays_ack_all);
+    UVM_SEQ_OR_DBG_PRINT(s, "va_range_lookups:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  done                 %llu\n",
+                         parent_gpu->fault_buffer_info.replayable.stats.num_va_range_lookups);
+    UVM_SEQ_OR_DBG_PRINT(s, "  avoided              %llu\n",
+                         parent_gpu->fault_buffer_info.replayable.stats.num_va_range_lookups_avoided);
+    UVM_SEQ_OR_DBG_PRINT(s, "hmm_vma_lookups:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  done                 %llu\n",
+                         parent_gpu->fault_buffer_info.replayable.stats.num_hmm_vma_lookups);
+    UVM_SEQ_OR_DBG_PRINT(s, "  avoided              %llu\n",
+                         parent_gpu->fault_buffer_info.replayable.stats.num_hmm_vma_lookups_avoided);
+    num_ats_window_pages = parent_gpu->fault_buffer_info.replayable.stats.num_ats_window_pages;
+    ats_window_ns = parent_gpu->fault_buffer_info.replayable.stats.ats_window_ns;
+    UVM_SEQ_OR_DBG_PRINT(s, "ats_windows:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  windows              %llu\n",
+                         parent_gpu->fault_buffer_info.replayable.stats.num_ats_windows);
+    UVM_SEQ_OR_DBG_PRINT(s, "  pages                %llu\n", num_ats_window_pages);
+    UVM_SEQ_OR_DBG_PRINT(s, "  service_ns           %llu\n", ats_window_ns);
+    UVM_SEQ_OR_DBG_PRINT(s, "  pages_per_sec        %llu\n",
+                         ats_window_ns ? num_ats_window_pages * 1000000000ull / ats_window_ns : 0);
     UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults  %llu\n", parent_gpu->stats.num_non_replayable_faults);
     UVM_SEQ_OR_DBG_PRINT(s, "faults_by_access_type:\n");
     UVM_SEQ_OR_DBG_PRINT(s, "  read                 %llu\n",
@@ -596,6 +617,15 @@ static void gpu_access_counters_print_common(uvm_parent_gpu_t *parent_gpu, struc
                          (num_pages_in * (NvU64)PAGE_SIZE) / (1024u * 1024u));
     UVM_SEQ_OR_DBG_PRINT(s, "  num_pages_out        %llu (%llu MB)\n", num_pages_out,
                          (num_pages_out * (NvU64)PAGE_SIZE) / (1024u * 1024u));
+    UVM_SEQ_OR_DBG_PRINT(s, "notifications:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  received             %llu\n",
+                         atomic64_read(&parent_gpu->access_counter_buffer_info.stats.num_notifications));
+    UVM_SEQ_OR_DBG_PRINT(s, "  coalesced            %llu\n",
+                         atomic64_read(&parent_gpu->access_counter_buffer_info.stats.num_notifications_coalesced));
+    UVM_SEQ_OR_DBG_PRINT(s, "  serviced             %llu\n",
+                         atomic64_read(&parent_gpu->access_counter_buffer_info.stats.num_notifications_serviced));
+    UVM_SEQ_OR_DBG_PRINT(s, "  dropped              %llu\n",
+                         atomic64_read(&parent_gpu->access_counter_buffer_info.stats.num_notifications_dropped));
 }
 
 void uvm_gpu_print(uvm_gpu_t *gpu)
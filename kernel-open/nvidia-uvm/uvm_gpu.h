@@ -164,6 +164,10 @@ struct uvm_service_block_context_struct
     uvm_va_block_context_t block_context;
 };
 
+// Maximum number of fault events accumulated before they are delivered to the
+// perf events consumers
+#define UVM_FAULT_EVENTS_BATCH_SIZE 32
+
 struct uvm_fault_service_batch_context_struct
 {
     // Array of elements fetched from the GPU fault buffer. The number of
@@ -208,6 +212,13 @@ struct uvm_fault_service_batch_context_struct
 
     // Last fetched fault. Used for fault filtering.
     uvm_fault_buffer_entry_t *last_fault;
+
+    // Fault events of the VA block being serviced, delivered to the perf
+    // events consumers with a single uvm_perf_event_notify_batch() call once
+    // the block has been scanned, or earlier if the array fills up.
+    uvm_perf_event_data_t fault_events[UVM_FAULT_EVENTS_BATCH_SIZE];
+
+    NvU32 num_fault_events;
 };
 
 struct uvm_ats_fault_invalidate_struct
@@ -219,6 +230,27 @@ struct uvm_ats_fault_invalidate_struct
     uvm_tlb_batch_t write_faults_tlb_batch;
 };
 
+// State shared by the ATS faults of a replayable fault batch. It is reset at
+// the beginning of every batch. See uvm_ats_service_fault_window.
+struct uvm_ats_fault_context_struct
+{
+    // Cached result of the GMMU region check (see uvm_ats_service_fault_entry)
+    // for the UVM_GMMU_ATS_GRANULARITY region at gmmu_region_base
+    uvm_va_space_t *gmmu_region_va_space;
+    NvU64           gmmu_region_base;
+    bool            in_gmmu_region;
+
+    // Last address window [window_start, window_end) of window_va_space
+    // considered for window servicing in this batch. If window_serviced is
+    // set, its pages have already been serviced, with write permissions if
+    // window_write is set. Otherwise, its faults are serviced individually.
+    uvm_va_space_t *window_va_space;
+    NvU64           window_start;
+    NvU64           window_end;
+    bool            window_serviced;
+    bool            window_write;
+};
+
 typedef struct
 {
     // Fault buffer information and structures provided by RM
@@ -277,6 +309,28 @@ typedef struct
             NvU64 num_replays;
 
             NvU64 num_replays_ack_all;
+
+            // VA range lookups done to find the VA block of a fault, and
+            // lookups avoided because the previous VA range in the batch
+            // also contained the fault
+            NvU64 num_va_range_lookups;
+
+            NvU64 num_va_range_lookups_avoided;
+
+            // VMA lookups done to find or create the HMM VA block of a fault,
+            // and lookups avoided because the previous VMA in the batch also
+            // contained the fault
+            NvU64 num_hmm_vma_lookups;
+
+            NvU64 num_hmm_vma_lookups_avoided;
+
+            // ATS fault windows serviced with a single migration, the pages
+            // they span and the time spent servicing them
+            NvU64 num_ats_windows;
+
+            NvU64 num_ats_window_pages;
+
+            NvU64 ats_window_ns;
         } stats;
 
         // Number of uTLBs in the chip
@@ -290,6 +344,9 @@ typedef struct
 
         // Information required to invalidate stale ATS PTEs from the GPU TLBs
         uvm_ats_fault_invalidate_t ats_invalidate;
+
+        // ATS fault servicing state shared by the faults in a batch
+        uvm_ats_fault_context_t ats_context;
     } replayable;
 
     struct uvm_non_replayable_fault_buffer_info_struct
@@ -385,11 +442,6 @@ struct uvm_access_counter_service_batch_context_struct
         uvm_reverse_map_t                      *translations;
 
         NvU32                              num_notifications;
-
-        // Boolean used to avoid sorting the fault batch by aperture if we
-        // determine at fetch time that all the access counter notifications in the
-        // batch report the same aperture
-        bool                              is_single_aperture;
     } phys;
 
     // Helper page mask to compute the accessed pages within a VA block
@@ -460,6 +512,22 @@ typedef struct
         atomic64_t num_pages_out;
 
         atomic64_t num_pages_in;
+
+        // Notifications fetched from the buffer
+        atomic64_t num_notifications;
+
+        // Physical notifications serviced together with an earlier
+        // notification for the same processor and root chunk, including
+        // duplicates of the same tracked region
+        atomic64_t num_notifications_coalesced;
+
+        // Notifications that mapped to managed memory and were serviced
+        atomic64_t num_notifications_serviced;
+
+        // Notifications that were not serviced: virtual notifications,
+        // notifications on unknown processors or out-of-range addresses, and
+        // notifications that do not map to managed memory
+        atomic64_t num_notifications_dropped;
     } stats;
 
     // Ignoring access counters means that notifications are left in the HW
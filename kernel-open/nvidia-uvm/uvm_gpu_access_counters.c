@@ -762,16 +762,35 @@ static int cmp_sort_virt_notifications_by_instance_ptr(const void *_a, const voi
 }
 
 // Sort comparator for pointers to GPA access counter notification buffer
-// entries that sorts by physical address' aperture
-static int cmp_sort_phys_notifications_by_processor_id(const void *_a, const void *_b)
+// entries that sorts by processor id, counter type and physical address, so
+// that notifications on the same root chunk end up next to each other
+static int cmp_sort_phys_notifications_by_region(const void *_a, const void *_b)
 {
+    int result;
     const uvm_access_counter_buffer_entry_t *a = *(const uvm_access_counter_buffer_entry_t **)_a;
     const uvm_access_counter_buffer_entry_t *b = *(const uvm_access_counter_buffer_entry_t **)_b;
 
     UVM_ASSERT(!a->address.is_virtual);
     UVM_ASSERT(!b->address.is_virtual);
 
-    return uvm_id_cmp(a->physical_info.resident_id, b->physical_info.resident_id);
+    result = uvm_id_cmp(a->physical_info.resident_id, b->physical_info.resident_id);
+    if (result != 0)
+        return result;
+
+    result = UVM_CMP_DEFAULT(a->counter_type, b->counter_type);
+    if (result != 0)
+        return result;
+
+    return UVM_CMP_DEFAULT(a->address.address, b->address.address);
+}
+
+// Sort comparator for reverse map translations that sorts by VA block
+static int cmp_sort_reverse_mappings_by_va_block(const void *_a, const void *_b)
+{
+    const uvm_reverse_map_t *a = (const uvm_reverse_map_t *)_a;
+    const uvm_reverse_map_t *b = (const uvm_reverse_map_t *)_b;
+
+    return UVM_CMP_DEFAULT((uintptr_t)a->va_block, (uintptr_t)b->va_block);
 }
 
 typedef enum
@@ -796,7 +815,6 @@ static NvU32 fetch_access_counter_buffer_entries(uvm_gpu_t *gpu,
     uvm_spin_loop_t spin;
     uvm_access_counter_buffer_info_t *access_counters = &gpu->parent->access_counter_buffer_info;
     NvU32 last_instance_ptr_idx = 0;
-    uvm_aperture_t last_aperture = UVM_APERTURE_PEER_MAX;
 
     UVM_ASSERT(uvm_sem_is_locked(&gpu->parent->isr.access_counters.service_lock));
     UVM_ASSERT(gpu->parent->access_counters_supported);
@@ -819,7 +837,6 @@ static NvU32 fetch_access_counter_buffer_entries(uvm_gpu_t *gpu,
     batch_context->virt.num_notifications = 0;
 
     batch_context->virt.is_single_instance_ptr = true;
-    batch_context->phys.is_single_aperture = true;
 
     notification_index = 0;
 
@@ -864,13 +881,7 @@ static NvU32 fetch_access_counter_buffer_entries(uvm_gpu_t *gpu,
             current_entry->physical_info.resident_id =
                 uvm_gpu_get_processor_id_by_address(gpu, uvm_gpu_phys_address(current_entry->address.aperture,
                                                                               current_entry->address.address));
-
-            if (batch_context->phys.is_single_aperture) {
-                if (batch_context->phys.num_notifications == 1)
-                    last_aperture = current_entry->address.aperture;
-                else if (current_entry->address.aperture != last_aperture)
-                    batch_context->phys.is_single_aperture = false;
-            }
+            current_entry->physical_info.on_managed = false;
 
             if (current_entry->counter_type == UVM_ACCESS_COUNTER_TYPE_MOMC)
                 UVM_ASSERT(uvm_id_equal(current_entry->physical_info.resident_id, gpu->id));
@@ -939,6 +950,9 @@ static NV_STATUS service_virt_notifications(uvm_gpu_t *gpu,
 {
     // TODO: Bug 1990466: Service virtual notifications. Entries with NULL
     // va_space are simply dropped.
+    atomic64_add(batch_context->virt.num_notifications,
+                 &gpu->parent->access_counter_buffer_info.stats.num_notifications_dropped);
+
     if (uvm_enable_builtin_tests) {
         NvU32 i;
 
@@ -953,18 +967,52 @@ static NV_STATUS service_virt_notifications(uvm_gpu_t *gpu,
     return NV_OK;
 }
 
+static bool phys_notifications_are_duplicate(const uvm_access_counter_buffer_entry_t *a,
+                                             const uvm_access_counter_buffer_entry_t *b)
+{
+    return uvm_id_equal(a->physical_info.resident_id, b->physical_info.resident_id) &&
+           a->counter_type == b->counter_type &&
+           a->address.address == b->address.address;
+}
+
+// Notifications are serviced together if they report the same processor and
+// counter type, and their tracked regions fall within the same root chunk.
+// The translations of all the notifications in a group cover at most
+// UVM_MAX_TRANSLATION_SIZE bytes, so they fit in the preallocated reverse map
+// array.
+static bool phys_notifications_in_same_root_chunk(const uvm_access_counter_buffer_entry_t *a,
+                                                  const uvm_access_counter_buffer_entry_t *b)
+{
+    BUILD_BUG_ON(UVM_MAX_TRANSLATION_SIZE != UVM_CHUNK_SIZE_MAX);
+
+    return uvm_id_equal(a->physical_info.resident_id, b->physical_info.resident_id) &&
+           a->counter_type == b->counter_type &&
+           UVM_ALIGN_DOWN(a->address.address, UVM_CHUNK_SIZE_MAX) ==
+               UVM_ALIGN_DOWN(b->address.address, UVM_CHUNK_SIZE_MAX);
+}
+
 // GPA notifications provide a physical address and an aperture. Sort
-// accesses by aperture to try to coalesce operations on the same target
-// processor.
+// accesses by processor and address to coalesce operations on the same root
+// chunk, and fold the sub-granularity masks of duplicate notifications for the
+// same tracked region into the first one.
 static void preprocess_phys_notifications(uvm_access_counter_service_batch_context_t *batch_context)
 {
-    if (!batch_context->phys.is_single_aperture) {
-        // Sort by instance_ptr
-        sort(batch_context->phys.notifications,
-             batch_context->phys.num_notifications,
-             sizeof(*batch_context->phys.notifications),
-             cmp_sort_phys_notifications_by_processor_id,
-             NULL);
+    NvU32 i;
+    uvm_access_counter_buffer_entry_t *first_entry = NULL;
+
+    sort(batch_context->phys.notifications,
+         batch_context->phys.num_notifications,
+         sizeof(*batch_context->phys.notifications),
+         cmp_sort_phys_notifications_by_region,
+         NULL);
+
+    for (i = 0; i < batch_context->phys.num_notifications; ++i) {
+        uvm_access_counter_buffer_entry_t *current_entry = batch_context->phys.notifications[i];
+
+        if (first_entry && phys_notifications_are_duplicate(first_entry, current_entry))
+            first_entry->sub_granularity |= current_entry->sub_granularity;
+        else
+            first_entry = current_entry;
     }
 }
 
@@ -1083,7 +1131,7 @@ static NV_STATUS service_va_block_locked(uvm_processor_id_t processor,
         // Remove pages that are already resident in the destination processors
         for_each_id_in_mask(id, &update_processors) {
             bool migrate_pages;
-            uvm_page_mask_t *residency_mask = uvm_va_block_resident_mask_get(va_block, id);
+            const uvm_page_mask_t *residency_mask = uvm_va_block_resident_mask_get(va_block, id);
             UVM_ASSERT(residency_mask);
 
             migrate_pages = uvm_page_mask_andnot(&service_context->per_processor_masks[uvm_id_value(id)].new_residency,
@@ -1233,26 +1281,61 @@ done:
     return status;
 }
 
+static bool are_reverse_mappings_on_single_block(const uvm_reverse_map_t *reverse_mappings, size_t num_reverse_mappings)
+{
+    size_t index;
+    uvm_va_block_t *prev_va_block = NULL;
+
+    for (index = 0; index < num_reverse_mappings; ++index) {
+        uvm_va_block_t *va_block = reverse_mappings[index].va_block;
+        UVM_ASSERT(va_block);
+
+        if (prev_va_block && prev_va_block != va_block)
+            return false;
+
+        prev_va_block = va_block;
+    }
+
+    return true;
+}
+
+// Service the given reverse mappings. Mappings are sorted by VA block so that
+// every VA block is locked only once, with a page mask that merges all the
+// regions of the block.
 static NV_STATUS service_phys_va_blocks(uvm_gpu_t *gpu,
                                         uvm_access_counter_service_batch_context_t *batch_context,
                                         const uvm_access_counter_buffer_entry_t *current_entry,
-                                        const uvm_reverse_map_t *reverse_mappings,
+                                        uvm_reverse_map_t *reverse_mappings,
                                         size_t num_reverse_mappings,
                                         bool *clear_counter)
 {
     NV_STATUS status = NV_OK;
-    size_t index;
+    size_t index = 0;
 
     *clear_counter = false;
 
-    for (index = 0; index < num_reverse_mappings; ++index) {
+    if (!are_reverse_mappings_on_single_block(reverse_mappings, num_reverse_mappings)) {
+        sort(reverse_mappings,
+             num_reverse_mappings,
+             sizeof(*reverse_mappings),
+             cmp_sort_reverse_mappings_by_va_block,
+             NULL);
+    }
+
+    while (index < num_reverse_mappings) {
         bool clear_counter_local = false;
+        size_t outer = index + 1;
+
+        while (outer < num_reverse_mappings && reverse_mappings[outer].va_block == reverse_mappings[index].va_block)
+            ++outer;
+
         status = service_phys_single_va_block(gpu,
                                               batch_context,
                                               current_entry,
                                               reverse_mappings + index,
-                                              1,
+                                              outer - index,
                                               &clear_counter_local);
+        index = outer;
         if (status != NV_OK)
             break;
 
@@ -1260,7 +1343,7 @@ static NV_STATUS service_phys_va_blocks(uvm_gpu_t *gpu,
     }
 
     // In the case of failure, drop the refcounts for the remaining reverse mappings
-    while (++index < num_reverse_mappings)
+    for (; index < num_reverse_mappings; ++index)
         uvm_va_block_release(reverse_mappings[index].va_block);
 
     return status;
@@ -1280,183 +1363,237 @@ static NV_STATUS service_phys_va_blocks(uvm_gpu_t *gpu,
                                            (config)->sub_granularity_regions_per_translation,                    \
                                            (region_start) + 1))
 
-static bool are_reverse_mappings_on_single_block(const uvm_reverse_map_t *reverse_mappings, size_t num_reverse_mappings)
-{
-    size_t index;
-    uvm_va_block_t *prev_va_block = NULL;
-
-    for (index = 0; index < num_reverse_mappings; ++index) {
-        uvm_va_block_t *va_block = reverse_mappings[index].va_block;
-        UVM_ASSERT(va_block);
-
-        if (prev_va_block && prev_va_block != va_block)
-            return false;
-
-        prev_va_block = va_block;
-    }
-
-    return true;
-}
-
-// Service the given translation range. It will return the count of the reverse
-// mappings found during servicing in num_reverse_mappings, even if the function
-// doesn't return NV_OK.
-static NV_STATUS service_phys_notification_translation(uvm_gpu_t *gpu,
-                                                       uvm_gpu_t *resident_gpu,
-                                                       uvm_access_counter_service_batch_context_t *batch_context,
-                                                       const uvm_gpu_access_counter_type_config_t *config,
-                                                       const uvm_access_counter_buffer_entry_t *current_entry,
-                                                       NvU64 address,
-                                                       unsigned long sub_granularity,
-                                                       size_t *num_reverse_mappings,
-                                                       bool *clear_counter)
+// Obtain the reverse map translations for all the regions set in the
+// sub_granularity field of the counter within the given translation range.
+// Translations are written to reverse_mappings, and the number of translations
+// is returned.
+static size_t translate_phys_notification(uvm_gpu_t *gpu,
+                                          uvm_gpu_t *resident_gpu,
+                                          const uvm_gpu_access_counter_type_config_t *config,
+                                          NvU64 address,
+                                          unsigned long sub_granularity,
+                                          uvm_reverse_map_t *reverse_mappings)
 {
-    NV_STATUS status;
     NvU32 region_start, region_end;
+    size_t num_reverse_mappings = 0;
 
-    *num_reverse_mappings = 0;
-
-    // Get the reverse_map translations for all the regions set in the
-    // sub_granularity field of the counter.
     for_each_sub_granularity_region(region_start, region_end, sub_granularity, config) {
         NvU64 local_address = address + region_start * config->sub_granularity_region_size;
         NvU32 local_translation_size = (region_end - region_start) * config->sub_granularity_region_size;
-        uvm_reverse_map_t *local_reverse_mappings = batch_context->phys.translations + *num_reverse_mappings;
+        uvm_reverse_map_t *local_reverse_mappings = reverse_mappings + num_reverse_mappings;
 
         // Obtain the virtual addresses of the pages within the reported
         // DMA range
         if (resident_gpu) {
-            *num_reverse_mappings += uvm_pmm_gpu_phys_to_virt(&resident_gpu->pmm,
-                                                              local_address,
-                                                              local_translation_size,
-                                                              local_reverse_mappings);
+            num_reverse_mappings += uvm_pmm_gpu_phys_to_virt(&resident_gpu->pmm,
+                                                             local_address,
+                                                             local_translation_size,
+                                                             local_reverse_mappings);
         }
         else {
-            *num_reverse_mappings += uvm_pmm_sysmem_mappings_dma_to_virt(&gpu->pmm_reverse_sysmem_mappings,
-                                                                         local_address,
-                                                                         local_translation_size,
-                                                                         local_reverse_mappings,
-                                                                         local_translation_size / PAGE_SIZE);
+            num_reverse_mappings += uvm_pmm_sysmem_mappings_dma_to_virt(&gpu->pmm_reverse_sysmem_mappings,
+                                                                        local_address,
+                                                                        local_translation_size,
+                                                                        local_reverse_mappings,
+                                                                        local_translation_size / PAGE_SIZE);
         }
     }
 
-    if (*num_reverse_mappings == 0)
-        return NV_OK;
+    return num_reverse_mappings;
+}
 
-    // Service all the translations
-    if (are_reverse_mappings_on_single_block(batch_context->phys.translations, *num_reverse_mappings)) {
-        status = service_phys_single_va_block(gpu,
-                                              batch_context,
-                                              current_entry,
-                                              batch_context->phys.translations,
-                                              *num_reverse_mappings,
-                                              clear_counter);
-    }
-    else {
-        status = service_phys_va_blocks(gpu,
-                                        batch_context,
-                                        current_entry,
-                                        batch_context->phys.translations,
-                                        *num_reverse_mappings,
-                                        clear_counter);
+// Compute the address within the resident processor's memory reported by the
+// given notification. Returns false if the notification must be dropped.
+static bool phys_notification_get_address(uvm_gpu_t *gpu,
+                                          uvm_gpu_t *resident_gpu,
+                                          const uvm_access_counter_buffer_entry_t *current_entry,
+                                          NvU64 *address)
+{
+    *address = current_entry->address.address;
+
+    if (!resident_gpu)
+        return true;
+
+    if (gpu != resident_gpu && uvm_gpus_are_nvswitch_connected(gpu, resident_gpu)) {
+        UVM_ASSERT(*address >= resident_gpu->parent->nvswitch_info.fabric_memory_window_start);
+        *address -= resident_gpu->parent->nvswitch_info.fabric_memory_window_start;
     }
 
-    return status;
+    // On P9 systems, the CPU accesses the reserved heap on vidmem via
+    // coherent NVLINK mappings. This can trigger notifications that fall
+    // outside of the allocatable address range. We just drop them.
+    return *address < resident_gpu->mem_info.max_allocatable_address;
 }
 
-static NV_STATUS service_phys_notification(uvm_gpu_t *gpu,
-                                           uvm_access_counter_service_batch_context_t *batch_context,
-                                           const uvm_access_counter_buffer_entry_t *current_entry)
+// Service the notifications in [first, outer) of the physical notification
+// array. All of them report the same processor and counter type and, unless
+// the group is formed by duplicates of a single notification, their tracked
+// regions fall within the same root chunk. The translations of all the
+// notifications are gathered before servicing, so that each VA block is only
+// locked once for the whole group.
+static NV_STATUS service_phys_notification_group(uvm_gpu_t *gpu,
+                                                 uvm_access_counter_service_batch_context_t *batch_context,
+                                                 NvU32 first,
+                                                 NvU32 outer)
 {
-    NvU64 address;
+    NvU32 i;
     NvU64 translation_index;
     uvm_access_counter_buffer_info_t *access_counters = &gpu->parent->access_counter_buffer_info;
-    uvm_access_counter_type_t counter_type = current_entry->counter_type;
-    const uvm_gpu_access_counter_type_config_t *config = get_config_for_type(access_counters, counter_type);
-    unsigned long sub_granularity;
-    size_t total_reverse_mappings = 0;
+    uvm_access_counter_buffer_entry_t **notifications = batch_context->phys.notifications;
+    const uvm_access_counter_buffer_entry_t *first_entry = notifications[first];
+    const uvm_gpu_access_counter_type_config_t *config = get_config_for_type(access_counters,
+                                                                             first_entry->counter_type);
     uvm_gpu_t *resident_gpu = NULL;
     NV_STATUS status = NV_OK;
     bool clear_counter = false;
 
-    address = current_entry->address.address;
-    UVM_ASSERT(address % config->translation_size == 0);
-    sub_granularity = current_entry->sub_granularity;
+    if (UVM_ID_IS_GPU(first_entry->physical_info.resident_id)) {
+        resident_gpu = uvm_gpu_get_by_processor_id(first_entry->physical_info.resident_id);
+        UVM_ASSERT(resident_gpu != NULL);
+    }
 
-    if (config->rm.granularity == UVM_ACCESS_COUNTER_GRANULARITY_64K)
-        sub_granularity = 1;
+    for (translation_index = 0; translation_index < config->translations_per_counter; ++translation_index) {
+        size_t num_reverse_mappings = 0;
+        bool clear_counter_local = false;
 
-    if (UVM_ID_IS_GPU(current_entry->physical_info.resident_id)) {
-        resident_gpu = uvm_gpu_get_by_processor_id(current_entry->physical_info.resident_id);
-        UVM_ASSERT(resident_gpu != NULL);
+        for (i = first; i < outer; ++i) {
+            uvm_access_counter_buffer_entry_t *current_entry = notifications[i];
+            unsigned long sub_granularity;
+            size_t num_entry_reverse_mappings;
+            NvU64 address;
+
+            // Duplicates were folded into the first notification for the
+            // tracked region during preprocessing
+            if (i > first && phys_notifications_are_duplicate(notifications[i - 1], current_entry))
+                continue;
+
+            if (!phys_notification_get_address(gpu, resident_gpu, current_entry, &address))
+                continue;
 
-        if (gpu != resident_gpu && uvm_gpus_are_nvswitch_connected(gpu, resident_gpu)) {
-            UVM_ASSERT(address >= resident_gpu->parent->nvswitch_info.fabric_memory_window_start);
-            address -= resident_gpu->parent->nvswitch_info.fabric_memory_window_start;
+            UVM_ASSERT(address % config->translation_size == 0);
+            address += translation_index * config->translation_size;
+
+            if (config->rm.granularity == UVM_ACCESS_COUNTER_GRANULARITY_64K)
+                sub_granularity = 1;
+            else
+                sub_granularity = current_entry->sub_granularity >>
+                                  (translation_index * config->sub_granularity_regions_per_translation);
+
+            num_entry_reverse_mappings = translate_phys_notification(gpu,
+                                                                     resident_gpu,
+                                                                     config,
+                                                                     address,
+                                                                     sub_granularity,
+                                                                     batch_context->phys.translations +
+                                                                         num_reverse_mappings);
+            if (num_entry_reverse_mappings > 0)
+                current_entry->physical_info.on_managed = true;
+
+            num_reverse_mappings += num_entry_reverse_mappings;
         }
 
-        // On P9 systems, the CPU accesses the reserved heap on vidmem via
-        // coherent NVLINK mappings. This can trigger notifications that
-        // fall outside of the allocatable address range. We just drop
-        // them.
-        if (address >= resident_gpu->mem_info.max_allocatable_address)
-            return NV_OK;
-    }
+        UVM_ASSERT(num_reverse_mappings <= UVM_MAX_TRANSLATION_SIZE / PAGE_SIZE);
 
-    for (translation_index = 0; translation_index < config->translations_per_counter; ++translation_index) {
-        size_t num_reverse_mappings;
-        bool clear_counter_local = false;
-        status = service_phys_notification_translation(gpu,
-                                                       resident_gpu,
-                                                       batch_context,
-                                                       config,
-                                                       current_entry,
-                                                       address,
-                                                       sub_granularity,
-                                                       &num_reverse_mappings,
-                                                       &clear_counter_local);
-        total_reverse_mappings += num_reverse_mappings;
-        clear_counter = clear_counter || clear_counter_local;
+        if (num_reverse_mappings > 0) {
+            status = service_phys_va_blocks(gpu,
+                                            batch_context,
+                                            first_entry,
+                                            batch_context->phys.translations,
+                                            num_reverse_mappings,
+                                            &clear_counter_local);
+            clear_counter = clear_counter || clear_counter_local;
+        }
 
         if (status != NV_OK)
             break;
-
-        address += config->translation_size;
-        sub_granularity = sub_granularity >> config->sub_granularity_regions_per_translation;
     }
 
     // TODO: Bug 1990466: Here we already have virtual addresses and
     // address spaces. Merge virtual and physical notification handling
 
-    // Currently we only report events for our tests, not for tools
-    if (uvm_enable_builtin_tests) {
-        const bool on_managed = total_reverse_mappings != 0;
-        uvm_tools_broadcast_access_counter(gpu, current_entry, on_managed);
-    }
+    for (i = first; i < outer; ++i) {
+        uvm_access_counter_buffer_entry_t *current_entry = notifications[i];
+        const uvm_access_counter_buffer_entry_t *prev_entry = i > first ? notifications[i - 1] : NULL;
+        bool is_duplicate = prev_entry && phys_notifications_are_duplicate(prev_entry, current_entry);
+        NvU64 address;
+
+        if (i > first)
+            atomic64_inc(&access_counters->stats.num_notifications_coalesced);
+
+        if (is_duplicate)
+            current_entry->physical_info.on_managed = prev_entry->physical_info.on_managed;
+
+        if (!phys_notification_get_address(gpu, resident_gpu, current_entry, &address)) {
+            atomic64_inc(&access_counters->stats.num_notifications_dropped);
+            continue;
+        }
+
+        if (current_entry->physical_info.on_managed)
+            atomic64_inc(&access_counters->stats.num_notifications_serviced);
+        else
+            atomic64_inc(&access_counters->stats.num_notifications_dropped);
+
+        // Currently we only report events for our tests, not for tools
+        if (uvm_enable_builtin_tests)
+            uvm_tools_broadcast_access_counter(gpu, current_entry, current_entry->physical_info.on_managed);
+
+        if (status != NV_OK || !clear_counter || !current_entry->physical_info.on_managed)
+            continue;
+
+        // Duplicates reported by the same HW counter are cleared along with
+        // the first notification
+        if (is_duplicate && current_entry->bank == prev_entry->bank && current_entry->tag == prev_entry->tag)
+            continue;
 
-    if (status == NV_OK && clear_counter)
         status = access_counter_clear_targeted(gpu, current_entry);
+    }
 
     return status;
 }
 
-// TODO: Bug 2018899: Add statistics for dropped access counter notifications
 static NV_STATUS service_phys_notifications(uvm_gpu_t *gpu,
                                             uvm_access_counter_service_batch_context_t *batch_context)
 {
-    NvU32 i;
+    NvU32 i = 0;
+    uvm_access_counter_buffer_info_t *access_counters = &gpu->parent->access_counter_buffer_info;
+    uvm_access_counter_buffer_entry_t **notifications = batch_context->phys.notifications;
+
     preprocess_phys_notifications(batch_context);
 
-    for (i = 0; i < batch_context->phys.num_notifications; ++i) {
+    while (i < batch_context->phys.num_notifications) {
         NV_STATUS status;
-        uvm_access_counter_buffer_entry_t *current_entry = batch_context->phys.notifications[i];
+        uvm_access_counter_buffer_entry_t *current_entry = notifications[i];
+        const uvm_gpu_access_counter_type_config_t *config;
+        NvU32 outer = i + 1;
 
-        if (!UVM_ID_IS_VALID(current_entry->physical_info.resident_id))
+        if (!UVM_ID_IS_VALID(current_entry->physical_info.resident_id)) {
+            atomic64_inc(&access_counters->stats.num_notifications_dropped);
+            ++i;
             continue;
+        }
+
+        // Counters that track regions larger than a root chunk need several
+        // translations each, so they are only grouped with their duplicates
+        config = get_config_for_type(access_counters, current_entry->counter_type);
+        while (outer < batch_context->phys.num_notifications) {
+            const uvm_access_counter_buffer_entry_t *next_entry = notifications[outer];
 
-        status = service_phys_notification(gpu, batch_context, current_entry);
+            if (config->translations_per_counter == 1) {
+                if (!phys_notifications_in_same_root_chunk(current_entry, next_entry))
+                    break;
+            }
+            else if (!phys_notifications_are_duplicate(current_entry, next_entry)) {
+                break;
+            }
+
+            ++outer;
+        }
+
+        status = service_phys_notification_group(gpu, batch_context, i, outer);
         if (status != NV_OK)
             return status;
+
+        i = outer;
     }
 
     return NV_OK;
@@ -1479,6 +1616,9 @@ void uvm_gpu_service_access_counters(uvm_gpu_t *gpu)
         if (batch_context->num_cached_notifications == 0)
             break;
 
+        atomic64_add(batch_context->num_cached_notifications,
+                     &gpu->parent->access_counter_buffer_info.stats.num_notifications);
+
         ++batch_context->batch_id;
 
         status = service_virt_notifications(gpu, batch_context);
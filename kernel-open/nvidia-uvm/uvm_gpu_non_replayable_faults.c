@@ -541,7 +541,7 @@ static NV_STATUS service_non_managed_fault(uvm_gpu_va_space_t *gpu_va_space,
         ats_invalidate->write_faults_in_batch = false;
 
         // The VA isn't managed. See if ATS knows about it.
-        status = uvm_ats_service_fault_entry(gpu_va_space, fault_entry, ats_invalidate);
+        status = uvm_ats_service_fault_entry(gpu_va_space, fault_entry, NULL, ats_invalidate);
 
         // Invalidate ATS TLB entries if needed
         if (status == NV_OK) {
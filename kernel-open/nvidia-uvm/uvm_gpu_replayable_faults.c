@@ -1102,6 +1102,17 @@ static uvm_fault_access_type_t check_fault_access_permissions(uvm_gpu_t *gpu,
     return UVM_FAULT_ACCESS_TYPE_COUNT;
 }
 
+// Deliver the fault events accumulated in the batch context, taking the perf
+// events lock once for all of them.
+static void flush_fault_events(uvm_va_space_t *va_space, uvm_fault_service_batch_context_t *batch_context)
+{
+    uvm_perf_event_notify_batch(&va_space->perf_events,
+                                UVM_PERF_EVENT_FAULT,
+                                batch_context->fault_events,
+                                batch_context->num_fault_events);
+    batch_context->num_fault_events = 0;
+}
+
 // We notify the fault event for all faults within the block so that the
 // performance heuristics are updated. Then, all required actions for the block
 // data are performed by the performance heuristics code.
@@ -1132,6 +1143,7 @@ static NV_STATUS service_batch_managed_faults_in_block_locked(uvm_gpu_t *gpu,
     uvm_fault_buffer_entry_t **ordered_fault_cache = batch_context->ordered_fault_cache;
     uvm_service_block_context_t *block_context = &replayable_faults->block_service_context;
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    bool notify_faults;
     NvU64 end;
 
     // Check that all uvm_fault_access_type_t values can fit into an NvU8
@@ -1165,6 +1177,12 @@ static NV_STATUS service_batch_managed_faults_in_block_locked(uvm_gpu_t *gpu,
     else
         block_context->block_context.policy = uvm_va_range_get_policy(va_block->va_range);
 
+    // Fault events are only generated on the first attempt. Checking for
+    // consumers up front avoids building records nobody listens to.
+    notify_faults = block_context->num_retries == 0 &&
+                    uvm_perf_event_has_callbacks(&va_space->perf_events, UVM_PERF_EVENT_FAULT);
+    batch_context->num_fault_events = 0;
+
     // Scan the sorted array and notify the fault event for all fault entries
     // in the block
     for (i = first_fault_index;
@@ -1194,14 +1212,18 @@ static NV_STATUS service_batch_managed_faults_in_block_locked(uvm_gpu_t *gpu,
             is_duplicate = current_entry->fault_address == previous_entry->fault_address;
         }
 
-        if (block_context->num_retries == 0) {
-            uvm_perf_event_notify_gpu_fault(&va_space->perf_events,
-                                            va_block,
-                                            gpu->id,
-                                            block_context->block_context.policy->preferred_location,
-                                            current_entry,
-                                            batch_context->batch_id,
-                                            is_duplicate);
+        if (notify_faults) {
+            if (batch_context->num_fault_events == ARRAY_SIZE(batch_context->fault_events))
+                flush_fault_events(va_space, batch_context);
+
+            uvm_perf_event_init_gpu_fault(&batch_context->fault_events[batch_context->num_fault_events++],
+                                          &va_space->perf_events,
+                                          va_block,
+                                          gpu->id,
+                                          block_context->block_context.policy->preferred_location,
+                                          current_entry,
+                                          batch_context->batch_id,
+                                          is_duplicate);
         }
 
         // Service the most intrusive fault per page, only. Waive the rest
@@ -1323,6 +1345,8 @@ static NV_STATUS service_batch_managed_faults_in_block_locked(uvm_gpu_t *gpu,
         }
     }
 
+    flush_fault_events(va_space, batch_context);
+
     // Apply the changes computed in the fault service block context, if there
     // are pages to be serviced
     if (page_fault_count > 0) {
@@ -1396,6 +1420,7 @@ static NV_STATUS service_non_managed_fault(uvm_fault_buffer_entry_t *current_ent
                                            uvm_gpu_va_space_t *gpu_va_space,
                                            struct mm_struct *mm,
                                            uvm_fault_service_batch_context_t *batch_context,
+                                           uvm_ats_fault_context_t *ats_context,
                                            uvm_ats_fault_invalidate_t *ats_invalidate,
                                            uvm_fault_utlb_info_t *utlb)
 {
@@ -1437,7 +1462,7 @@ static NV_STATUS service_non_managed_fault(uvm_fault_buffer_entry_t *current_ent
         // duplicate and the previous fault was non-fatal so the page has
         // already been serviced
         if (!is_duplicate || previous_entry->is_fatal)
-            status = uvm_ats_service_fault_entry(gpu_va_space, current_entry, ats_invalidate);
+            status = uvm_ats_service_fault_entry(gpu_va_space, current_entry, ats_context, ats_invalidate);
         else
             status = NV_OK;
     }
@@ -1476,6 +1501,62 @@ static NV_STATUS service_non_managed_fault(uvm_fault_buffer_entry_t *current_ent
     return status;
 }
 
+// Find or create the VA block containing addr. Faults in a batch are sorted by
+// address, so consecutive VA blocks commonly belong to the same VA range, or
+// to the same VMA for HMM blocks.
+// *va_range_hint caches the VA range of the last managed block found, which
+// avoids the VA range tree lookup when it also contains addr. The hint is
+// only valid while the VA space lock is held, since VA ranges can only be
+// split or destroyed with the lock held in write mode.
+// *hmm_vma_hint caches the VMA of the last HMM block found, which avoids the
+// VMA lookup when it also contains addr. It is only valid while the mmap_lock
+// is held.
+static NV_STATUS fault_batch_va_block_find_create(uvm_gpu_t *gpu,
+                                                  uvm_va_space_t *va_space,
+                                                  struct mm_struct *mm,
+                                                  NvU64 addr,
+                                                  uvm_va_block_context_t *va_block_context,
+                                                  uvm_va_range_t **va_range_hint,
+                                                  struct vm_area_struct **hmm_vma_hint,
+                                                  uvm_va_block_t **out_block)
+{
+    uvm_replayable_fault_buffer_info_t *replayable_faults = &gpu->parent->fault_buffer_info.replayable;
+    uvm_va_range_t *va_range = *va_range_hint;
+    struct vm_area_struct *vma = *hmm_vma_hint;
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    if (va_range && addr >= va_range->node.start && addr <= va_range->node.end) {
+        UVM_ASSERT(va_range->type == UVM_VA_RANGE_TYPE_MANAGED);
+
+        ++replayable_faults->stats.num_va_range_lookups_avoided;
+        return uvm_va_range_block_create(va_range, uvm_va_range_block_index(va_range, addr), out_block);
+    }
+
+    ++replayable_faults->stats.num_va_range_lookups;
+
+    va_range = uvm_va_range_find(va_space, addr);
+    if (!va_range) {
+        // HMM blocks don't have a VA range
+        if (!mm)
+            return NV_ERR_INVALID_ADDRESS;
+
+        if (vma && addr >= vma->vm_start && addr < vma->vm_end)
+            ++replayable_faults->stats.num_hmm_vma_lookups_avoided;
+        else
+            ++replayable_faults->stats.num_hmm_vma_lookups;
+
+        return uvm_hmm_va_block_find_create_hint(va_space, addr, hmm_vma_hint, va_block_context, out_block);
+    }
+
+    if (va_range->type != UVM_VA_RANGE_TYPE_MANAGED)
+        return NV_ERR_INVALID_ADDRESS;
+
+    *va_range_hint = va_range;
+
+    return uvm_va_range_block_create(va_range, uvm_va_range_block_index(va_range, addr), out_block);
+}
+
 // Scan the ordered view of faults and group them by different va_blocks.
 // Service faults for each va_block, in batch.
 //
@@ -1491,15 +1572,19 @@ static NV_STATUS service_fault_batch(uvm_gpu_t *gpu,
     uvm_va_space_t *va_space = NULL;
     uvm_gpu_va_space_t *gpu_va_space = NULL;
     uvm_ats_fault_invalidate_t *ats_invalidate = &gpu->parent->fault_buffer_info.replayable.ats_invalidate;
+    uvm_ats_fault_context_t *ats_context = &gpu->parent->fault_buffer_info.replayable.ats_context;
     const bool replay_per_va_block = service_mode != FAULT_SERVICE_MODE_CANCEL &&
                                      gpu->parent->fault_buffer_info.replayable.replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK;
     struct mm_struct *mm = NULL;
     uvm_va_block_context_t *va_block_context =
         &gpu->parent->fault_buffer_info.replayable.block_service_context.block_context;
+    uvm_va_range_t *va_range_hint = NULL;
+    struct vm_area_struct *hmm_vma_hint = NULL;
 
     UVM_ASSERT(gpu->parent->replayable_faults_supported);
 
     ats_invalidate->write_faults_in_batch = false;
+    uvm_ats_fault_context_reset(ats_context);
 
     for (i = 0; i < batch_context->num_coalesced_faults;) {
         uvm_va_block_t *va_block;
@@ -1523,6 +1608,8 @@ static NV_STATUS service_fault_batch(uvm_gpu_t *gpu,
             }
 
             va_space = current_entry->va_space;
+            va_range_hint = NULL;
+            hmm_vma_hint = NULL;
 
             // ... and take the lock of the new one
 
@@ -1573,13 +1660,14 @@ static NV_STATUS service_fault_batch(uvm_gpu_t *gpu,
             continue;
         }
 
-        // TODO: Bug 2103669: Service more than one ATS fault at a time so we
-        //       don't do an unconditional VA range lookup for every ATS fault.
-        status = uvm_va_block_find_create(va_space,
-                                          mm,
-                                          current_entry->fault_address,
-                                          va_block_context,
-                                          &va_block);
+        status = fault_batch_va_block_find_create(gpu,
+                                                  va_space,
+                                                  mm,
+                                                  current_entry->fault_address,
+                                                  va_block_context,
+                                                  &va_range_hint,
+                                                  &hmm_vma_hint,
+                                                  &va_block);
         if (status == NV_OK) {
             status = service_batch_managed_faults_in_block(gpu_va_space->gpu,
                                                            mm,
@@ -1598,12 +1686,27 @@ static NV_STATUS service_fault_batch(uvm_gpu_t *gpu,
         else {
             const uvm_fault_buffer_entry_t *previous_entry = i == 0? NULL : batch_context->ordered_fault_cache[i - 1];
 
+            // Service the ATS faults that follow in the same VMA and address
+            // window at once. The faults are then processed one by one below,
+            // and skip the already serviced pages.
+            if (status == NV_ERR_INVALID_ADDRESS && uvm_ats_can_service_faults(gpu_va_space, mm)) {
+                status = uvm_ats_service_fault_window(gpu_va_space,
+                                                      batch_context->ordered_fault_cache + i,
+                                                      batch_context->num_coalesced_faults - i,
+                                                      ats_context);
+                if (status != NV_OK)
+                    goto fail;
+
+                status = NV_ERR_INVALID_ADDRESS;
+            }
+
             status = service_non_managed_fault(current_entry,
                                                previous_entry,
                                                status,
                                                gpu_va_space,
                                                mm,
                                                batch_context,
+                                               ats_context,
                                                ats_invalidate,
                                                utlb);
 
@@ -30,6 +30,10 @@
 #define UVM_SEMAPHORE_PAGE_SIZE PAGE_SIZE
 #define UVM_SEMAPHORE_COUNT_PER_PAGE (PAGE_SIZE / UVM_SEMAPHORE_SIZE)
 
+// Number of pages with all semaphores free that the pool keeps around. Any
+// additional page is returned to RM as soon as its last semaphore is freed.
+#define UVM_SEMAPHORE_POOL_MAX_EMPTY_PAGES 1
+
 // The top nibble of the canary base is intentionally 0. The rest of the value
 // is arbitrary. See the comments below on make_canary.
 #define UVM_SEMAPHORE_CANARY_BASE     0x0badc0de
@@ -43,6 +47,17 @@ struct uvm_gpu_semaphore_pool_struct
     // List of all the semaphore pages belonging to the pool
     struct list_head pages;
 
+    // List of the pages with at least one free semaphore. Partially used pages
+    // are kept at the front and empty pages at the back, so allocations are
+    // packed into as few pages as possible.
+    struct list_head free_pages;
+
+    // Count of pages in the pool
+    NvU32 pages_count;
+
+    // Count of pages with all their semaphores free
+    NvU32 empty_pages_count;
+
     // Count of free semaphores among all the pages
     NvU32 free_semaphores_count;
 
@@ -61,6 +76,12 @@ struct uvm_gpu_semaphore_pool_page_struct
     // Node in the list of all pages in a semaphore pool
     struct list_head all_pages_node;
 
+    // Node in the list of pages with free semaphores in a semaphore pool
+    struct list_head free_pages_node;
+
+    // Count of free semaphores within the page
+    NvU32 free_semaphores_count;
+
     // Mask indicating free semaphore indices within the page
     DECLARE_BITMAP(free_semaphores, UVM_SEMAPHORE_COUNT_PER_PAGE);
 };
@@ -139,8 +160,12 @@ static NV_STATUS pool_alloc_page(uvm_gpu_semaphore_pool_t *pool)
 
     // All semaphores are initially free
     bitmap_fill(pool_page->free_semaphores, UVM_SEMAPHORE_COUNT_PER_PAGE);
+    pool_page->free_semaphores_count = UVM_SEMAPHORE_COUNT_PER_PAGE;
 
     list_add(&pool_page->all_pages_node, &pool->pages);
+    list_add_tail(&pool_page->free_pages_node, &pool->free_pages);
+    ++pool->pages_count;
+    ++pool->empty_pages_count;
     pool->free_semaphores_count += UVM_SEMAPHORE_COUNT_PER_PAGE;
 
     // Initialize the semaphore payloads to known values
@@ -170,9 +195,11 @@ static void pool_free_page(uvm_gpu_semaphore_pool_page_t *page)
 
     // Assert that no semaphores are still allocated
     UVM_ASSERT(bitmap_full(page->free_semaphores, UVM_SEMAPHORE_COUNT_PER_PAGE));
+    UVM_ASSERT(page->free_semaphores_count == UVM_SEMAPHORE_COUNT_PER_PAGE);
     UVM_ASSERT_MSG(pool->free_semaphores_count >= UVM_SEMAPHORE_COUNT_PER_PAGE,
                    "count: %u\n",
                    pool->free_semaphores_count);
+    UVM_ASSERT(pool->empty_pages_count > 0);
 
     // Check for semaphore release-after-free
     if (UVM_IS_DEBUG()) {
@@ -182,7 +209,10 @@ static void pool_free_page(uvm_gpu_semaphore_pool_page_t *page)
     }
 
     pool->free_semaphores_count -= UVM_SEMAPHORE_COUNT_PER_PAGE;
+    --pool->empty_pages_count;
+    --pool->pages_count;
     list_del(&page->all_pages_node);
+    list_del(&page->free_pages_node);
     uvm_rm_mem_free(page->memory);
     uvm_kvfree(page);
 }
@@ -191,6 +221,7 @@ NV_STATUS uvm_gpu_semaphore_alloc(uvm_gpu_semaphore_pool_t *pool, uvm_gpu_semaph
 {
     NV_STATUS status = NV_OK;
     uvm_gpu_semaphore_pool_page_t *page;
+    NvU32 semaphore_index;
 
     memset(semaphore, 0, sizeof(*semaphore));
 
@@ -202,27 +233,30 @@ NV_STATUS uvm_gpu_semaphore_alloc(uvm_gpu_semaphore_pool_t *pool, uvm_gpu_semaph
     if (status != NV_OK)
         goto done;
 
-    list_for_each_entry(page, &pool->pages, all_pages_node) {
-        NvU32 semaphore_index = find_first_bit(page->free_semaphores, UVM_SEMAPHORE_COUNT_PER_PAGE);
-        if (semaphore_index == UVM_SEMAPHORE_COUNT_PER_PAGE)
-            continue;
+    UVM_ASSERT(!list_empty(&pool->free_pages));
+    page = list_first_entry(&pool->free_pages, uvm_gpu_semaphore_pool_page_t, free_pages_node);
 
-        semaphore->payload = (NvU32*)((char*)uvm_rm_mem_get_cpu_va(page->memory) + semaphore_index * UVM_SEMAPHORE_SIZE);
-        semaphore->page = page;
+    semaphore_index = find_first_bit(page->free_semaphores, UVM_SEMAPHORE_COUNT_PER_PAGE);
+    UVM_ASSERT_MSG(semaphore_index < UVM_SEMAPHORE_COUNT_PER_PAGE,
+                   "Page in the free list has no free semaphores, count: %u\n",
+                   page->free_semaphores_count);
 
-        // Check for semaphore release-after-free
-        UVM_ASSERT(is_canary(uvm_gpu_semaphore_get_payload(semaphore)));
+    semaphore->payload = (NvU32*)((char*)uvm_rm_mem_get_cpu_va(page->memory) + semaphore_index * UVM_SEMAPHORE_SIZE);
+    semaphore->page = page;
 
-        uvm_gpu_semaphore_set_payload(semaphore, 0);
+    // Check for semaphore release-after-free
+    UVM_ASSERT(is_canary(uvm_gpu_semaphore_get_payload(semaphore)));
 
-        __clear_bit(semaphore_index, page->free_semaphores);
-        --pool->free_semaphores_count;
+    uvm_gpu_semaphore_set_payload(semaphore, 0);
 
-        goto done;
-    }
+    __clear_bit(semaphore_index, page->free_semaphores);
+    --pool->free_semaphores_count;
+
+    if (page->free_semaphores_count-- == UVM_SEMAPHORE_COUNT_PER_PAGE)
+        --pool->empty_pages_count;
 
-    UVM_ASSERT_MSG(0, "Failed to find a semaphore after allocating a new page\n");
-    status = NV_ERR_GENERIC;
+    if (page->free_semaphores_count == 0)
+        list_del_init(&page->free_pages_node);
 
 done:
     uvm_mutex_unlock(&pool->mutex);
@@ -261,6 +295,22 @@ void uvm_gpu_semaphore_free(uvm_gpu_semaphore_t *semaphore)
     ++pool->free_semaphores_count;
     __set_bit(index, page->free_semaphores);
 
+    // A page that was fully used becomes available for allocation again
+    if (page->free_semaphores_count++ == 0)
+        list_add(&page->free_pages_node, &pool->free_pages);
+
+    if (page->free_semaphores_count == UVM_SEMAPHORE_COUNT_PER_PAGE) {
+        ++pool->empty_pages_count;
+
+        // Return the page to RM if the pool already has enough empty pages.
+        // Otherwise move it to the back of the free list so that partially
+        // used pages are preferred for allocation.
+        if (pool->empty_pages_count > UVM_SEMAPHORE_POOL_MAX_EMPTY_PAGES)
+            pool_free_page(page);
+        else
+            list_move_tail(&page->free_pages_node, &pool->free_pages);
+    }
+
     uvm_mutex_unlock(&pool->mutex);
 }
 
@@ -275,6 +325,7 @@ NV_STATUS uvm_gpu_semaphore_pool_create(uvm_gpu_t *gpu, uvm_gpu_semaphore_pool_t
     uvm_mutex_init(&pool->mutex, UVM_LOCK_ORDER_GPU_SEMAPHORE_POOL);
 
     INIT_LIST_HEAD(&pool->pages);
+    INIT_LIST_HEAD(&pool->free_pages);
 
     pool->free_semaphores_count = 0;
     pool->gpu = gpu;
@@ -303,12 +354,25 @@ void uvm_gpu_semaphore_pool_destroy(uvm_gpu_semaphore_pool_t *pool)
 
     UVM_ASSERT_MSG(pool->free_semaphores_count == 0, "unused: %u", pool->free_semaphores_count);
     UVM_ASSERT(list_empty(&pool->pages));
+    UVM_ASSERT(list_empty(&pool->free_pages));
+    UVM_ASSERT(pool->pages_count == 0);
 
     uvm_mutex_unlock(&pool->mutex);
 
     uvm_kvfree(pool);
 }
 
+NvU32 uvm_gpu_semaphore_pool_get_pages_count(uvm_gpu_semaphore_pool_t *pool)
+{
+    NvU32 pages_count;
+
+    uvm_mutex_lock(&pool->mutex);
+    pages_count = pool->pages_count;
+    uvm_mutex_unlock(&pool->mutex);
+
+    return pages_count;
+}
+
 NV_STATUS uvm_gpu_semaphore_pool_map_gpu(uvm_gpu_semaphore_pool_t *pool, uvm_gpu_t *gpu)
 {
     NV_STATUS status = NV_OK;
@@ -421,7 +485,6 @@ NV_STATUS uvm_gpu_tracking_semaphore_alloc(uvm_gpu_semaphore_pool_t *pool, uvm_g
 
     UVM_ASSERT(uvm_gpu_semaphore_get_payload(&tracking_sem->semaphore) == 0);
 
-    uvm_spin_lock_init(&tracking_sem->lock, UVM_LOCK_ORDER_LEAF);
     atomic64_set(&tracking_sem->completed_value, 0);
     tracking_sem->queued_value = 0;
 
@@ -433,97 +496,90 @@ void uvm_gpu_tracking_semaphore_free(uvm_gpu_tracking_semaphore_t *tracking_sem)
     uvm_gpu_semaphore_free(&tracking_sem->semaphore);
 }
 
-static NvU64 update_completed_value_locked(uvm_gpu_tracking_semaphore_t *tracking_semaphore)
+static NvU64 update_completed_value(uvm_gpu_tracking_semaphore_t *tracking_semaphore)
 {
     NvU64 old_value = atomic64_read(&tracking_semaphore->completed_value);
-    // The semaphore value is the bottom 32 bits of completed_value
-    NvU32 old_sem_value = (NvU32)old_value;
-    NvU32 new_sem_value = uvm_gpu_semaphore_get_payload(&tracking_semaphore->semaphore);
-    NvU64 new_value;
-
-    uvm_assert_spinlock_locked(&tracking_semaphore->lock);
 
     // The following logic to update the completed value is very subtle, it
     // helps to read https://www.kernel.org/doc/Documentation/memory-barriers.txt
     // before going through this code.
-
-    if (old_sem_value == new_sem_value) {
-        // No progress since the last update.
-        // No additional memory barrier required in this case as completed_value
-        // is always updated under the spinlock that this thread just acquired.
-        // That guarantees full ordering with all the accesses the thread that
-        // updated completed_value did under the lock including the GPU
-        // semaphore read.
-        return old_value;
-    }
-
-    // Replace the bottom 32-bits with the new semaphore value
-    new_value = (old_value & 0xFFFFFFFF00000000ull) | new_sem_value;
-
-    // If we've wrapped around, add 2^32 to the value
-    // Notably the user of the GPU tracking semaphore needs to guarantee that
-    // the value is updated often enough to notice the wrap around each time it
-    // happens. In case of a channel tracking semaphore that's released for each
-    // push, it's easily guaranteed because of the small number of GPFIFO
-    // entries available per channel (there could be at most as many pending
-    // pushes as GPFIFO entries).
-    if (new_sem_value < old_sem_value)
-        new_value += 1ULL << 32;
-
-    // Use an atomic write even though the spinlock is held so that the value can
-    // be (carefully) read atomically outside of the lock.
-    //
-    // atomic64_set() on its own doesn't imply any memory barriers and we need
-    // prior memory accesses (in particular the read of the GPU semaphore
-    // payload) by this thread to be visible to other threads that see the newly
-    // set completed_value. smp_mb__before_atomic() provides that ordering.
-    //
-    // Also see the comment and matching smp_mb__after_atomic() barrier in
-    // uvm_gpu_tracking_semaphore_is_value_completed().
-    //
-    // Notably as of 4.3, atomic64_set_release() and atomic64_read_acquire()
-    // have been added that are exactly what we need and could be slightly
-    // faster on arm and powerpc than the implementation below. But at least in
-    // 4.3 the implementation looks broken for arm32 (it maps directly to
-    // smp_load_acquire() and that doesn't support 64-bit reads on 32-bit
-    // architectures) so instead of dealing with that just use a slightly bigger
-    // hammer.
-    smp_mb__before_atomic();
-    atomic64_set(&tracking_semaphore->completed_value, new_value);
-
-    // For this thread, we don't want any later accesses to be ordered above the
-    // GPU semaphore read. This could be accomplished by using a
-    // smp_load_acquire() for reading it, but given that it's also a pretty
-    // recent addition to the kernel, just leverage smp_mb__after_atomic() that
-    // guarantees that no accesses will be ordered above the atomic (and hence
-    // the GPU semaphore read).
     //
-    // Notably the soon following uvm_spin_unlock() is a release barrier that
-    // allows later memory accesses to be reordered above it and hence doesn't
-    // provide the necessary ordering with the GPU semaphore read.
-    //
-    // Also notably this would still need to be handled if we ever switch to
-    // atomic64_set_release() and atomic64_read_acquire() for accessing
-    // completed_value.
-    smp_mb__after_atomic();
+    // Any thread can advance completed_value. Updates are published with
+    // atomic64_cmpxchg(), which only succeeds if completed_value didn't change
+    // since it was read, so the GPU semaphore payload is always folded into the
+    // latest completed_value.
+
+    while (1) {
+        // The semaphore value is the bottom 32 bits of completed_value
+        NvU32 old_sem_value = (NvU32)old_value;
+        NvU32 new_sem_value;
+        NvU64 new_value;
+        NvU64 prev_value;
+
+        // atomic64_read() and a failed atomic64_cmpxchg() don't imply any
+        // memory barriers. The GPU semaphore read below needs to be ordered
+        // after the read of completed_value, which is in turn ordered after the
+        // GPU semaphore read performed by the thread that set it. That
+        // guarantees the payload read here is at least as recent as the one
+        // folded into old_value, which the wrap around detection below relies
+        // on. It also orders all the later accesses by this thread after the
+        // GPU semaphore read of the thread that set old_value, in case it's
+        // returned below. smp_mb__after_atomic() provides that ordering.
+        //
+        // Also see the comment and matching smp_mb__after_atomic() barrier in
+        // uvm_gpu_tracking_semaphore_is_value_completed().
+        smp_mb__after_atomic();
 
-    return new_value;
+        new_sem_value = uvm_gpu_semaphore_get_payload(&tracking_semaphore->semaphore);
+
+        // No progress since the last update
+        if (old_sem_value == new_sem_value)
+            return old_value;
+
+        // Replace the bottom 32-bits with the new semaphore value
+        new_value = (old_value & 0xFFFFFFFF00000000ull) | new_sem_value;
+
+        // If we've wrapped around, add 2^32 to the value
+        // Notably the user of the GPU tracking semaphore needs to guarantee
+        // that the value is updated often enough to notice the wrap around each
+        // time it happens. In case of a channel tracking semaphore that's
+        // released for each push, it's easily guaranteed because of the small
+        // number of GPFIFO entries available per channel (there could be at
+        // most as many pending pushes as GPFIFO entries).
+        if (new_sem_value < old_sem_value)
+            new_value += 1ULL << 32;
+
+        // A successful atomic64_cmpxchg() is fully ordered. Prior memory
+        // accesses (in particular the read of the GPU semaphore payload) by
+        // this thread are visible to other threads that see the newly set
+        // completed_value, and no later accesses by this thread will be
+        // ordered above the GPU semaphore read.
+        //
+        // Notably as of 4.3, atomic64_set_release() and atomic64_read_acquire()
+        // have been added, and a release/acquire pair would be enough for the
+        // publishing side. But at least in 4.3 the implementation looks broken
+        // for arm32 (it maps directly to smp_load_acquire() and that doesn't
+        // support 64-bit reads on 32-bit architectures), so they're not used
+        // for completed_value or anywhere else in UVM. Plain atomic64_set()
+        // callers pair it with smp_mb__before_atomic() instead, and the
+        // readers use atomic64_read() followed by smp_mb__after_atomic().
+        prev_value = atomic64_cmpxchg(&tracking_semaphore->completed_value, old_value, new_value);
+        if (prev_value == old_value)
+            return new_value;
+
+        // Another thread advanced completed_value since it was read. Retry
+        // with the updated value.
+        UVM_ASSERT(prev_value > old_value);
+        old_value = prev_value;
+    }
 }
 
 NvU64 uvm_gpu_tracking_semaphore_update_completed_value(uvm_gpu_tracking_semaphore_t *tracking_semaphore)
 {
-    NvU64 completed;
-
     // Check that the GPU which owns the semaphore is still present
     UVM_ASSERT(tracking_semaphore_check_gpu(tracking_semaphore));
 
-    uvm_spin_lock(&tracking_semaphore->lock);
-
-    completed = update_completed_value_locked(tracking_semaphore);
-
-    uvm_spin_unlock(&tracking_semaphore->lock);
-
-    return completed;
+    return update_completed_value(tracking_semaphore);
 }
 
 bool uvm_gpu_tracking_semaphore_is_value_completed(uvm_gpu_tracking_semaphore_t *tracking_sem, NvU64 value)
@@ -541,7 +597,7 @@ bool uvm_gpu_tracking_semaphore_is_value_completed(uvm_gpu_tracking_semaphore_t
         // the other thread prior to it setting the completed_value we read.
         // smp_mb__after_atomic() provides that ordering.
         //
-        // Also see the comment in update_completed_value_locked().
+        // Also see the comment in update_completed_value().
         smp_mb__after_atomic();
 
         return true;
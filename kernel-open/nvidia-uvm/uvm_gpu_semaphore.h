@@ -63,12 +63,10 @@ struct uvm_gpu_tracking_semaphore_struct
 
     // Last completed value
     // The bottom 32-bits will always match the latest semaphore payload seen in
-    // update_completed_value_locked().
+    // update_completed_value(), which advances it with atomic64_cmpxchg() and
+    // can be called concurrently without any lock.
     atomic64_t completed_value;
 
-    // Lock protecting updates to the completed_value
-    uvm_spinlock_t lock;
-
     // Last queued value
     // All accesses to the queued value should be handled by the user of the GPU
     // tracking semaphore.
@@ -105,10 +103,21 @@ void uvm_gpu_semaphore_pool_destroy(uvm_gpu_semaphore_pool_t *pool);
 NV_STATUS uvm_gpu_semaphore_alloc(uvm_gpu_semaphore_pool_t *pool, uvm_gpu_semaphore_t *semaphore);
 
 // Free a semaphore
+// If this was the last allocated semaphore in its page, and the pool already
+// keeps enough pages with no allocated semaphores, the page is freed.
+//
 // Locking:
 //  - Internally synchronized and hence safe to be called from multiple threads
+//  - Internally acquires:
+//    - GPU semaphore pool lock
+//    - RM API lock
+//    - RM GPUs lock
 void uvm_gpu_semaphore_free(uvm_gpu_semaphore_t *semaphore);
 
+// Get the number of pages currently backing the pool. Only meant to be used
+// by tests.
+NvU32 uvm_gpu_semaphore_pool_get_pages_count(uvm_gpu_semaphore_pool_t *pool);
+
 // Map all the semaphores from the pool on a GPU
 //
 // The mappings are added to UVM's internal address space, and (in SR-IOV heavy)
@@ -26,6 +26,7 @@
 #include "uvm_test.h"
 #include "uvm_va_space.h"
 #include "uvm_kvmalloc.h"
+#include "nv-kthread-q.h"
 
 static NV_STATUS add_and_test(uvm_gpu_tracking_semaphore_t *tracking_sem, NvU32 increment_by)
 {
@@ -83,6 +84,144 @@ done:
     return status;
 }
 
+#define TRACKING_STRESS_NUM_READERS 4
+#define TRACKING_STRESS_ITERATIONS (64 * 1024)
+
+// Advance the payload by 2^30 on each iteration, so the 32-bit payload wraps
+// around every 4 iterations
+#define TRACKING_STRESS_INCREMENT (1u << 30)
+
+typedef struct
+{
+    uvm_gpu_tracking_semaphore_t *tracking_sem;
+
+    // Latest value written to the semaphore payload
+    atomic64_t *released_value;
+
+    // Set when the writer is done
+    atomic_t *stop;
+
+    nv_kthread_q_t q;
+    nv_kthread_q_item_t q_item;
+
+    NvU64 num_updates;
+
+    NV_STATUS status;
+} tracking_stress_reader_t;
+
+static void tracking_stress_reader_func(void *args)
+{
+    tracking_stress_reader_t *reader = (tracking_stress_reader_t *)args;
+    NvU64 last_completed = 0;
+
+    while (!atomic_read(reader->stop)) {
+        NvU64 completed = uvm_gpu_tracking_semaphore_update_completed_value(reader->tracking_sem);
+
+        // The completed value never goes backwards, and never goes past the
+        // last value released by the writer, which would happen if a wrap
+        // around was accounted for more than once.
+        if (completed < last_completed || completed > atomic64_read(reader->released_value)) {
+            UVM_TEST_PRINT("Unexpected completed value 0x%llx, last 0x%llx, released 0x%llx\n",
+                           completed,
+                           last_completed,
+                           (NvU64)atomic64_read(reader->released_value));
+            reader->status = NV_ERR_INVALID_STATE;
+            return;
+        }
+
+        last_completed = completed;
+        ++reader->num_updates;
+
+        cond_resched();
+    }
+}
+
+// Multiple threads update the completed value of a tracking semaphore while
+// the CPU plays the role of the GPU, releasing increasing values on the
+// semaphore payload in sysmem.
+static NV_STATUS test_tracking_stress(uvm_va_space_t *va_space)
+{
+    NV_STATUS status;
+    uvm_gpu_tracking_semaphore_t tracking_sem;
+    tracking_stress_reader_t *readers;
+    atomic64_t released_value;
+    atomic_t stop;
+    NvU64 value = 0;
+    int num_started = 0;
+    int i;
+    uvm_gpu_t *gpu = uvm_va_space_find_first_gpu(va_space);
+
+    if (gpu == NULL)
+        return NV_ERR_INVALID_STATE;
+
+    readers = uvm_kvmalloc_zero(TRACKING_STRESS_NUM_READERS * sizeof(*readers));
+    if (!readers)
+        return NV_ERR_NO_MEMORY;
+
+    status = uvm_gpu_tracking_semaphore_alloc(gpu->semaphore_pool, &tracking_sem);
+    if (status != NV_OK)
+        goto done_free;
+
+    atomic64_set(&released_value, 0);
+    atomic_set(&stop, 0);
+
+    for (i = 0; i < TRACKING_STRESS_NUM_READERS; ++i) {
+        tracking_stress_reader_t *reader = &readers[i];
+
+        reader->tracking_sem = &tracking_sem;
+        reader->released_value = &released_value;
+        reader->stop = &stop;
+
+        if (nv_kthread_q_init(&reader->q, "uvm_tracking_sem_stress") != 0) {
+            status = NV_ERR_NO_MEMORY;
+            goto done;
+        }
+
+        ++num_started;
+
+        nv_kthread_q_item_init(&reader->q_item, tracking_stress_reader_func, reader);
+        nv_kthread_q_schedule_q_item(&reader->q, &reader->q_item);
+    }
+
+    for (i = 0; i < TRACKING_STRESS_ITERATIONS; ++i) {
+        NvU64 completed;
+
+        value += TRACKING_STRESS_INCREMENT;
+        tracking_sem.queued_value = value;
+
+        // Publish the value before releasing it, so readers never observe a
+        // completed value greater than the released one
+        atomic64_set(&released_value, value);
+        uvm_gpu_semaphore_set_payload(&tracking_sem.semaphore, (NvU32)value);
+
+        // Update the completed value after every release, as channels do, so
+        // no wrap around is missed regardless of the reader threads
+        completed = uvm_gpu_tracking_semaphore_update_completed_value(&tracking_sem);
+        TEST_CHECK_GOTO(completed == value, done);
+        TEST_CHECK_GOTO(uvm_gpu_tracking_semaphore_is_completed(&tracking_sem), done);
+
+        if (i % 1024 == 0)
+            cond_resched();
+    }
+
+done:
+    atomic_set(&stop, 1);
+
+    for (i = 0; i < num_started; ++i) {
+        nv_kthread_q_stop(&readers[i].q);
+
+        if (status == NV_OK)
+            status = readers[i].status;
+    }
+
+    uvm_gpu_tracking_semaphore_free(&tracking_sem);
+
+done_free:
+    uvm_kvfree(readers);
+
+    return status;
+}
+
 #define NUM_SEMAPHORES_PER_GPU 4096
 
 static NV_STATUS test_alloc(uvm_va_space_t *va_space)
@@ -140,6 +279,73 @@ done:
     return status;
 }
 
+#define NUM_SEMAPHORES_SCALABILITY (16 * 1024)
+
+// Allocate enough semaphores to span many pool pages, fragment the pool by
+// freeing every other semaphore, and check that the freed slots are reused
+// without growing the pool, and that the pool shrinks back once all the
+// semaphores are freed.
+static NV_STATUS test_alloc_scalability(uvm_va_space_t *va_space)
+{
+    NV_STATUS status = NV_OK;
+    uvm_gpu_semaphore_t *semaphores;
+    uvm_gpu_semaphore_pool_t *pool;
+    NvU32 initial_pages_count;
+    NvU32 pages_count;
+    NvU32 i;
+    uvm_gpu_t *gpu = uvm_va_space_find_first_gpu(va_space);
+
+    if (gpu == NULL)
+        return NV_ERR_INVALID_STATE;
+
+    pool = gpu->semaphore_pool;
+
+    semaphores = uvm_kvmalloc_zero(NUM_SEMAPHORES_SCALABILITY * sizeof(*semaphores));
+    if (semaphores == NULL)
+        return NV_ERR_NO_MEMORY;
+
+    initial_pages_count = uvm_gpu_semaphore_pool_get_pages_count(pool);
+
+    for (i = 0; i < NUM_SEMAPHORES_SCALABILITY; ++i) {
+        TEST_NV_CHECK_GOTO(uvm_gpu_semaphore_alloc(pool, &semaphores[i]), done);
+        uvm_gpu_semaphore_set_payload(&semaphores[i], i);
+    }
+
+    pages_count = uvm_gpu_semaphore_pool_get_pages_count(pool);
+    TEST_CHECK_GOTO(pages_count > initial_pages_count, done);
+
+    for (i = 0; i < NUM_SEMAPHORES_SCALABILITY; i += 2)
+        uvm_gpu_semaphore_free(&semaphores[i]);
+
+    // None of the pages is completely free, so none can be reclaimed
+    TEST_CHECK_GOTO(uvm_gpu_semaphore_pool_get_pages_count(pool) == pages_count, done);
+
+    for (i = 0; i < NUM_SEMAPHORES_SCALABILITY; i += 2) {
+        TEST_NV_CHECK_GOTO(uvm_gpu_semaphore_alloc(pool, &semaphores[i]), done);
+        uvm_gpu_semaphore_set_payload(&semaphores[i], i);
+    }
+
+    // The freed slots are reused before growing the pool
+    TEST_CHECK_GOTO(uvm_gpu_semaphore_pool_get_pages_count(pool) == pages_count, done);
+
+    // No semaphore is handed out twice
+    for (i = 0; i < NUM_SEMAPHORES_SCALABILITY; ++i)
+        TEST_CHECK_GOTO(uvm_gpu_semaphore_get_payload(&semaphores[i]) == i, done);
+
+done:
+    for (i = 0; i < NUM_SEMAPHORES_SCALABILITY; ++i)
+        uvm_gpu_semaphore_free(&semaphores[i]);
+
+    uvm_kvfree(semaphores);
+
+    // Pages left empty are returned to RM, except for a small number kept
+    // around to avoid thrashing
+    if (status == NV_OK)
+        TEST_CHECK_RET(uvm_gpu_semaphore_pool_get_pages_count(pool) <= initial_pages_count + 1);
+
+    return status;
+}
+
 
 NV_STATUS uvm_test_gpu_semaphore_sanity(UVM_TEST_GPU_SEMAPHORE_SANITY_PARAMS *params, struct file *filp)
 {
@@ -153,10 +359,18 @@ NV_STATUS uvm_test_gpu_semaphore_sanity(UVM_TEST_GPU_SEMAPHORE_SANITY_PARAMS *pa
     if (status != NV_OK)
         goto done;
 
+    status = test_alloc_scalability(va_space);
+    if (status != NV_OK)
+        goto done;
+
     status = test_tracking(va_space);
     if (status != NV_OK)
         goto done;
 
+    status = test_tracking_stress(va_space);
+    if (status != NV_OK)
+        goto done;
+
 done:
     uvm_va_space_up_read_rm(va_space);
     uvm_mutex_unlock(&g_uvm_global.global_lock);
@@ -494,6 +494,10 @@ struct uvm_access_counter_buffer_entry_struct
             // a regular processor id because P2P is not allowed between
             // partitioned GPUs.
             uvm_processor_id_t resident_id;
+
+            // Whether the notification was found to map to managed memory
+            // during servicing. Set by the access counter servicing code.
+            bool on_managed;
         } physical_info;
     };
 
@@ -249,15 +249,19 @@ static bool uvm_hmm_vma_is_valid(struct vm_area_struct *vma,
            (allow_unreadable_vma || (vma->vm_flags & VM_READ));
 }
 
+// If vma_hint is not NULL and *vma_hint covers addr, it is used instead of
+// looking up the VMA. On success, *vma_hint is set to the VMA covering addr.
 static NV_STATUS hmm_va_block_find_create(uvm_va_space_t *va_space,
                                           NvU64 addr,
                                           bool allow_unreadable_vma,
+                                          struct vm_area_struct **vma_hint,
                                           uvm_va_block_context_t *va_block_context,
                                           uvm_va_block_t **va_block_ptr)
 {
     struct mm_struct *mm = va_space->va_space_mm.mm;
     struct vm_area_struct *vma;
     uvm_va_block_t *va_block;
+    uvm_range_lock_entry_t range_lock_entry;
     NvU64 start, end;
     NV_STATUS status;
     int ret;
@@ -272,10 +276,24 @@ static NV_STATUS hmm_va_block_find_create(uvm_va_space_t *va_space,
     UVM_ASSERT(PAGE_ALIGNED(addr));
 
     // Note that we have to allow PROT_NONE VMAs so that policies can be set.
-    vma = find_vma(mm, addr);
+    if (vma_hint && *vma_hint && addr >= (*vma_hint)->vm_start && addr < (*vma_hint)->vm_end)
+        vma = *vma_hint;
+    else
+        vma = find_vma(mm, addr);
+
     if (!uvm_hmm_vma_is_valid(vma, addr, allow_unreadable_vma))
         return NV_ERR_INVALID_ADDRESS;
 
+    // uvm_free() tears down external va_ranges after removing them from the
+    // va_range tree and downgrading the va_space lock. Lock the aligned
+    // interval the va_block may cover so it isn't created over a va_range
+    // still being torn down.
+    uvm_range_lock_acquire(&va_space->range_lock,
+                           &range_lock_entry,
+                           UVM_VA_BLOCK_ALIGN_DOWN(addr),
+                           UVM_VA_BLOCK_ALIGN_DOWN(addr) + UVM_VA_BLOCK_SIZE - 1,
+                           UVM_LOCK_FLAGS_MODE_SHARED);
+
     // Since we only hold the va_space read lock, there can be multiple
     // parallel va_block insertions.
     uvm_mutex_lock(&va_space->hmm.blocks_lock);
@@ -329,8 +347,11 @@ static NV_STATUS hmm_va_block_find_create(uvm_va_space_t *va_space,
 
 done:
     uvm_mutex_unlock(&va_space->hmm.blocks_lock);
+    uvm_range_lock_release(&va_space->range_lock, &range_lock_entry);
     if (va_block_context)
         va_block_context->hmm.vma = vma;
+    if (vma_hint)
+        *vma_hint = vma;
     *va_block_ptr = va_block;
     return NV_OK;
 
@@ -342,6 +363,7 @@ err_release:
 
 err_unlock:
     uvm_mutex_unlock(&va_space->hmm.blocks_lock);
+    uvm_range_lock_release(&va_space->range_lock, &range_lock_entry);
     return status;
 }
 
@@ -350,7 +372,18 @@ NV_STATUS uvm_hmm_va_block_find_create(uvm_va_space_t *va_space,
                                        uvm_va_block_context_t *va_block_context,
                                        uvm_va_block_t **va_block_ptr)
 {
-    return hmm_va_block_find_create(va_space, addr, false, va_block_context, va_block_ptr);
+    return hmm_va_block_find_create(va_space, addr, false, NULL, va_block_context, va_block_ptr);
+}
+
+NV_STATUS uvm_hmm_va_block_find_create_hint(uvm_va_space_t *va_space,
+                                            NvU64 addr,
+                                            struct vm_area_struct **vma_hint,
+                                            uvm_va_block_context_t *va_block_context,
+                                            uvm_va_block_t **va_block_ptr)
+{
+    UVM_ASSERT(vma_hint);
+
+    return hmm_va_block_find_create(va_space, addr, false, vma_hint, va_block_context, va_block_ptr);
 }
 
 typedef struct {
@@ -628,6 +661,7 @@ NV_STATUS uvm_hmm_set_preferred_location(uvm_va_space_t *va_space,
 {
     bool is_default = UVM_ID_IS_INVALID(preferred_location);
     uvm_va_block_t *va_block;
+    struct vm_area_struct *vma_hint = NULL;
     NvU64 addr;
     NV_STATUS status = NV_OK;
 
@@ -645,7 +679,7 @@ NV_STATUS uvm_hmm_set_preferred_location(uvm_va_space_t *va_space,
     for (addr = base; addr < last_address; addr = va_block->end + 1) {
         NvU64 end;
 
-        status = hmm_va_block_find_create(va_space, addr, true, NULL, &va_block);
+        status = hmm_va_block_find_create(va_space, addr, true, &vma_hint, NULL, &va_block);
         if (status != NV_OK)
             break;
 
@@ -682,6 +716,7 @@ NV_STATUS uvm_hmm_set_accessed_by(uvm_va_space_t *va_space,
                                   NvU64 last_address)
 {
     uvm_va_block_t *va_block;
+    struct vm_area_struct *vma_hint = NULL;
     NvU64 addr;
     NV_STATUS status = NV_OK;
 
@@ -699,7 +734,7 @@ NV_STATUS uvm_hmm_set_accessed_by(uvm_va_space_t *va_space,
     for (addr = base; addr < last_address; addr = va_block->end + 1) {
         NvU64 end;
 
-        status = hmm_va_block_find_create(va_space, addr, true, NULL, &va_block);
+        status = hmm_va_block_find_create(va_space, addr, true, &vma_hint, NULL, &va_block);
         if (status != NV_OK)
             break;
 
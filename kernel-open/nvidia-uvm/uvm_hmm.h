@@ -94,6 +94,19 @@ typedef struct
                                            uvm_va_block_context_t *va_block_context,
                                            uvm_va_block_t **va_block_ptr);
 
+    // Same as uvm_hmm_va_block_find_create(), but the VMA lookup is skipped if
+    // *vma_hint covers 'addr'. On success, *vma_hint is set to the VMA that
+    // covers 'addr', so that callers walking an address range in order only
+    // look up each VMA once. *vma_hint must be NULL on the first call.
+    // The hint is only valid while the mmap_lock is held, it must be reset to
+    // NULL whenever the lock is dropped.
+    // Locking: Same as uvm_hmm_va_block_find_create().
+    NV_STATUS uvm_hmm_va_block_find_create_hint(uvm_va_space_t *va_space,
+                                                NvU64 addr,
+                                                struct vm_area_struct **vma_hint,
+                                                uvm_va_block_context_t *va_block_context,
+                                                uvm_va_block_t **va_block_ptr);
+
     // Reclaim any HMM va_blocks that overlap the given range.
     // Note that 'end' is inclusive.
     // A HMM va_block can be reclaimed if it doesn't contain any "valid" VMAs.
@@ -226,6 +239,15 @@ typedef struct
         return NV_ERR_INVALID_ADDRESS;
     }
 
+    static NV_STATUS uvm_hmm_va_block_find_create_hint(uvm_va_space_t *va_space,
+                                                       NvU64 addr,
+                                                       struct vm_area_struct **vma_hint,
+                                                       uvm_va_block_context_t *va_block_context,
+                                                       uvm_va_block_t **va_block_ptr)
+    {
+        return NV_ERR_INVALID_ADDRESS;
+    }
+
     static NV_STATUS uvm_hmm_va_block_reclaim(uvm_va_space_t *va_space,
                                               struct mm_struct *mm,
                                               NvU64 start,
@@ -28,6 +28,43 @@
 #include "uvm_va_range.h"
 #include "uvm_hmm.h"
 
+// Find or create all the HMM va_blocks covering [start, start + length) in
+// address order, like servicing a batch of faults streaming through a large
+// malloc() buffer would, and return the rate in pages per second.
+static NV_STATUS test_find_create_range(uvm_va_space_t *va_space,
+                                        NvU64 start,
+                                        NvU64 length,
+                                        NvU64 *pages_per_sec)
+{
+    struct vm_area_struct *vma_hint = NULL;
+    uvm_va_block_t *hmm_block;
+    NvU64 addr = start & PAGE_MASK;
+    NvU64 end = start + length - 1;
+    NvU64 num_pages = 0;
+    NvU64 start_time;
+    NvU64 elapsed_ns;
+    NV_STATUS status;
+
+    start_time = NV_GETTIME();
+
+    while (addr <= end) {
+        status = uvm_hmm_va_block_find_create_hint(va_space, addr, &vma_hint, NULL, &hmm_block);
+        if (status != NV_OK)
+            return status;
+
+        TEST_CHECK_RET(addr >= hmm_block->start && addr <= hmm_block->end);
+        TEST_CHECK_RET(addr >= vma_hint->vm_start && addr < vma_hint->vm_end);
+
+        num_pages += (min(end, hmm_block->end) - addr + 1) / PAGE_SIZE;
+        addr = hmm_block->end + 1;
+    }
+
+    elapsed_ns = NV_GETTIME() - start_time;
+    *pages_per_sec = elapsed_ns ? num_pages * 1000000000ull / elapsed_ns : 0;
+
+    return NV_OK;
+}
+
 NV_STATUS uvm_test_hmm_sanity(UVM_TEST_HMM_SANITY_PARAMS *params, struct file *filp)
 {
     uvm_va_space_t *va_space = uvm_va_space_get(filp);
@@ -74,6 +111,17 @@ NV_STATUS uvm_test_hmm_sanity(UVM_TEST_HMM_SANITY_PARAMS *params, struct file *f
     status = uvm_hmm_va_block_find(va_space, params->hmm_address, &hmm_block);
     TEST_CHECK_GOTO(status == NV_OK, done);
 
+    // Create the rest of the va_blocks covering the HMM allocation. The
+    // va_block for hmm_address already exists so that the reported rate
+    // mostly covers creation of new va_blocks.
+    if (params->hmm_length > 0) {
+        status = test_find_create_range(va_space,
+                                        params->hmm_address,
+                                        params->hmm_length,
+                                        &params->find_create_pages_per_sec);
+        TEST_CHECK_GOTO(status == NV_OK, done);
+    }
+
 done:
     uvm_va_space_up_read(va_space);
     uvm_up_read_mmap_lock(mm);
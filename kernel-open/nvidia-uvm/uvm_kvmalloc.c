@@ -26,6 +26,9 @@
 #include "uvm_global.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_rb_tree.h"
+#include "uvm_procfs.h"
+
+#include <linux/rculist.h>
 
 // To implement realloc for vmalloc-based allocations we need to track the size
 // of the original allocation. We can do that by allocating a header along with
@@ -39,11 +42,29 @@ typedef struct
     uint8_t ptr[0];
 } uvm_vmalloc_hdr_t;
 
+// Allocations tracked with UVM_KVMALLOC_LEAK_CHECK_ORIGIN are aggregated per
+// call site. Sites are added as they are first seen and are only freed on
+// uvm_kvmalloc_exit, so they can be looked up under rcu_read_lock() without
+// taking any lock.
 typedef struct
 {
     const char *file;
     const char *function;
     int line;
+
+    // Number of outstanding tracked allocations from this site
+    atomic_long_t allocations;
+
+    // Outstanding bytes of the tracked allocations from this site
+    atomic_long_t bytes;
+
+    struct hlist_node hash_node;
+} uvm_kvmalloc_site_t;
+
+typedef struct
+{
+    uvm_kvmalloc_site_t *site;
+    size_t size;
     uvm_rb_tree_node_t node;
 } uvm_kvmalloc_info_t;
 
@@ -55,6 +76,22 @@ typedef enum
     UVM_KVMALLOC_LEAK_CHECK_COUNT
 } uvm_kvmalloc_leak_check_t;
 
+// Outstanding allocations are spread by address across shards, each with its
+// own lock and tree, so that concurrent allocations and frees rarely contend.
+#define UVM_KVMALLOC_LEAK_CHECK_SHARDS 64
+
+#define UVM_KVMALLOC_SITES_HASH_SIZE 1024
+
+typedef struct
+{
+    // Use a raw spinlock rather than a uvm_spinlock_t because the kvmalloc
+    // layer is initialized and torn down before the thread context layer.
+    spinlock_t lock;
+
+    // Table of the outstanding allocations in this shard
+    uvm_rb_tree_t allocation_info;
+} ____cacheline_aligned_in_smp uvm_kvmalloc_leak_shard_t;
+
 // This is used just to make sure that the APIs aren't used outside of
 // uvm_kvmalloc_init/uvm_kvmalloc_exit. The memory allocation would still work
 // fine, but the leak checker would get confused.
@@ -69,16 +106,20 @@ static struct
     // for sanity checks.
     atomic_long_t untracked_allocations;
 
-    // Use a raw spinlock rather than a uvm_spinlock_t because the kvmalloc
-    // layer is initialized and torn down before the thread context layer.
-    spinlock_t lock;
+    uvm_kvmalloc_leak_shard_t shards[UVM_KVMALLOC_LEAK_CHECK_SHARDS];
 
-    // Table of all outstanding allocations
-    uvm_rb_tree_t allocation_info;
+    // Call site table. The lock only serializes the insertion of new sites.
+    spinlock_t sites_lock;
+    struct hlist_head sites[UVM_KVMALLOC_SITES_HASH_SIZE];
 
     struct kmem_cache *info_cache;
+
+    struct proc_dir_entry *procfs_file;
 } g_uvm_leak_checker;
 
+// Per-CPU allocation counter used to pick the sampled allocations
+static DEFINE_PER_CPU(unsigned, g_uvm_leak_checker_sample_count);
+
 // Default to byte-count-only leak checking for non-release builds. This can
 // always be overridden by the module parameter.
 static int uvm_leak_checker = (UVM_IS_DEBUG() || UVM_IS_DEVELOP()) ?
@@ -90,11 +131,144 @@ MODULE_PARM_DESC(uvm_leak_checker,
                  "Enable uvm memory leak checking. "
                  "0 = disabled, 1 = count total bytes allocated and freed, 2 = per-allocation origin tracking.");
 
+static unsigned uvm_leak_checker_sample_rate = 1;
+module_param(uvm_leak_checker_sample_rate, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_leak_checker_sample_rate,
+                 "With uvm_leak_checker=2, only track the origin of one in every N allocations. "
+                 "Per-site counts are scaled by N when reported. Default: 1 (track all allocations).");
+
+static bool leak_checker_is_sampling(void)
+{
+    return uvm_leak_checker_sample_rate > 1;
+}
+
+static uvm_kvmalloc_leak_shard_t *shard_get(void *p)
+{
+    NvU64 key = (NvU64)((uintptr_t)p);
+
+    return &g_uvm_leak_checker.shards[jhash_2words((NvU32)key, (NvU32)(key >> 32), 0) %
+                                      UVM_KVMALLOC_LEAK_CHECK_SHARDS];
+}
+
+static struct hlist_head *site_bucket_get(const char *file, int line)
+{
+    NvU64 key = (NvU64)((uintptr_t)file);
+
+    return &g_uvm_leak_checker.sites[jhash_3words((NvU32)key, (NvU32)(key >> 32), (NvU32)line, 0) %
+                                     UVM_KVMALLOC_SITES_HASH_SIZE];
+}
+
+static uvm_kvmalloc_site_t *site_find(struct hlist_head *bucket, const char *file, int line)
+{
+    uvm_kvmalloc_site_t *site;
+
+    hlist_for_each_entry_rcu(site, bucket, hash_node) {
+        if (site->file == file && site->line == line)
+            return site;
+    }
+
+    return NULL;
+}
+
+// Returns the site for the given origin, adding it to the table if needed.
+// Returns NULL if a new site could not be allocated.
+static uvm_kvmalloc_site_t *site_get(const char *file, int line, const char *function)
+{
+    struct hlist_head *bucket = site_bucket_get(file, line);
+    uvm_kvmalloc_site_t *site;
+    uvm_kvmalloc_site_t *new_site;
+    unsigned long irq_flags;
+
+    rcu_read_lock();
+    site = site_find(bucket, file, line);
+    rcu_read_unlock();
+
+    if (site)
+        return site;
+
+    // Sites are allocated directly with kmalloc to not recurse into the
+    // tracking.
+    new_site = kzalloc(sizeof(*new_site), NV_UVM_GFP_FLAGS);
+    if (!new_site)
+        return NULL;
+
+    new_site->file     = file;
+    new_site->function = function;
+    new_site->line     = line;
+
+    // Someone else might have added the site in the meantime
+    spin_lock_irqsave(&g_uvm_leak_checker.sites_lock, irq_flags);
+    site = site_find(bucket, file, line);
+    if (!site)
+        hlist_add_head_rcu(&new_site->hash_node, bucket);
+    spin_unlock_irqrestore(&g_uvm_leak_checker.sites_lock, irq_flags);
+
+    if (site) {
+        kfree(new_site);
+        return site;
+    }
+
+    return new_site;
+}
+
+static int nv_procfs_read_kvmalloc_sites(struct seq_file *s, void *v)
+{
+    unsigned scale = leak_checker_is_sampling() ? uvm_leak_checker_sample_rate : 1;
+    size_t i;
+
+    UVM_SEQ_OR_DBG_PRINT(s, "bytes_allocated         %ld\n", atomic_long_read(&g_uvm_leak_checker.bytes_allocated));
+    UVM_SEQ_OR_DBG_PRINT(s, "untracked_allocations   %ld\n",
+                         atomic_long_read(&g_uvm_leak_checker.untracked_allocations));
+    UVM_SEQ_OR_DBG_PRINT(s, "sample_rate             %u\n", scale);
+    UVM_SEQ_OR_DBG_PRINT(s, "%12s %14s  %s\n", "allocations", "bytes", "site");
+
+    // Sites are never removed while allocations can happen, so the table can
+    // be walked without blocking concurrent allocations and frees. The counts
+    // of the individual sites are not a consistent snapshot.
+    rcu_read_lock();
+    for (i = 0; i < UVM_KVMALLOC_SITES_HASH_SIZE; i++) {
+        uvm_kvmalloc_site_t *site;
+
+        hlist_for_each_entry_rcu(site, &g_uvm_leak_checker.sites[i], hash_node) {
+            long allocations = atomic_long_read(&site->allocations);
+
+            if (allocations == 0)
+                continue;
+
+            UVM_SEQ_OR_DBG_PRINT(s,
+                                 "%12ld %14ld  %s:%d:%s\n",
+                                 allocations * scale,
+                                 atomic_long_read(&site->bytes) * scale,
+                                 kbasename(site->file),
+                                 site->line,
+                                 site->function);
+        }
+    }
+    rcu_read_unlock();
+
+    return 0;
+}
+
+static int nv_procfs_read_kvmalloc_sites_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_kvmalloc_sites(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(kvmalloc_sites_entry);
+
 NV_STATUS uvm_kvmalloc_init(void)
 {
     if (uvm_leak_checker >= UVM_KVMALLOC_LEAK_CHECK_ORIGIN) {
-        spin_lock_init(&g_uvm_leak_checker.lock);
-        uvm_rb_tree_init(&g_uvm_leak_checker.allocation_info);
+        size_t i;
+
+        for (i = 0; i < UVM_KVMALLOC_LEAK_CHECK_SHARDS; i++) {
+            spin_lock_init(&g_uvm_leak_checker.shards[i].lock);
+            uvm_rb_tree_init(&g_uvm_leak_checker.shards[i].allocation_info);
+        }
+
+        spin_lock_init(&g_uvm_leak_checker.sites_lock);
+        for (i = 0; i < UVM_KVMALLOC_SITES_HASH_SIZE; i++)
+            INIT_HLIST_HEAD(&g_uvm_leak_checker.sites[i]);
 
         g_uvm_leak_checker.info_cache = NV_KMEM_CACHE_CREATE("uvm_kvmalloc_info_t", uvm_kvmalloc_info_t);
         if (!g_uvm_leak_checker.info_cache)
@@ -105,6 +279,23 @@ NV_STATUS uvm_kvmalloc_init(void)
     return NV_OK;
 }
 
+NV_STATUS uvm_kvmalloc_procfs_init(void)
+{
+    if (uvm_leak_checker < UVM_KVMALLOC_LEAK_CHECK_ORIGIN || !uvm_procfs_is_enabled())
+        return NV_OK;
+
+    // The file is removed along with the rest of the UVM procfs directory in
+    // uvm_procfs_exit().
+    g_uvm_leak_checker.procfs_file = NV_CREATE_PROC_FILE("kvmalloc_sites",
+                                                         uvm_procfs_get_cpu_base_dir(),
+                                                         kvmalloc_sites_entry,
+                                                         NULL);
+    if (!g_uvm_leak_checker.procfs_file)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    return NV_OK;
+}
+
 void uvm_kvmalloc_exit(void)
 {
     if (!g_malloc_initialized)
@@ -125,26 +316,38 @@ void uvm_kvmalloc_exit(void)
 
     if (uvm_leak_checker >= UVM_KVMALLOC_LEAK_CHECK_ORIGIN) {
         uvm_rb_tree_node_t *node, *next;
-
-        uvm_rb_tree_for_each_safe(node, next, &g_uvm_leak_checker.allocation_info) {
-            uvm_kvmalloc_info_t *info = container_of(node, uvm_kvmalloc_info_t, node);
-
-            printk(KERN_ERR NVIDIA_UVM_PRETTY_PRINTING_PREFIX "    Leaked %zu bytes from %s:%d:%s (0x%llx)\n",
-                   uvm_kvsize((void *)((uintptr_t)info->node.key)),
-                   kbasename(info->file),
-                   info->line,
-                   info->function,
-                   info->node.key);
-
-            // Free so we don't keep eating up memory while debugging. Note that
-            // this also removes the entry from the table, frees info, and drops
-            // the allocated bytes count.
-            uvm_kvfree((void *)((uintptr_t)info->node.key));
+        struct hlist_node *tmp;
+        uvm_kvmalloc_site_t *site;
+        size_t i;
+
+        for (i = 0; i < UVM_KVMALLOC_LEAK_CHECK_SHARDS; i++) {
+            uvm_rb_tree_for_each_safe(node, next, &g_uvm_leak_checker.shards[i].allocation_info) {
+                uvm_kvmalloc_info_t *info = container_of(node, uvm_kvmalloc_info_t, node);
+
+                printk(KERN_ERR NVIDIA_UVM_PRETTY_PRINTING_PREFIX "    Leaked %zu bytes from %s:%d:%s (0x%llx)\n",
+                       info->size,
+                       kbasename(info->site->file),
+                       info->site->line,
+                       info->site->function,
+                       info->node.key);
+
+                // Free so we don't keep eating up memory while debugging. Note
+                // that this also removes the entry from the table, frees info,
+                // and drops the allocated bytes count.
+                uvm_kvfree((void *)((uintptr_t)info->node.key));
+            }
         }
 
-        if (atomic_long_read(&g_uvm_leak_checker.untracked_allocations) == 0)
+        if (atomic_long_read(&g_uvm_leak_checker.untracked_allocations) == 0 && !leak_checker_is_sampling())
             UVM_ASSERT(atomic_long_read(&g_uvm_leak_checker.bytes_allocated) == 0);
 
+        for (i = 0; i < UVM_KVMALLOC_SITES_HASH_SIZE; i++) {
+            hlist_for_each_entry_safe(site, tmp, &g_uvm_leak_checker.sites[i], hash_node) {
+                hlist_del(&site->hash_node);
+                kfree(site);
+            }
+        }
+
         kmem_cache_destroy_safe(&g_uvm_leak_checker.info_cache);
     }
 
@@ -153,12 +356,13 @@ void uvm_kvmalloc_exit(void)
 
 static void insert_info(uvm_kvmalloc_info_t *info)
 {
+    uvm_kvmalloc_leak_shard_t *shard = shard_get((void *)((uintptr_t)info->node.key));
     NV_STATUS status;
     unsigned long irq_flags;
 
-    spin_lock_irqsave(&g_uvm_leak_checker.lock, irq_flags);
-    status = uvm_rb_tree_insert(&g_uvm_leak_checker.allocation_info, &info->node);
-    spin_unlock_irqrestore(&g_uvm_leak_checker.lock, irq_flags);
+    spin_lock_irqsave(&shard->lock, irq_flags);
+    status = uvm_rb_tree_insert(&shard->allocation_info, &info->node);
+    spin_unlock_irqrestore(&shard->lock, irq_flags);
 
     // We shouldn't have duplicates
     UVM_ASSERT(status == NV_OK);
@@ -166,19 +370,23 @@ static void insert_info(uvm_kvmalloc_info_t *info)
 
 static uvm_kvmalloc_info_t *remove_info(void *p)
 {
+    uvm_kvmalloc_leak_shard_t *shard = shard_get(p);
     uvm_rb_tree_node_t *node;
     uvm_kvmalloc_info_t *info = NULL;
     unsigned long irq_flags;
 
-    spin_lock_irqsave(&g_uvm_leak_checker.lock, irq_flags);
-    node = uvm_rb_tree_find(&g_uvm_leak_checker.allocation_info, (NvU64)p);
+    spin_lock_irqsave(&shard->lock, irq_flags);
+    node = uvm_rb_tree_find(&shard->allocation_info, (NvU64)p);
     if (node)
-        uvm_rb_tree_remove(&g_uvm_leak_checker.allocation_info, node);
-    spin_unlock_irqrestore(&g_uvm_leak_checker.lock, irq_flags);
+        uvm_rb_tree_remove(&shard->allocation_info, node);
+    spin_unlock_irqrestore(&shard->lock, irq_flags);
 
     if (!node) {
-        UVM_ASSERT(atomic_long_read(&g_uvm_leak_checker.untracked_allocations) > 0);
-        atomic_long_dec(&g_uvm_leak_checker.untracked_allocations);
+        // Allocations skipped by sampling are not in the table either
+        if (!leak_checker_is_sampling()) {
+            UVM_ASSERT(atomic_long_read(&g_uvm_leak_checker.untracked_allocations) > 0);
+            atomic_long_dec(&g_uvm_leak_checker.untracked_allocations);
+        }
     }
     else {
         info = container_of(node, uvm_kvmalloc_info_t, node);
@@ -187,11 +395,28 @@ static uvm_kvmalloc_info_t *remove_info(void *p)
     return info;
 }
 
+static void free_info(uvm_kvmalloc_info_t *info)
+{
+    atomic_long_dec(&info->site->allocations);
+    atomic_long_sub(info->size, &info->site->bytes);
+    kmem_cache_free(g_uvm_leak_checker.info_cache, info);
+}
+
+// Returns true if the origin of the current allocation should be tracked
+static bool alloc_tracking_sample(void)
+{
+    if (!leak_checker_is_sampling())
+        return true;
+
+    return (this_cpu_inc_return(g_uvm_leak_checker_sample_count) % uvm_leak_checker_sample_rate) == 0;
+}
+
 static void alloc_tracking_add(void *p, const char *file, int line, const char *function)
 {
     // Add uvm_kvsize(p) instead of size because uvm_kvsize might be larger (due
     // to ksize), and uvm_kvfree only knows about uvm_kvsize
     size_t size = uvm_kvsize(p);
+    uvm_kvmalloc_site_t *site;
     uvm_kvmalloc_info_t *info;
 
     UVM_ASSERT(g_malloc_initialized);
@@ -202,17 +427,24 @@ static void alloc_tracking_add(void *p, const char *file, int line, const char *
     atomic_long_add(size, &g_uvm_leak_checker.bytes_allocated);
 
     if (uvm_leak_checker >= UVM_KVMALLOC_LEAK_CHECK_ORIGIN) {
+        if (!alloc_tracking_sample())
+            return;
+
         // Silently ignore OOM errors
-        info = nv_kmem_cache_zalloc(g_uvm_leak_checker.info_cache, NV_UVM_GFP_FLAGS);
+        site = site_get(file, line, function);
+        info = site ? nv_kmem_cache_zalloc(g_uvm_leak_checker.info_cache, NV_UVM_GFP_FLAGS) : NULL;
         if (!info) {
-            atomic_long_inc(&g_uvm_leak_checker.untracked_allocations);
+            if (!leak_checker_is_sampling())
+                atomic_long_inc(&g_uvm_leak_checker.untracked_allocations);
             return;
         }
 
         info->node.key  = (NvU64)p;
-        info->file      = file;
-        info->function  = function;
-        info->line      = line;
+        info->site      = site;
+        info->size      = size;
+
+        atomic_long_inc(&site->allocations);
+        atomic_long_add(size, &site->bytes);
 
         insert_info(info);
     }
@@ -233,7 +465,7 @@ static void alloc_tracking_remove(void *p)
     if (uvm_leak_checker >= UVM_KVMALLOC_LEAK_CHECK_ORIGIN) {
         info = remove_info(p);
         if (info)
-            kmem_cache_free(g_uvm_leak_checker.info_cache, info);
+            free_info(info);
     }
 }
 
@@ -394,7 +626,7 @@ void *__uvm_kvrealloc(void *p, size_t new_size, const char *file, int line, cons
         else if (new_size != 0) {
             // Drop the old info and insert the new
             if (info)
-                kmem_cache_free(g_uvm_leak_checker.info_cache, info);
+                free_info(info);
             alloc_tracking_add(new_p, file, line, function);
         }
     }
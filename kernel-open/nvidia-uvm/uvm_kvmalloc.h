@@ -46,6 +46,10 @@
 NV_STATUS uvm_kvmalloc_init(void);
 void uvm_kvmalloc_exit(void);
 
+// Create the procfs file reporting the outstanding allocations per call site
+// when uvm_leak_checker=2. Must be called after uvm_procfs_init().
+NV_STATUS uvm_kvmalloc_procfs_init(void);
+
 // Allocating a size of 0 with any of these APIs returns ZERO_SIZE_PTR
 void *__uvm_kvmalloc(size_t size, const char *file, int line, const char *function);
 void *__uvm_kvmalloc_zero(size_t size, const char *file, int line, const char *function);
@@ -24,13 +24,14 @@
 #include "uvm_lock.h"
 #include "uvm_thread_context.h"
 #include "uvm_kvmalloc.h"
+#include "uvm_procfs.h"
 
 const char *uvm_lock_order_to_string(uvm_lock_order_t lock_order)
 {
 
 
 
-    BUILD_BUG_ON(UVM_LOCK_ORDER_COUNT != 26);
+    BUILD_BUG_ON(UVM_LOCK_ORDER_COUNT != 27);
 
 
     switch (lock_order) {
@@ -43,6 +44,7 @@ const char *uvm_lock_order_to_string(uvm_lock_order_t lock_order)
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE_SERIALIZE_WRITERS);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE_READ_ACQUIRE_WRITE_RELEASE_LOCK);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE);
+        UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE_RANGE);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_EXT_RANGE_TREE);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_GPU_SEMAPHORE_POOL);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_RM_API);
@@ -378,3 +380,126 @@ void uvm_bit_locks_deinit(uvm_bit_locks_t *bit_locks)
     kfree(bit_locks->bits);
     memset(bit_locks, 0, sizeof(*bit_locks));
 }
+
+void uvm_range_lock_init(uvm_range_lock_t *range_lock, uvm_lock_order_t lock_order)
+{
+    spin_lock_init(&range_lock->lock);
+    INIT_LIST_HEAD(&range_lock->held_entries);
+    init_waitqueue_head(&range_lock->wait_queue);
+
+#if UVM_IS_DEBUG()
+    uvm_locking_assert_initialized();
+    range_lock->lock_order = lock_order;
+#endif
+}
+
+void uvm_range_lock_deinit(uvm_range_lock_t *range_lock)
+{
+    UVM_ASSERT(list_empty(&range_lock->held_entries));
+}
+
+bool __uvm_range_lock_try_acquire(uvm_range_lock_t *range_lock,
+                                  uvm_range_lock_entry_t *entry,
+                                  NvU64 start,
+                                  NvU64 end,
+                                  uvm_lock_flags_t mode)
+{
+    uvm_range_lock_entry_t *held;
+    bool locked = true;
+
+    UVM_ASSERT(start <= end);
+    UVM_ASSERT(mode == UVM_LOCK_FLAGS_MODE_SHARED || mode == UVM_LOCK_FLAGS_MODE_EXCLUSIVE);
+
+    spin_lock(&range_lock->lock);
+
+    list_for_each_entry(held, &range_lock->held_entries, list_node) {
+        if (!uvm_ranges_overlap(start, end, held->start, held->end))
+            continue;
+
+        if (mode == UVM_LOCK_FLAGS_MODE_EXCLUSIVE || held->mode == UVM_LOCK_FLAGS_MODE_EXCLUSIVE) {
+            locked = false;
+            break;
+        }
+    }
+
+    if (locked) {
+        entry->start = start;
+        entry->end = end;
+        entry->mode = mode;
+        list_add_tail(&entry->list_node, &range_lock->held_entries);
+    }
+
+    spin_unlock(&range_lock->lock);
+
+    return locked;
+}
+
+void __uvm_range_lock_acquire(uvm_range_lock_t *range_lock,
+                              uvm_range_lock_entry_t *entry,
+                              NvU64 start,
+                              NvU64 end,
+                              uvm_lock_flags_t mode)
+{
+    wait_event(range_lock->wait_queue, __uvm_range_lock_try_acquire(range_lock, entry, start, end, mode));
+}
+
+void __uvm_range_lock_release(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry)
+{
+    spin_lock(&range_lock->lock);
+    list_del(&entry->list_node);
+    spin_unlock(&range_lock->lock);
+
+    wake_up_all(&range_lock->wait_queue);
+}
+
+void uvm_lock_time_histogram_add(uvm_lock_time_histogram_t *histogram, NvU64 elapsed_ns)
+{
+    NvU64 elapsed_us = elapsed_ns / 1000;
+    NvU64 max_ns = atomic64_read(&histogram->max_ns);
+    NvU32 bucket = 0;
+
+    if (elapsed_us > 0)
+        bucket = min((NvU32)ilog2(elapsed_us) + 1, (NvU32)UVM_LOCK_TIME_HISTOGRAM_BUCKETS - 1);
+
+    atomic64_inc(&histogram->count[bucket]);
+    atomic64_add(elapsed_ns, &histogram->total_ns);
+
+    while (elapsed_ns > max_ns) {
+        NvU64 old_max_ns = atomic64_cmpxchg(&histogram->max_ns, max_ns, elapsed_ns);
+        if (old_max_ns == max_ns)
+            break;
+
+        max_ns = old_max_ns;
+    }
+}
+
+void uvm_lock_time_histogram_print(uvm_lock_time_histogram_t *histogram, const char *name, struct seq_file *s)
+{
+    NvU64 total_count = 0;
+    NvU32 i;
+
+    for (i = 0; i < UVM_LOCK_TIME_HISTOGRAM_BUCKETS; ++i)
+        total_count += atomic64_read(&histogram->count[i]);
+
+    UVM_SEQ_OR_DBG_PRINT(s, "%s:\n", name);
+    UVM_SEQ_OR_DBG_PRINT(s, "  count                %llu\n", total_count);
+    UVM_SEQ_OR_DBG_PRINT(s, "  total_ns             %llu\n", (NvU64)atomic64_read(&histogram->total_ns));
+    UVM_SEQ_OR_DBG_PRINT(s, "  max_ns               %llu\n", (NvU64)atomic64_read(&histogram->max_ns));
+
+    for (i = 0; i < UVM_LOCK_TIME_HISTOGRAM_BUCKETS; ++i) {
+        NvU64 count = atomic64_read(&histogram->count[i]);
+        char bucket_name[32];
+
+        if (count == 0)
+            continue;
+
+        if (i == 0)
+            snprintf(bucket_name, sizeof(bucket_name), "<1us");
+        else if (i == UVM_LOCK_TIME_HISTOGRAM_BUCKETS - 1)
+            snprintf(bucket_name, sizeof(bucket_name), ">=%uus", 1u << (i - 1));
+        else
+            snprintf(bucket_name, sizeof(bucket_name), "%u-%uus", 1u << (i - 1), (1u << i) - 1);
+
+        UVM_SEQ_OR_DBG_PRINT(s, "  %-20s %llu\n", bucket_name, count);
+    }
+}
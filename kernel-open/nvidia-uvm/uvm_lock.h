@@ -231,6 +231,25 @@
 //      Write mode: Modification of the range state such as mmap and changes to
 //      logical permissions or location preferences. RM calls are never allowed.
 //
+// - VA space range lock (va_space->range_lock)
+//      Order: UVM_LOCK_ORDER_VA_SPACE_RANGE
+//      Reader/writer lock over VA intervals (uvm_range_lock_t) per uvm_va_space
+//
+//      Lets threads holding the VA space lock in read mode exclude each other
+//      only on the VA intervals they operate on, instead of on the whole VA
+//      space.
+//
+//      Exclusive mode: Taken with the VA space lock held in write mode, which
+//      guarantees that no shared holder is present, after the operation has
+//      hidden the interval from the VA range tree. The VA space lock can then
+//      be downgraded to read mode for the rest of the operation, so faults on
+//      other intervals are serviced concurrently. Used by uvm_free() to tear
+//      down the mappings of an external VA range.
+//
+//      Shared mode: Taken by paths which create state for VA not covered by
+//      any VA range, such as HMM va_block creation, so they can't populate an
+//      interval that is still being torn down.
+//
 // - External Allocation Tree lock
 //      Order: UVM_LOCK_ORDER_EXT_RANGE_TREE
 //      Exclusive lock (mutex) per external VA range, per GPU.
@@ -403,6 +422,7 @@ typedef enum
     UVM_LOCK_ORDER_VA_SPACE_SERIALIZE_WRITERS,
     UVM_LOCK_ORDER_VA_SPACE_READ_ACQUIRE_WRITE_RELEASE_LOCK,
     UVM_LOCK_ORDER_VA_SPACE,
+    UVM_LOCK_ORDER_VA_SPACE_RANGE,
     UVM_LOCK_ORDER_EXT_RANGE_TREE,
     UVM_LOCK_ORDER_GPU_SEMAPHORE_POOL,
     UVM_LOCK_ORDER_RM_API,
@@ -1166,4 +1186,108 @@ static void __uvm_bit_unlock(uvm_bit_locks_t *bit_locks, unsigned long bit)
     uvm_record_unlock(_bit_locks, UVM_LOCK_FLAGS_MODE_EXCLUSIVE); \
 })
 
+// Range locks are reader/writer locks over intervals of a 64-bit space. Holders
+// of non-overlapping intervals never wait for each other and neither do shared
+// holders of overlapping intervals, but an exclusive holder excludes all other
+// holders overlapping its interval.
+//
+// Each holder provides a uvm_range_lock_entry_t, which stays linked in the lock
+// until released. Waiters sleep on a wait queue and are woken up whenever an
+// entry is released. Acquisitions are not fair: a waiter doesn't prevent new
+// holders of intervals that don't conflict with the current ones. The number
+// of entries held at once is expected to be small.
+typedef struct
+{
+    NvU64 start;
+    NvU64 end;
+
+    // UVM_LOCK_FLAGS_MODE_SHARED or UVM_LOCK_FLAGS_MODE_EXCLUSIVE
+    uvm_lock_flags_t mode;
+
+    struct list_head list_node;
+} uvm_range_lock_entry_t;
+
+typedef struct
+{
+    // Protects the list of held entries
+    spinlock_t lock;
+
+    struct list_head held_entries;
+
+    wait_queue_head_t wait_queue;
+
+#if UVM_IS_DEBUG()
+    uvm_lock_order_t lock_order;
+#endif
+} uvm_range_lock_t;
+
+void uvm_range_lock_init(uvm_range_lock_t *range_lock, uvm_lock_order_t lock_order);
+
+// All the entries must have been released
+void uvm_range_lock_deinit(uvm_range_lock_t *range_lock);
+
+bool __uvm_range_lock_try_acquire(uvm_range_lock_t *range_lock,
+                                  uvm_range_lock_entry_t *entry,
+                                  NvU64 start,
+                                  NvU64 end,
+                                  uvm_lock_flags_t mode);
+void __uvm_range_lock_acquire(uvm_range_lock_t *range_lock,
+                              uvm_range_lock_entry_t *entry,
+                              NvU64 start,
+                              NvU64 end,
+                              uvm_lock_flags_t mode);
+void __uvm_range_lock_release(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry);
+
+// Lock the [start, end] interval in the given mode, waiting for any conflicting
+// holders to release it.
+#define uvm_range_lock_acquire(range_lock, entry, start, end, mode) ({        \
+    typeof(range_lock) _range_lock = (range_lock);                            \
+    uvm_lock_flags_t _mode = (mode);                                          \
+    uvm_record_lock(_range_lock, _mode);                                      \
+    __uvm_range_lock_acquire(_range_lock, (entry), (start), (end), _mode);    \
+})
+
+// Lock the [start, end] interval in the given mode if it doesn't conflict with
+// any current holder. Returns whether the interval was locked.
+#define uvm_range_lock_try_acquire(range_lock, entry, start, end, mode) ({              \
+    typeof(range_lock) _range_lock = (range_lock);                                      \
+    uvm_lock_flags_t _mode = (mode);                                                    \
+    bool _locked;                                                                       \
+    uvm_record_lock(_range_lock, _mode | UVM_LOCK_FLAGS_TRYLOCK);                       \
+    _locked = __uvm_range_lock_try_acquire(_range_lock, (entry), (start), (end), _mode); \
+    if (!_locked)                                                                       \
+        uvm_record_unlock(_range_lock, _mode);                                          \
+    _locked;                                                                            \
+})
+
+#define uvm_range_lock_release(range_lock, entry) ({ \
+    typeof(range_lock) _range_lock = (range_lock);   \
+    typeof(entry) _entry = (entry);                  \
+    uvm_lock_flags_t _mode = _entry->mode;           \
+    __uvm_range_lock_release(_range_lock, _entry);   \
+    uvm_record_unlock(_range_lock, _mode);           \
+})
+
+// Histogram of the time spent waiting for or holding a lock. Bucket 0 counts
+// durations under 1us and bucket i > 0 counts durations in [2^(i-1), 2^i) us.
+// The last bucket also counts all the longer durations.
+#define UVM_LOCK_TIME_HISTOGRAM_BUCKETS 20
+
+typedef struct
+{
+    atomic64_t count[UVM_LOCK_TIME_HISTOGRAM_BUCKETS];
+
+    atomic64_t total_ns;
+
+    atomic64_t max_ns;
+} uvm_lock_time_histogram_t;
+
+// Add a duration to the histogram. Can be called concurrently from multiple
+// threads without any locking.
+void uvm_lock_time_histogram_add(uvm_lock_time_histogram_t *histogram, NvU64 elapsed_ns);
+
+// Print the histogram into a seq_file if provided or with UVM_DBG_PRINT() if
+// not. Empty buckets are skipped.
+void uvm_lock_time_histogram_print(uvm_lock_time_histogram_t *histogram, const char *name, struct seq_file *s);
+
 #endif // __UVM_LOCK_H__
@@ -410,6 +410,47 @@ static NV_STATUS test_try_locking_out_of_order(void)
     return NV_OK;
 }
 
+static NV_STATUS test_range_lock(void)
+{
+    uvm_range_lock_t range_lock;
+    uvm_range_lock_entry_t entries[3];
+
+    // The lock tracking doesn't support holding several entries of the same
+    // range lock, so use the untracked functions.
+    uvm_range_lock_init(&range_lock, UVM_LOCK_ORDER_VA_SPACE_RANGE);
+
+    // Overlapping shared intervals don't conflict
+    TEST_CHECK_RET(__uvm_range_lock_try_acquire(&range_lock, &entries[0], 0, 9, UVM_LOCK_FLAGS_MODE_SHARED));
+    TEST_CHECK_RET(__uvm_range_lock_try_acquire(&range_lock, &entries[1], 5, 14, UVM_LOCK_FLAGS_MODE_SHARED));
+
+    // Exclusive intervals conflict with any overlapping holder, including
+    // single-element overlaps at the interval boundaries
+    TEST_CHECK_RET(!__uvm_range_lock_try_acquire(&range_lock, &entries[2], 8, 8, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(!__uvm_range_lock_try_acquire(&range_lock, &entries[2], 14, 20, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    // Disjoint intervals don't conflict
+    TEST_CHECK_RET(__uvm_range_lock_try_acquire(&range_lock, &entries[2], 15, 29, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    __uvm_range_lock_release(&range_lock, &entries[2]);
+
+    // Shared intervals conflict with overlapping exclusive holders
+    __uvm_range_lock_release(&range_lock, &entries[1]);
+    TEST_CHECK_RET(__uvm_range_lock_try_acquire(&range_lock, &entries[1], 10, 19, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(!__uvm_range_lock_try_acquire(&range_lock, &entries[2], 19, 19, UVM_LOCK_FLAGS_MODE_SHARED));
+    TEST_CHECK_RET(!__uvm_range_lock_try_acquire(&range_lock, &entries[2], 5, 10, UVM_LOCK_FLAGS_MODE_SHARED));
+    TEST_CHECK_RET(__uvm_range_lock_try_acquire(&range_lock, &entries[2], 5, 9, UVM_LOCK_FLAGS_MODE_SHARED));
+    __uvm_range_lock_release(&range_lock, &entries[2]);
+
+    // Releasing the entries makes the whole space available again
+    __uvm_range_lock_release(&range_lock, &entries[0]);
+    __uvm_range_lock_release(&range_lock, &entries[1]);
+    TEST_CHECK_RET(__uvm_range_lock_try_acquire(&range_lock, &entries[0], 0, ~0ULL, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    __uvm_range_lock_release(&range_lock, &entries[0]);
+
+    uvm_range_lock_deinit(&range_lock);
+
+    return NV_OK;
+}
+
 static NV_STATUS run_all_lock_tests(void)
 {
     // The test needs all locks to be released initially
@@ -435,6 +476,7 @@ static NV_STATUS run_all_lock_tests(void)
     TEST_CHECK_RET(test_downgrading_when_different_instance_held() == NV_OK);
     TEST_CHECK_RET(test_downgrading_when_locked_as_shared() == NV_OK);
     TEST_CHECK_RET(test_try_locking_out_of_order() == NV_OK);
+    TEST_CHECK_RET(test_range_lock() == NV_OK);
 
     return NV_OK;
 }
@@ -1365,10 +1365,37 @@ static NV_STATUS uvm_free(uvm_va_space_t *va_space, NvU64 base, NvU64 length)
     }
 
     if (va_range->type == UVM_VA_RANGE_TYPE_EXTERNAL) {
+        uvm_range_lock_entry_t range_lock_entry;
+
         // External ranges may have deferred free work, so the GPUs may have to
         // be retained. Construct the mask of all the GPUs that need to be
         // retained.
         uvm_va_space_global_gpus_in_mask(va_space, &retained_mask, &va_range->external.mapped_gpus);
+
+        // Clearing the PTEs of all the external mappings can take a long time,
+        // so do it with the VA space lock held in read mode to let faults on
+        // the rest of the VA space be serviced meanwhile. Once unlinked, the
+        // VA range can't be found by other threads and the interval lock keeps
+        // paths which don't need a VA range, like HMM, out of the interval
+        // until the teardown completes. No shared holder can be present while
+        // the VA space lock is held in write mode, so this doesn't wait.
+        uvm_va_range_unlink(va_range);
+        uvm_range_lock_acquire(&va_space->range_lock,
+                               &range_lock_entry,
+                               base,
+                               base + length - 1,
+                               UVM_LOCK_FLAGS_MODE_EXCLUSIVE);
+        uvm_va_space_downgrade_write(va_space);
+
+        uvm_va_range_destroy(va_range, &deferred_free_list);
+
+        if (!list_empty(&deferred_free_list))
+            uvm_global_mask_retain(&retained_mask);
+
+        uvm_range_lock_release(&va_space->range_lock, &range_lock_entry);
+        uvm_va_space_up_read(va_space);
+
+        goto free;
     }
 
     uvm_va_range_destroy(va_range, &deferred_free_list);
@@ -1380,6 +1407,7 @@ static NV_STATUS uvm_free(uvm_va_space_t *va_space, NvU64 base, NvU64 length)
 out:
     uvm_va_space_up_write(va_space);
 
+free:
     if (!list_empty(&deferred_free_list)) {
         UVM_ASSERT(status == NV_OK);
         uvm_deferred_free_object_list(&deferred_free_list);
@@ -39,6 +39,7 @@
 #include "uvm_migrate.h"
 #include "uvm_migrate_pageable.h"
 #include "uvm_va_space_mm.h"
+#include "uvm_procfs.h"
 #include "nv_speculation_barrier.h"
 
 typedef enum
@@ -59,6 +60,71 @@ module_param(uvm_perf_migrate_cpu_preunmap_block_order, uint, S_IRUGO);
 static bool g_uvm_perf_migrate_cpu_preunmap_enable __read_mostly;
 static NvU64 g_uvm_perf_migrate_cpu_preunmap_size __read_mostly;
 
+// Managed memory migration statistics, reported in procfs. Pushing the work
+// for a VA block doesn't wait for it, so the copies of a block overlap with
+// the locking, allocation and push submission of the following blocks. The
+// submit time of a pass is the time spent in that pipeline, and the wait time
+// is the time spent waiting for the remaining work of synchronous migrations
+// once everything has been pushed.
+static struct
+{
+    atomic64_t migrations;
+
+    // Number of VA block sized regions migrated in each pass
+    atomic64_t blocks[2];
+
+    // Bytes requested to be migrated in each pass
+    atomic64_t bytes[2];
+
+    // Time spent submitting the work of each pass
+    atomic64_t submit_ns[2];
+
+    // Bytes and time spent waiting for synchronous migrations to complete
+    atomic64_t wait_bytes;
+    atomic64_t wait_ns;
+
+    struct proc_dir_entry *procfs_file;
+} g_uvm_migrate_stats;
+
+static int nv_procfs_read_migrate_stats(struct seq_file *s, void *v)
+{
+    uvm_migrate_pass_t pass;
+    NvU64 wait_bytes = atomic64_read(&g_uvm_migrate_stats.wait_bytes);
+    NvU64 wait_ns = atomic64_read(&g_uvm_migrate_stats.wait_ns);
+
+    if (!uvm_down_read_trylock(&g_uvm_global.pm.lock))
+            return -EAGAIN;
+
+    UVM_SEQ_OR_DBG_PRINT(s, "migrations              %llu\n", (NvU64)atomic64_read(&g_uvm_migrate_stats.migrations));
+
+    for (pass = UVM_MIGRATE_PASS_FIRST; pass <= UVM_MIGRATE_PASS_SECOND; pass++) {
+        NvU64 bytes = atomic64_read(&g_uvm_migrate_stats.bytes[pass]);
+        NvU64 submit_ns = atomic64_read(&g_uvm_migrate_stats.submit_ns[pass]);
+
+        UVM_SEQ_OR_DBG_PRINT(s, "pass %u:\n", pass + 1);
+        UVM_SEQ_OR_DBG_PRINT(s, "  blocks                %llu\n", (NvU64)atomic64_read(&g_uvm_migrate_stats.blocks[pass]));
+        UVM_SEQ_OR_DBG_PRINT(s, "  bytes                 %llu\n", bytes);
+        UVM_SEQ_OR_DBG_PRINT(s, "  submit_ns             %llu\n", submit_ns);
+        UVM_SEQ_OR_DBG_PRINT(s, "  submit_MBps           %llu\n", submit_ns ? bytes * 1000 / submit_ns : 0);
+    }
+
+    UVM_SEQ_OR_DBG_PRINT(s, "wait:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  bytes                 %llu\n", wait_bytes);
+    UVM_SEQ_OR_DBG_PRINT(s, "  wait_ns               %llu\n", wait_ns);
+    UVM_SEQ_OR_DBG_PRINT(s, "  wait_MBps             %llu\n", wait_ns ? wait_bytes * 1000 / wait_ns : 0);
+
+    uvm_up_read(&g_uvm_global.pm.lock);
+
+    return 0;
+}
+
+static int nv_procfs_read_migrate_stats_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_migrate_stats(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(migrate_stats_entry);
+
 static bool is_migration_single_block(uvm_va_range_t *first_va_range, NvU64 base, NvU64 length)
 {
     NvU64 end = base + length - 1;
@@ -349,7 +415,6 @@ static bool va_block_should_do_cpu_preunmap(uvm_va_block_t *va_block,
     mapped_pages_cpu = uvm_va_block_map_mask_get(va_block, UVM_ID_CPU);
     if (uvm_processor_mask_test(&va_block->resident, dest_id)) {
         const uvm_page_mask_t *resident_pages_dest = uvm_va_block_resident_mask_get(va_block, dest_id);
-        uvm_page_mask_t *do_not_unmap_pages = &va_block_context->scratch_page_mask;
 
         // TODO: Bug 1877578
         //
@@ -358,9 +423,9 @@ static bool va_block_should_do_cpu_preunmap(uvm_va_block_t *va_block,
         // unmapped. If we implement automatic read-duplication heuristics in
         // the future, we'll also need to check if the pages are being
         // read-duplicated.
-        uvm_page_mask_and(do_not_unmap_pages, mapped_pages_cpu, resident_pages_dest);
-
-        num_cpu_unchanged_pages = uvm_page_mask_region_weight(do_not_unmap_pages, region);
+        num_cpu_unchanged_pages = uvm_page_mask_intersection_region_weight(mapped_pages_cpu,
+                                                                           resident_pages_dest,
+                                                                           region);
     }
 
     *num_unmap_pages = uvm_page_mask_region_weight(mapped_pages_cpu, region) - num_cpu_unchanged_pages;
@@ -584,6 +649,34 @@ static NV_STATUS uvm_migrate_ranges(uvm_va_space_t *va_space,
     return NV_OK;
 }
 
+// Account a pass that completed successfully, both in procfs and as a tools
+// event. Failed passes are not accounted since they may have stopped at any
+// point of the range.
+static void migrate_stats_add_pass(uvm_va_space_t *va_space,
+                                   uvm_migrate_pass_t pass,
+                                   uvm_processor_id_t dest_id,
+                                   NvU64 base,
+                                   NvU64 length,
+                                   NvU64 start_time)
+{
+    NvU64 end_time = NV_GETTIME();
+    NvU64 blocks = (UVM_ALIGN_UP(base + length, UVM_VA_BLOCK_SIZE) - UVM_ALIGN_DOWN(base, UVM_VA_BLOCK_SIZE)) /
+                   UVM_VA_BLOCK_SIZE;
+
+    atomic64_add(blocks, &g_uvm_migrate_stats.blocks[pass]);
+    atomic64_add(length, &g_uvm_migrate_stats.bytes[pass]);
+    atomic64_add(end_time - start_time, &g_uvm_migrate_stats.submit_ns[pass]);
+
+    uvm_tools_record_migration_stage(va_space,
+                                     pass == UVM_MIGRATE_PASS_FIRST ? UvmEventMigrationStageFirstPass :
+                                                                      UvmEventMigrationStageSecondPass,
+                                     dest_id,
+                                     base,
+                                     length,
+                                     start_time,
+                                     end_time);
+}
+
 static NV_STATUS uvm_migrate(uvm_va_space_t *va_space,
                              struct mm_struct *mm,
                              NvU64 base,
@@ -599,6 +692,7 @@ static NV_STATUS uvm_migrate(uvm_va_space_t *va_space,
     bool do_two_passes;
     bool is_single_block;
     bool should_do_cpu_preunmap;
+    NvU64 start_time;
 
     uvm_assert_rwsem_locked(&va_space->lock);
 
@@ -638,9 +732,12 @@ static NV_STATUS uvm_migrate(uvm_va_space_t *va_space,
     do_mappings = UVM_ID_IS_GPU(dest_id) || !(migrate_flags & UVM_MIGRATE_FLAG_SKIP_CPU_MAP);
     do_two_passes = do_mappings && !is_single_block;
 
+    atomic64_inc(&g_uvm_migrate_stats.migrations);
+
     if (do_two_passes) {
         should_do_cpu_preunmap = migration_should_do_cpu_preunmap(va_space, UVM_MIGRATE_PASS_FIRST, is_single_block);
 
+        start_time = NV_GETTIME();
         status = uvm_migrate_ranges(va_space,
                                     va_block_context,
                                     first_va_range,
@@ -650,6 +747,8 @@ static NV_STATUS uvm_migrate(uvm_va_space_t *va_space,
                                     UVM_MIGRATE_MODE_MAKE_RESIDENT,
                                     should_do_cpu_preunmap,
                                     out_tracker);
+        if (status == NV_OK)
+            migrate_stats_add_pass(va_space, UVM_MIGRATE_PASS_FIRST, dest_id, base, length, start_time);
     }
 
     if (status == NV_OK) {
@@ -659,6 +758,7 @@ static NV_STATUS uvm_migrate(uvm_va_space_t *va_space,
                                                  UVM_MIGRATE_PASS_FIRST;
         should_do_cpu_preunmap = migration_should_do_cpu_preunmap(va_space, pass, is_single_block);
 
+        start_time = NV_GETTIME();
         status = uvm_migrate_ranges(va_space,
                                     va_block_context,
                                     first_va_range,
@@ -668,6 +768,8 @@ static NV_STATUS uvm_migrate(uvm_va_space_t *va_space,
                                     mode,
                                     should_do_cpu_preunmap,
                                     out_tracker);
+        if (status == NV_OK)
+            migrate_stats_add_pass(va_space, pass, dest_id, base, length, start_time);
     }
 
     uvm_va_block_context_free(va_block_context);
@@ -797,6 +899,17 @@ NV_STATUS uvm_migrate_init()
     if (status != NV_OK)
         return status;
 
+    if (uvm_procfs_is_debug_enabled()) {
+        g_uvm_migrate_stats.procfs_file = NV_CREATE_PROC_FILE("migrate_stats",
+                                                              uvm_procfs_get_cpu_base_dir(),
+                                                              migrate_stats_entry,
+                                                              NULL);
+        if (!g_uvm_migrate_stats.procfs_file) {
+            uvm_migrate_pageable_exit();
+            return NV_ERR_OPERATING_SYSTEM;
+        }
+    }
+
     g_uvm_perf_migrate_cpu_preunmap_enable = uvm_perf_migrate_cpu_preunmap_enable != 0;
 
     BUILD_BUG_ON((UVM_VA_BLOCK_SIZE) & (UVM_VA_BLOCK_SIZE - 1));
@@ -819,6 +932,9 @@ NV_STATUS uvm_migrate_init()
 
 void uvm_migrate_exit()
 {
+    uvm_procfs_destroy_entry(g_uvm_migrate_stats.procfs_file);
+    g_uvm_migrate_stats.procfs_file = NULL;
+
     uvm_migrate_pageable_exit();
 }
 
@@ -960,8 +1076,24 @@ done:
         // Wait on the tracker if we are synchronous or there was an error. The
         // VA space lock must be held to prevent GPUs from being unregistered.
         if (synchronous || (status != NV_OK)) {
+            NvU64 start_time = NV_GETTIME();
             NV_STATUS tracker_status = uvm_tracker_wait(tracker_ptr);
 
+            if (synchronous && status == NV_OK && tracker_status == NV_OK && params->length > 0) {
+                NvU64 end_time = NV_GETTIME();
+
+                atomic64_add(params->length, &g_uvm_migrate_stats.wait_bytes);
+                atomic64_add(end_time - start_time, &g_uvm_migrate_stats.wait_ns);
+
+                uvm_tools_record_migration_stage(va_space,
+                                                 UvmEventMigrationStageWait,
+                                                 dest_gpu ? dest_gpu->id : UVM_ID_CPU,
+                                                 params->base,
+                                                 params->length,
+                                                 start_time,
+                                                 end_time);
+            }
+
             // Only clobber status if we didn't hit an earlier error
             if (status == NV_OK)
                 status = tracker_status;
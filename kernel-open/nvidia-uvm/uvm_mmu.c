@@ -1135,9 +1135,12 @@ NV_STATUS uvm_page_tree_get_ptes_async(uvm_page_tree_t *tree,
 {
     NV_STATUS status;
     NvU32 cur_depth = 0;
+    NvU32 page_table_depth = tree->hal->page_table_depth(page_size);
     uvm_page_directory_t *dir_cache[MAX_OPERATION_DEPTH];
     memset(dir_cache, 0, sizeof(dir_cache));
 
+    UVM_ASSERT(page_table_depth <= MAX_OPERATION_DEPTH);
+
     uvm_mutex_lock(&tree->lock);
     while ((status = try_get_ptes(tree,
                                   page_size,
@@ -1146,17 +1149,29 @@ NV_STATUS uvm_page_tree_get_ptes_async(uvm_page_tree_t *tree,
                                   range,
                                   &cur_depth,
                                   dir_cache)) == NV_ERR_MORE_PROCESSING_REQUIRED) {
+        NvU32 depth;
+
         uvm_mutex_unlock(&tree->lock);
 
-        // try_get_ptes never needs depth 0, so store a directory at its parent's depth
-        // TODO: Bug 1766655: Allocate everything below cur_depth instead of
-        //       retrying for every level.
-        dir_cache[cur_depth] = allocate_directory(tree, page_size, cur_depth + 1, pmm_flags);
-        if (dir_cache[cur_depth] == NULL) {
-            uvm_mutex_lock(&tree->lock);
-            free_unused_directories(tree, 0, NULL, dir_cache);
-            uvm_mutex_unlock(&tree->lock);
-            return NV_ERR_NO_MEMORY;
+        // The directory at cur_depth + 1 is missing, so all the directories
+        // below it are missing, too. Allocate the whole chain at once, so
+        // try_get_ptes only needs to be retried if another thread changed the
+        // tree in the meantime. Directories that end up not being used are
+        // freed by try_get_ptes.
+        //
+        // try_get_ptes never needs depth 0, so store a directory at its
+        // parent's depth.
+        for (depth = cur_depth; depth < page_table_depth; depth++) {
+            if (dir_cache[depth] != NULL)
+                continue;
+
+            dir_cache[depth] = allocate_directory(tree, page_size, depth + 1, pmm_flags);
+            if (dir_cache[depth] == NULL) {
+                uvm_mutex_lock(&tree->lock);
+                free_unused_directories(tree, 0, NULL, dir_cache);
+                uvm_mutex_unlock(&tree->lock);
+                return NV_ERR_NO_MEMORY;
+            }
         }
 
         uvm_mutex_lock(&tree->lock);
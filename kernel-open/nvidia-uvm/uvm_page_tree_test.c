@@ -848,6 +848,72 @@ static NV_STATUS get_two_free_apart(uvm_gpu_t *gpu)
     return NV_OK;
 }
 
+#define NUM_FRESH_REGIONS 64
+
+// Get PTEs in regions 512MB apart, so that every call needs to allocate a chain
+// of missing directories down to the page table.
+static NV_STATUS get_ptes_fresh_regions(uvm_gpu_t *gpu, bool verbose)
+{
+    NV_STATUS status;
+    uvm_page_tree_t tree;
+    uvm_page_table_range_t *ranges;
+    NvU32 num_ranges;
+    NvU32 page_table_depth;
+    NvU64 start_time;
+    NvU64 elapsed_ns;
+    NvU32 i;
+
+    ranges = uvm_kvmalloc_zero(NUM_FRESH_REGIONS * sizeof(*ranges));
+    if (!ranges)
+        return NV_ERR_NO_MEMORY;
+
+    status = test_page_tree_init(gpu, BIG_PAGE_SIZE_PASCAL, &tree);
+    if (status != NV_OK)
+        goto done_free;
+
+    page_table_depth = tree.hal->page_table_depth(UVM_PAGE_SIZE_4K);
+
+    start_time = NV_GETTIME();
+
+    for (num_ranges = 0; num_ranges < NUM_FRESH_REGIONS; num_ranges++) {
+        status = test_page_tree_get_ptes(&tree,
+                                         UVM_PAGE_SIZE_4K,
+                                         (NvU64)num_ranges * UVM_PAGE_SIZE_512M,
+                                         UVM_PAGE_SIZE_4K,
+                                         &ranges[num_ranges]);
+        if (status != NV_OK)
+            goto done;
+    }
+
+    elapsed_ns = NV_GETTIME() - start_time;
+
+    for (i = 0; i < num_ranges; i++) {
+        TEST_CHECK_GOTO(ranges[i].entry_count == 1, done);
+        TEST_CHECK_GOTO(ranges[i].table->depth == page_table_depth, done);
+        TEST_CHECK_GOTO(ranges[i].table->ref_count == 1, done);
+        if (i > 0)
+            TEST_CHECK_GOTO(ranges[i].table != ranges[i - 1].table, done);
+    }
+
+    if (verbose) {
+        UVM_TEST_PRINT("%u fresh regions in %llu ns, %llu regions/s\n",
+                       num_ranges,
+                       elapsed_ns,
+                       elapsed_ns ? num_ranges * 1000000000ull / elapsed_ns : 0);
+    }
+
+done:
+    for (i = 0; i < num_ranges; i++)
+        uvm_page_tree_put_ptes(&tree, &ranges[i]);
+
+    uvm_page_tree_deinit(&tree);
+
+done_free:
+    uvm_kvfree(ranges);
+
+    return status;
+}
+
 static NV_STATUS get_overlapping_dual_pdes(uvm_gpu_t *gpu)
 {
     uvm_page_tree_t tree;
@@ -2159,7 +2225,7 @@ static NV_STATUS maxwell_test_page_tree(uvm_gpu_t *maxwell)
     return NV_OK;
 }
 
-static NV_STATUS pascal_test_page_tree(uvm_gpu_t *pascal)
+static NV_STATUS pascal_test_page_tree(uvm_gpu_t *pascal, bool verbose)
 {
     // create a fake Pascal GPU for this test.
     NvU32 tlb_batch_saved_max_pages;
@@ -2184,6 +2250,7 @@ static NV_STATUS pascal_test_page_tree(uvm_gpu_t *pascal)
     MEM_NV_CHECK_RET(split_4k_from_2m(pascal), NV_OK);
     MEM_NV_CHECK_RET(get_512mb_range(pascal), NV_OK);
     MEM_NV_CHECK_RET(get_two_free_apart(pascal), NV_OK);
+    MEM_NV_CHECK_RET(get_ptes_fresh_regions(pascal, verbose), NV_OK);
     MEM_NV_CHECK_RET(get_overlapping_dual_pdes(pascal), NV_OK);
     MEM_NV_CHECK_RET(split_and_free(pascal), NV_OK);
     MEM_NV_CHECK_RET(entry_test_pascal(pascal, entry_test_page_size_pascal), NV_OK);
@@ -2312,7 +2379,7 @@ NV_STATUS uvm_test_page_tree(UVM_TEST_PAGE_TREE_PARAMS *params, struct file *fil
     TEST_NV_CHECK_GOTO(fake_tlb_invals_alloc(), done);
 
     TEST_NV_CHECK_GOTO(maxwell_test_page_tree(gpu), done);
-    TEST_NV_CHECK_GOTO(pascal_test_page_tree(gpu), done);
+    TEST_NV_CHECK_GOTO(pascal_test_page_tree(gpu, params->verbose), done);
     TEST_NV_CHECK_GOTO(volta_test_page_tree(gpu), done);
     TEST_NV_CHECK_GOTO(ampere_test_page_tree(gpu), done);
 
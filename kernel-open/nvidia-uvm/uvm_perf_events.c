@@ -25,60 +25,64 @@
 #include "uvm_perf_events.h"
 #include "uvm_va_space.h"
 
-// Entry of the event callback list
-typedef struct
+// Return the index of the given callback in the event callbacks array, or -1
+// if it's not registered. Caller needs to hold (at least) read va_space_events
+// lock.
+static int event_find_callback(uvm_perf_va_space_events_t *va_space_events,
+                               uvm_perf_event_t event_id,
+                               uvm_perf_event_callback_t callback)
 {
-    uvm_perf_event_callback_t callback;
-
-    struct list_head callback_list_node;
-} callback_desc_t;
-
-// Cache for callback descriptor list entries
-static struct kmem_cache *g_callback_desc_cache;
-
-// Check if the callback list already contains an entry for the given callback. Caller needs to hold (at least) read
-// va_space_events lock
-static callback_desc_t *event_list_find_callback(uvm_perf_va_space_events_t *va_space_events,
-                                                 struct list_head *callback_list, uvm_perf_event_callback_t callback)
-{
-    callback_desc_t *callback_desc;
+    NvU32 i;
 
     uvm_assert_rwsem_locked(&va_space_events->lock);
 
-    list_for_each_entry(callback_desc, callback_list, callback_list_node) {
-        if (callback_desc->callback == callback)
-            return callback_desc;
+    for (i = 0; i < va_space_events->num_callbacks[event_id]; ++i) {
+        if (va_space_events->event_callbacks[event_id][i].callback == callback)
+            return i;
     }
 
-    return NULL;
+    return -1;
 }
 
-NV_STATUS uvm_perf_register_event_callback_locked(uvm_perf_va_space_events_t *va_space_events,
-                                                  uvm_perf_event_t event_id,
-                                                  uvm_perf_event_callback_t callback)
+NV_STATUS uvm_perf_register_event_batch_callback_locked(uvm_perf_va_space_events_t *va_space_events,
+                                                        uvm_perf_event_t event_id,
+                                                        uvm_perf_event_callback_t callback,
+                                                        uvm_perf_event_batch_callback_t batch_callback)
 {
-    callback_desc_t *callback_desc;
-    struct list_head *callback_list;
+    uvm_perf_event_callback_desc_t *callback_desc;
+    NvU32 num_callbacks;
 
     UVM_ASSERT(event_id >= 0 && event_id < UVM_PERF_EVENT_COUNT);
     UVM_ASSERT(callback);
 
     uvm_assert_rwsem_locked_write(&va_space_events->lock);
 
-    callback_list = &va_space_events->event_callbacks[event_id];
-
-    UVM_ASSERT(!event_list_find_callback(va_space_events, callback_list, callback));
+    UVM_ASSERT(event_find_callback(va_space_events, event_id, callback) < 0);
 
-    callback_desc = kmem_cache_alloc(g_callback_desc_cache, NV_UVM_GFP_FLAGS);
-    if (!callback_desc)
-        return NV_ERR_NO_MEMORY;
+    num_callbacks = va_space_events->num_callbacks[event_id];
+    if (num_callbacks == UVM_PERF_EVENT_MAX_CALLBACKS)
+        return NV_ERR_INSUFFICIENT_RESOURCES;
 
+    callback_desc = &va_space_events->event_callbacks[event_id][num_callbacks];
     callback_desc->callback = callback;
-    list_add_tail(&callback_desc->callback_list_node, callback_list);
+    callback_desc->batch_callback = batch_callback;
+
+    va_space_events->num_callbacks[event_id] = num_callbacks + 1;
+
+    // Notifiers that observe the bit still take the lock before walking the
+    // callbacks, so there is no ordering requirement with the stores above.
+    set_bit(event_id, &va_space_events->enabled_events);
 
     return NV_OK;
 }
 
+NV_STATUS uvm_perf_register_event_callback_locked(uvm_perf_va_space_events_t *va_space_events,
+                                                  uvm_perf_event_t event_id,
+                                                  uvm_perf_event_callback_t callback)
+{
+    return uvm_perf_register_event_batch_callback_locked(va_space_events, event_id, callback, NULL);
+}
+
 NV_STATUS uvm_perf_register_event_callback(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
                                            uvm_perf_event_callback_t callback)
 {
@@ -94,23 +98,29 @@ NV_STATUS uvm_perf_register_event_callback(uvm_perf_va_space_events_t *va_space_
 void uvm_perf_unregister_event_callback_locked(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
                                                uvm_perf_event_callback_t callback)
 {
-    callback_desc_t *callback_desc;
-    struct list_head *callback_list;
+    uvm_perf_event_callback_desc_t *callbacks;
+    NvU32 num_callbacks;
+    int index;
 
     UVM_ASSERT(event_id >= 0 && event_id < UVM_PERF_EVENT_COUNT);
     UVM_ASSERT(callback);
 
     uvm_assert_rwsem_locked_write(&va_space_events->lock);
 
-    callback_list = &va_space_events->event_callbacks[event_id];
-    callback_desc = event_list_find_callback(va_space_events, callback_list, callback);
-
-    if (!callback_desc)
+    index = event_find_callback(va_space_events, event_id, callback);
+    if (index < 0)
         return;
 
-    list_del(&callback_desc->callback_list_node);
+    // Shift the remaining callbacks to preserve the registration order
+    callbacks = va_space_events->event_callbacks[event_id];
+    num_callbacks = va_space_events->num_callbacks[event_id] - 1;
+    memmove(&callbacks[index], &callbacks[index + 1], (num_callbacks - index) * sizeof(callbacks[0]));
+    memset(&callbacks[num_callbacks], 0, sizeof(callbacks[0]));
+
+    va_space_events->num_callbacks[event_id] = num_callbacks;
 
-    kmem_cache_free(g_callback_desc_cache, callback_desc);
+    if (num_callbacks == 0)
+        clear_bit(event_id, &va_space_events->enabled_events);
 }
 
 void uvm_perf_unregister_event_callback(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
@@ -124,19 +134,54 @@ void uvm_perf_unregister_event_callback(uvm_perf_va_space_events_t *va_space_eve
 void uvm_perf_event_notify(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
                            uvm_perf_event_data_t *event_data)
 {
-    callback_desc_t *callback_desc;
-    struct list_head *callback_list;
+    uvm_perf_event_callback_desc_t *callbacks;
+    NvU32 i;
 
     UVM_ASSERT(event_id >= 0 && event_id < UVM_PERF_EVENT_COUNT);
     UVM_ASSERT(event_data);
 
-    callback_list = &va_space_events->event_callbacks[event_id];
+    if (!uvm_perf_event_has_callbacks(va_space_events, event_id))
+        return;
+
+    callbacks = va_space_events->event_callbacks[event_id];
 
     uvm_down_read(&va_space_events->lock);
 
     // Invoke all registered callbacks for the events
-    list_for_each_entry(callback_desc, callback_list, callback_list_node) {
-        callback_desc->callback(event_id, event_data);
+    for (i = 0; i < va_space_events->num_callbacks[event_id]; ++i)
+        callbacks[i].callback(event_id, event_data);
+
+    uvm_up_read(&va_space_events->lock);
+}
+
+void uvm_perf_event_notify_batch(uvm_perf_va_space_events_t *va_space_events,
+                                 uvm_perf_event_t event_id,
+                                 uvm_perf_event_data_t *event_data,
+                                 NvU32 count)
+{
+    uvm_perf_event_callback_desc_t *callbacks;
+    NvU32 i;
+
+    UVM_ASSERT(event_id >= 0 && event_id < UVM_PERF_EVENT_COUNT);
+    UVM_ASSERT(event_data || count == 0);
+
+    if (count == 0 || !uvm_perf_event_has_callbacks(va_space_events, event_id))
+        return;
+
+    callbacks = va_space_events->event_callbacks[event_id];
+
+    uvm_down_read(&va_space_events->lock);
+
+    for (i = 0; i < va_space_events->num_callbacks[event_id]; ++i) {
+        if (callbacks[i].batch_callback) {
+            callbacks[i].batch_callback(event_id, event_data, count);
+        }
+        else {
+            NvU32 j;
+
+            for (j = 0; j < count; ++j)
+                callbacks[i].callback(event_id, &event_data[j]);
+        }
     }
 
     uvm_up_read(&va_space_events->lock);
@@ -146,26 +191,18 @@ bool uvm_perf_is_event_callback_registered(uvm_perf_va_space_events_t *va_space_
                                            uvm_perf_event_t event_id,
                                            uvm_perf_event_callback_t callback)
 {
-    callback_desc_t *callback_desc;
-    struct list_head *callback_list;
-
-    uvm_assert_rwsem_locked(&va_space_events->lock);
-
-    callback_list = &va_space_events->event_callbacks[event_id];
-    callback_desc = event_list_find_callback(va_space_events, callback_list, callback);
-
-    return callback_desc != NULL;
+    return event_find_callback(va_space_events, event_id, callback) >= 0;
 }
 
 NV_STATUS uvm_perf_init_va_space_events(uvm_va_space_t *va_space, uvm_perf_va_space_events_t *va_space_events)
 {
-    unsigned event_id;
+    BUILD_BUG_ON(UVM_PERF_EVENT_COUNT > sizeof(va_space_events->enabled_events) * 8);
 
     uvm_init_rwsem(&va_space_events->lock, UVM_LOCK_ORDER_VA_SPACE_EVENTS);
 
-    // Initialize event callback lists
-    for (event_id = 0; event_id < UVM_PERF_EVENT_COUNT; ++event_id)
-        INIT_LIST_HEAD(&va_space_events->event_callbacks[event_id]);
+    memset(va_space_events->event_callbacks, 0, sizeof(va_space_events->event_callbacks));
+    memset(va_space_events->num_callbacks, 0, sizeof(va_space_events->num_callbacks));
+    va_space_events->enabled_events = 0;
 
     va_space_events->va_space = va_space;
 
@@ -174,39 +211,23 @@ NV_STATUS uvm_perf_init_va_space_events(uvm_va_space_t *va_space, uvm_perf_va_sp
 
 void uvm_perf_destroy_va_space_events(uvm_perf_va_space_events_t *va_space_events)
 {
-    unsigned event_id;
-
     // If the va_space member was not set, va_space creation failed before initializing its va_space_events member. We
     // are done.
     if (!va_space_events->va_space)
         return;
 
-    // Destroy all event callback lists' entries
-    for (event_id = 0; event_id < UVM_PERF_EVENT_COUNT; ++event_id) {
-        callback_desc_t *callback_desc, *callback_desc_tmp;
-        struct list_head *callback_list;
-
-        callback_list = &va_space_events->event_callbacks[event_id];
-
-        list_for_each_entry_safe(callback_desc, callback_desc_tmp, callback_list, callback_list_node) {
-            list_del(&callback_desc->callback_list_node);
-            kmem_cache_free(g_callback_desc_cache, callback_desc);
-        }
-    }
+    // Drop all the remaining callbacks
+    memset(va_space_events->num_callbacks, 0, sizeof(va_space_events->num_callbacks));
+    va_space_events->enabled_events = 0;
 
     va_space_events->va_space = NULL;
 }
 
 NV_STATUS uvm_perf_events_init(void)
 {
-    g_callback_desc_cache = NV_KMEM_CACHE_CREATE("uvm_perf_callback_list", callback_desc_t);
-    if (!g_callback_desc_cache)
-        return NV_ERR_NO_MEMORY;
-
     return NV_OK;
 }
 
 void uvm_perf_events_exit(void)
 {
-    kmem_cache_destroy_safe(&g_callback_desc_cache);
 }
@@ -44,6 +44,10 @@
 // guarantees under which callbacks are executed depend on the specific event,
 // but the VA space events lock is held in read mode for all of them. The
 // additional locking guarantees are defined in each event definition.
+//
+// Callbacks are stored in a fixed-size array per event, and a mask of the
+// events with at least one registered callback is checked without taking the
+// VA space events lock, so notifying an event nobody listens to is cheap.
 
 // Performance-related events that can be notified
 typedef enum
@@ -208,6 +212,26 @@ typedef union
 //             is declared in the uvm_perf_event_data_t union
 typedef void (*uvm_perf_event_callback_t)(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data);
 
+// Type of the function that can be registered, in addition to a regular
+// callback, to be executed on batched notifications. It receives all the
+// event_data records of the batch at once.
+typedef void (*uvm_perf_event_batch_callback_t)(uvm_perf_event_t event_id,
+                                                uvm_perf_event_data_t *event_data,
+                                                NvU32 count);
+
+// Maximum number of callbacks that can be registered for the same event in a
+// VA space
+#define UVM_PERF_EVENT_MAX_CALLBACKS 8
+
+typedef struct
+{
+    uvm_perf_event_callback_t callback;
+
+    // Optional, if NULL callback is invoked for each record of batched
+    // notifications.
+    uvm_perf_event_batch_callback_t batch_callback;
+} uvm_perf_event_callback_desc_t;
+
 typedef struct
 {
     // Lock protecting the events
@@ -218,8 +242,15 @@ typedef struct
     // Also used by tools to protect their state and registration of perf event callbacks.
     uvm_rw_semaphore_t lock;
 
-    // Array of callbacks for event notification
-    struct list_head event_callbacks[UVM_PERF_EVENT_COUNT];
+    // Callbacks for event notification, in registration order. Only the first
+    // num_callbacks[event_id] entries of each array are valid.
+    uvm_perf_event_callback_desc_t event_callbacks[UVM_PERF_EVENT_COUNT][UVM_PERF_EVENT_MAX_CALLBACKS];
+
+    NvU32 num_callbacks[UVM_PERF_EVENT_COUNT];
+
+    // Mask of the events with at least one registered callback. Updated with
+    // the lock held in write mode, but read without the lock by notifiers.
+    unsigned long enabled_events;
 
     uvm_va_space_t *va_space;
 } uvm_perf_va_space_events_t;
@@ -231,7 +262,8 @@ NV_STATUS uvm_perf_init_va_space_events(uvm_va_space_t *va_space, uvm_perf_va_sp
 void uvm_perf_destroy_va_space_events(uvm_perf_va_space_events_t *va_space_events);
 
 // Register a callback to be executed under the given event. The given callback cannot have been already registered for
-// the same event, although the same callback can be registered for different events.
+// the same event, although the same callback can be registered for different events. Returns
+// NV_ERR_INSUFFICIENT_RESOURCES if UVM_PERF_EVENT_MAX_CALLBACKS callbacks are already registered for the event.
 NV_STATUS uvm_perf_register_event_callback(uvm_perf_va_space_events_t *va_space_events,
                                            uvm_perf_event_t event_id, uvm_perf_event_callback_t callback);
 
@@ -240,6 +272,15 @@ NV_STATUS uvm_perf_register_event_callback(uvm_perf_va_space_events_t *va_space_
 NV_STATUS uvm_perf_register_event_callback_locked(uvm_perf_va_space_events_t *va_space_events,
                                                   uvm_perf_event_t event_id, uvm_perf_event_callback_t callback);
 
+// Same as uvm_perf_register_event_callback_locked(), but batch_callback is
+// invoked instead of callback for batched notifications. The callback is
+// unregistered with uvm_perf_unregister_event_callback(_locked) using the
+// non-batched callback.
+NV_STATUS uvm_perf_register_event_batch_callback_locked(uvm_perf_va_space_events_t *va_space_events,
+                                                        uvm_perf_event_t event_id,
+                                                        uvm_perf_event_callback_t callback,
+                                                        uvm_perf_event_batch_callback_t batch_callback);
+
 // Removes a callback for the given event. It's safe to call with a callback that hasn't been registered.
 void uvm_perf_unregister_event_callback(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
                                         uvm_perf_event_callback_t callback);
@@ -249,11 +290,29 @@ void uvm_perf_unregister_event_callback(uvm_perf_va_space_events_t *va_space_eve
 void uvm_perf_unregister_event_callback_locked(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
                                                uvm_perf_event_callback_t callback);
 
+// Check whether any callback is registered for the given event. This doesn't
+// take the va_space_events lock, so the result can be stale by the time it's
+// returned unless the caller holds the lock.
+static inline bool uvm_perf_event_has_callbacks(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id)
+{
+    return test_bit(event_id, &va_space_events->enabled_events);
+}
+
 // Invoke the callbacks registered for the given event. Callbacks cannot fail.
-// Acquires the va_space_events lock internally
+// Acquires the va_space_events lock internally, unless no callback is
+// registered for the event.
 void uvm_perf_event_notify(uvm_perf_va_space_events_t *va_space_events, uvm_perf_event_t event_id,
                            uvm_perf_event_data_t *event_data);
 
+// Same as uvm_perf_event_notify(), but for count records of the same event.
+// The va_space_events lock is acquired once for the whole batch. Callbacks
+// registered with a batch_callback get all the records in a single call, the
+// rest are invoked once per record.
+void uvm_perf_event_notify_batch(uvm_perf_va_space_events_t *va_space_events,
+                                 uvm_perf_event_t event_id,
+                                 uvm_perf_event_data_t *event_data,
+                                 NvU32 count);
+
 // Checks if the given callback is already registered for the event.
 // va_space_events.lock must be held in either mode by the caller.
 bool uvm_perf_is_event_callback_registered(uvm_perf_va_space_events_t *va_space_events,
@@ -276,7 +335,12 @@ static inline void uvm_perf_event_notify_migration(uvm_perf_va_space_events_t *v
                                                    uvm_make_resident_cause_t cause,
                                                    uvm_make_resident_context_t *make_resident_context)
 {
-    uvm_perf_event_data_t event_data =
+    uvm_perf_event_data_t event_data;
+
+    if (!uvm_perf_event_has_callbacks(va_space_events, UVM_PERF_EVENT_MIGRATION))
+        return;
+
+    event_data = (uvm_perf_event_data_t)
         {
             .migration =
                 {
@@ -295,16 +359,18 @@ static inline void uvm_perf_event_notify_migration(uvm_perf_va_space_events_t *v
     uvm_perf_event_notify(va_space_events, UVM_PERF_EVENT_MIGRATION, &event_data);
 }
 
-// Helper to notify gpu fault events
-static inline void uvm_perf_event_notify_gpu_fault(uvm_perf_va_space_events_t *va_space_events,
-                                                   uvm_va_block_t *va_block,
-                                                   uvm_gpu_id_t gpu_id,
-                                                   uvm_processor_id_t preferred_location,
-                                                   uvm_fault_buffer_entry_t *buffer_entry,
-                                                   NvU32 batch_id,
-                                                   bool is_duplicate)
+// Helper to fill in the record of a gpu fault event, for callers that
+// accumulate them for uvm_perf_event_notify_batch()
+static inline void uvm_perf_event_init_gpu_fault(uvm_perf_event_data_t *event_data,
+                                                 uvm_perf_va_space_events_t *va_space_events,
+                                                 uvm_va_block_t *va_block,
+                                                 uvm_gpu_id_t gpu_id,
+                                                 uvm_processor_id_t preferred_location,
+                                                 uvm_fault_buffer_entry_t *buffer_entry,
+                                                 NvU32 batch_id,
+                                                 bool is_duplicate)
 {
-    uvm_perf_event_data_t event_data =
+    *event_data = (uvm_perf_event_data_t)
         {
             .fault =
                 {
@@ -315,9 +381,33 @@ static inline void uvm_perf_event_notify_gpu_fault(uvm_perf_va_space_events_t *v
                 },
         };
 
-    event_data.fault.gpu.buffer_entry = buffer_entry;
-    event_data.fault.gpu.batch_id     = batch_id;
-    event_data.fault.gpu.is_duplicate = is_duplicate;
+    event_data->fault.gpu.buffer_entry = buffer_entry;
+    event_data->fault.gpu.batch_id     = batch_id;
+    event_data->fault.gpu.is_duplicate = is_duplicate;
+}
+
+// Helper to notify gpu fault events
+static inline void uvm_perf_event_notify_gpu_fault(uvm_perf_va_space_events_t *va_space_events,
+                                                   uvm_va_block_t *va_block,
+                                                   uvm_gpu_id_t gpu_id,
+                                                   uvm_processor_id_t preferred_location,
+                                                   uvm_fault_buffer_entry_t *buffer_entry,
+                                                   NvU32 batch_id,
+                                                   bool is_duplicate)
+{
+    uvm_perf_event_data_t event_data;
+
+    if (!uvm_perf_event_has_callbacks(va_space_events, UVM_PERF_EVENT_FAULT))
+        return;
+
+    uvm_perf_event_init_gpu_fault(&event_data,
+                                  va_space_events,
+                                  va_block,
+                                  gpu_id,
+                                  preferred_location,
+                                  buffer_entry,
+                                  batch_id,
+                                  is_duplicate);
 
     uvm_perf_event_notify(va_space_events, UVM_PERF_EVENT_FAULT, &event_data);
 }
@@ -330,7 +420,12 @@ static inline void uvm_perf_event_notify_cpu_fault(uvm_perf_va_space_events_t *v
                                                    bool is_write,
                                                    NvU64 pc)
 {
-    uvm_perf_event_data_t event_data =
+    uvm_perf_event_data_t event_data;
+
+    if (!uvm_perf_event_has_callbacks(va_space_events, UVM_PERF_EVENT_FAULT))
+        return;
+
+    event_data = (uvm_perf_event_data_t)
         {
             .fault =
                 {
@@ -357,7 +452,12 @@ static inline void uvm_perf_event_notify_revocation(uvm_perf_va_space_events_t *
                                                     uvm_prot_t old_prot,
                                                     uvm_prot_t new_prot)
 {
-    uvm_perf_event_data_t event_data =
+    uvm_perf_event_data_t event_data;
+
+    if (!uvm_perf_event_has_callbacks(va_space_events, UVM_PERF_EVENT_REVOCATION))
+        return;
+
+    event_data = (uvm_perf_event_data_t)
         {
             .revocation =
                 {
@@ -41,6 +41,11 @@ static void callback_inc_2(uvm_perf_event_t event_id, uvm_perf_event_data_t *eve
     test_data += 2;
 }
 
+static void callback_batch_inc_10(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data, NvU32 count)
+{
+    test_data += 10 * count;
+}
+
 static NV_STATUS test_events(uvm_va_space_t *va_space)
 {
     NV_STATUS status;
@@ -82,6 +87,58 @@ done:
     return status;
 }
 
+static NV_STATUS test_batch_events(uvm_va_space_t *va_space)
+{
+    NV_STATUS status;
+    uvm_perf_event_data_t event_data[4];
+    uvm_va_block_t block;
+    NvU32 i;
+
+    test_data = 0;
+
+    memset(event_data, 0, sizeof(event_data));
+    for (i = 0; i < ARRAY_SIZE(event_data); ++i) {
+        // Use CPU id to avoid triggering the GPU stats update code
+        event_data[i].fault.proc_id = UVM_ID_CPU;
+        event_data[i].fault.block = &block;
+    }
+
+    // Register a regular callback and one with a batch variant
+    uvm_down_write(&va_space->perf_events.lock);
+    status = uvm_perf_register_event_callback_locked(&va_space->perf_events, UVM_PERF_EVENT_FAULT, callback_inc_1);
+    if (status == NV_OK) {
+        status = uvm_perf_register_event_batch_callback_locked(&va_space->perf_events,
+                                                               UVM_PERF_EVENT_FAULT,
+                                                               callback_inc_2,
+                                                               callback_batch_inc_10);
+    }
+    uvm_up_write(&va_space->perf_events.lock);
+    TEST_CHECK_GOTO(status == NV_OK, done);
+
+    TEST_CHECK_GOTO(uvm_perf_event_has_callbacks(&va_space->perf_events, UVM_PERF_EVENT_FAULT), done);
+
+    uvm_va_space_down_read(va_space);
+
+    // The regular callback is invoked once per record, the batch callback once
+    // for the whole batch: 4 * 1 + 10 * 4.
+    uvm_perf_event_notify_batch(&va_space->perf_events, UVM_PERF_EVENT_FAULT, event_data, ARRAY_SIZE(event_data));
+    TEST_CHECK_GOTO(test_data == 44, up_read);
+
+    // Single notifications use the regular callbacks only
+    test_data = 0;
+    uvm_perf_event_notify(&va_space->perf_events, UVM_PERF_EVENT_FAULT, &event_data[0]);
+    TEST_CHECK_GOTO(test_data == 3, up_read);
+
+up_read:
+    uvm_va_space_up_read(va_space);
+
+done:
+    uvm_perf_unregister_event_callback(&va_space->perf_events, UVM_PERF_EVENT_FAULT, callback_inc_1);
+    uvm_perf_unregister_event_callback(&va_space->perf_events, UVM_PERF_EVENT_FAULT, callback_inc_2);
+
+    return status;
+}
+
 NV_STATUS uvm_test_perf_events_sanity(UVM_TEST_PERF_EVENTS_SANITY_PARAMS *params, struct file *filp)
 {
     NV_STATUS status;
@@ -93,6 +150,10 @@ NV_STATUS uvm_test_perf_events_sanity(UVM_TEST_PERF_EVENTS_SANITY_PARAMS *params
     if (status != NV_OK)
         goto done;
 
+    status = test_batch_events(va_space);
+    if (status != NV_OK)
+        goto done;
+
 done:
     return status;
 }
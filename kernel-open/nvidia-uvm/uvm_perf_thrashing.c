@@ -84,6 +84,23 @@ typedef struct
     uvm_processor_id_t  do_not_throttle_processor_id;
 } page_thrashing_info_t;
 
+// Descriptor for a page that has been pinned due to thrashing. This structure
+// is only used if the pinning timeout is not 0.
+typedef struct
+{
+    uvm_va_block_t                         *va_block;
+
+    // Page index within va_block
+    uvm_page_index_t                      page_index;
+
+    // Absolute timestamp after which the page will be unpinned
+    NvU64                                   deadline;
+
+    // Entry in the per-VA Space list of pinned pages. See
+    // va_space_thrashing_info_t::pinned_pages::list.
+    struct list_head             va_space_list_entry;
+} pinned_page_t;
+
 // Per-VA block thrashing detection structure. This state is protected by the
 // VA block lock.
 typedef struct
@@ -111,33 +128,14 @@ typedef struct
 
         uvm_page_mask_t                         mask;
 
-        // List of pinned pages. This list is only used if the pinning timeout
-        // is not 0.
-        struct list_head                        list;
+        // Page-indexed array of pinned page descriptors. An entry is non-NULL
+        // iff the page is set in mask and it was pinned with a non-zero
+        // pinning timeout. The array is allocated the first time a page in
+        // the block is pinned with a timeout.
+        pinned_page_t                        **descs;
     } pinned_pages;
 } block_thrashing_info_t;
 
-// Descriptor for a page that has been pinned due to thrashing. This structure
-// is only used if the pinning timeout is not 0.
-typedef struct
-{
-    uvm_va_block_t                         *va_block;
-
-    // Page index within va_block
-    uvm_page_index_t                      page_index;
-
-    // Absolute timestamp after which the page will be unpinned
-    NvU64                                   deadline;
-
-    // Entry in the per-VA Space list of pinned pages. See
-    // va_space_thrashing_info_t::pinned_pages::list.
-    struct list_head             va_space_list_entry;
-
-    // Entry in the per-VA Block list of pinned pages. See
-    // block_thrashing_info_t::pinned_pages::list.
-    struct list_head             va_block_list_entry;
-} pinned_page_t;
-
 // Per-VA space data structures and policy configuration
 typedef struct
 {
@@ -197,6 +195,30 @@ typedef struct
         NvU64                                 pin_ns;
     } params;
 
+    // State of the controller that adapts threshold, lapse_ns and pin_ns to
+    // the observed thrashing behavior. See thrashing_tuning_update.
+    struct
+    {
+        // Time stamp at which the current observation window started
+        atomic64_t                      window_start;
+
+        // Events observed during the current observation window
+        atomic64_t                    num_detections;
+
+        // Pins that were released because the pinning timeout expired
+        atomic64_t                  num_expired_pins;
+
+        //
+        // Parameters computed from the module parameters. The controller
+        // never relaxes the parameters past these values.
+        //
+        unsigned                      base_threshold;
+
+        NvU64                          base_lapse_ns;
+
+        NvU64                            base_pin_ns;
+    } tuning;
+
     uvm_va_space_t                         *va_space;
 } va_space_thrashing_info_t;
 
@@ -302,6 +324,18 @@ static unsigned uvm_perf_thrashing_pin = UVM_PERF_THRASHING_PIN_DEFAULT;
 
 static unsigned uvm_perf_thrashing_max_resets = UVM_PERF_THRASHING_MAX_RESETS_DEFAULT;
 
+#define UVM_PERF_THRASHING_AUTO_TUNE_DEFAULT 0
+
+// Adapt the threshold, lapse and pin parameters of each VA space to the
+// thrashing observed on it. The parameters are re-evaluated once per epoch,
+// and are never relaxed past the values given by the module parameters above.
+static unsigned uvm_perf_thrashing_auto_tune = UVM_PERF_THRASHING_AUTO_TUNE_DEFAULT;
+
+// Upper bounds for the tuned lapse and pin parameters, as multipliers of the
+// values given by the module parameters
+#define UVM_PERF_THRASHING_AUTO_TUNE_LAPSE_SCALE_MAX 4
+#define UVM_PERF_THRASHING_AUTO_TUNE_PIN_SCALE_MAX   16
+
 // Module parameters for the tunables
 module_param(uvm_perf_thrashing_enable,        uint, S_IRUGO);
 module_param(uvm_perf_thrashing_threshold,     uint, S_IRUGO);
@@ -311,6 +345,7 @@ module_param(uvm_perf_thrashing_nap,           uint, S_IRUGO);
 module_param(uvm_perf_thrashing_epoch,         uint, S_IRUGO);
 module_param(uvm_perf_thrashing_pin,           uint, S_IRUGO);
 module_param(uvm_perf_thrashing_max_resets,    uint, S_IRUGO);
+module_param(uvm_perf_thrashing_auto_tune,     uint, S_IRUGO);
 
 // See map_remote_on_atomic_fault uvm_va_block.c
 unsigned uvm_perf_map_remote_on_native_atomics_fault = 0;
@@ -326,6 +361,7 @@ static NvU64 g_uvm_perf_thrashing_nap;
 static NvU64 g_uvm_perf_thrashing_epoch;
 static NvU64 g_uvm_perf_thrashing_pin;
 static unsigned g_uvm_perf_thrashing_max_resets;
+static bool g_uvm_perf_thrashing_auto_tune;
 
 // Helper macros to initialize thrashing parameters from module parameters
 //
@@ -581,6 +617,81 @@ static void va_space_thrashing_info_init_params(va_space_thrashing_info_t *va_sp
     }
 
     va_space_thrashing->params.max_resets    = g_uvm_perf_thrashing_max_resets;
+
+    va_space_thrashing->tuning.base_threshold = va_space_thrashing->params.threshold;
+    va_space_thrashing->tuning.base_lapse_ns  = va_space_thrashing->params.lapse_ns;
+    va_space_thrashing->tuning.base_pin_ns    = va_space_thrashing->params.pin_ns;
+}
+
+static bool thrashing_tuning_enabled(va_space_thrashing_info_t *va_space_thrashing)
+{
+    return g_uvm_perf_thrashing_auto_tune && !va_space_thrashing->params.test_overrides;
+}
+
+// Re-evaluate the thrashing mitigation parameters of the VA space if the
+// current observation window (one epoch) is over. Only one thread evaluates
+// each window.
+//
+// Thrashing that is detected again on pages whose pinning timeout expired
+// means that the mitigation is released too early: the pin time and the lapse
+// are doubled and the threshold is lowered by one, so pages get throttled and
+// pinned sooner and for longer. A window without any thrashing moves the
+// parameters one step back towards their base values, and they are reset to
+// the base values after a longer idle period.
+//
+// VA space lock must be held in read mode. Parameter updates are not
+// synchronized with readers: in-flight thrashing checks may use either the
+// old or the new values.
+static void thrashing_tuning_update(va_space_thrashing_info_t *va_space_thrashing, NvU64 time_stamp)
+{
+    NvU64 window_start = atomic64_read(&va_space_thrashing->tuning.window_start);
+    NvU64 window_ns = va_space_thrashing->params.epoch_ns;
+    NvU64 num_detections;
+    NvU64 num_expired_pins;
+    unsigned threshold = va_space_thrashing->params.threshold;
+    NvU64 lapse_ns = va_space_thrashing->params.lapse_ns;
+    NvU64 pin_ns = va_space_thrashing->params.pin_ns;
+
+    if (!thrashing_tuning_enabled(va_space_thrashing))
+        return;
+
+    if (time_stamp - window_start < window_ns)
+        return;
+
+    if (atomic64_cmpxchg(&va_space_thrashing->tuning.window_start, window_start, time_stamp) != window_start)
+        return;
+
+    num_detections = atomic64_xchg(&va_space_thrashing->tuning.num_detections, 0);
+    num_expired_pins = atomic64_xchg(&va_space_thrashing->tuning.num_expired_pins, 0);
+
+    if (num_detections == 0) {
+        if (time_stamp - window_start >= 2 * window_ns) {
+            threshold = va_space_thrashing->tuning.base_threshold;
+            lapse_ns = va_space_thrashing->tuning.base_lapse_ns;
+            pin_ns = va_space_thrashing->tuning.base_pin_ns;
+        }
+        else {
+            threshold = min(threshold + 1, va_space_thrashing->tuning.base_threshold);
+            lapse_ns = max(lapse_ns / 2, va_space_thrashing->tuning.base_lapse_ns);
+            pin_ns = max(pin_ns / 2, va_space_thrashing->tuning.base_pin_ns);
+        }
+    }
+    else if (num_expired_pins > 0 && num_detections >= num_expired_pins) {
+        if (threshold > 1)
+            --threshold;
+
+        lapse_ns = min(lapse_ns * 2,
+                       va_space_thrashing->tuning.base_lapse_ns * UVM_PERF_THRASHING_AUTO_TUNE_LAPSE_SCALE_MAX);
+
+        // A zero pin time means that pages are pinned forever, and it is
+        // never tuned
+        pin_ns = min(pin_ns * 2,
+                     va_space_thrashing->tuning.base_pin_ns * UVM_PERF_THRASHING_AUTO_TUNE_PIN_SCALE_MAX);
+    }
+
+    WRITE_ONCE(va_space_thrashing->params.threshold, threshold);
+    WRITE_ONCE(va_space_thrashing->params.lapse_ns, lapse_ns);
+    WRITE_ONCE(va_space_thrashing->params.pin_ns, pin_ns);
 }
 
 // Create the thrashing detection struct for the given VA space
@@ -641,7 +752,6 @@ static block_thrashing_info_t *thrashing_info_get_create(uvm_va_block_t *va_bloc
             goto done;
 
         block_thrashing->last_processor = UVM_ID_INVALID;
-        INIT_LIST_HEAD(&block_thrashing->pinned_pages.list);
 
         uvm_perf_module_type_set_data(va_block->perf_modules_data, block_thrashing, UVM_PERF_MODULE_TYPE_THRASHING);
     }
@@ -662,6 +772,7 @@ static void thrashing_info_destroy(uvm_va_block_t *va_block)
 
         uvm_perf_module_type_unset_data(va_block->perf_modules_data, UVM_PERF_MODULE_TYPE_THRASHING);
 
+        uvm_kvfree(block_thrashing->pinned_pages.descs);
         uvm_kvfree(block_thrashing->pages);
         kmem_cache_free(g_va_block_thrashing_info_cache, block_thrashing);
     }
@@ -718,7 +829,10 @@ static bool thrashing_state_checks(uvm_va_block_t *va_block,
     UVM_ASSERT(uvm_processor_mask_subset(&page_thrashing->throttled_processors,
                                          &page_thrashing->processors));
 
-    if (uvm_page_mask_test(&block_thrashing->thrashing_pages, page_index))
+    // The threshold may have been raised by the tuning controller after the
+    // page was detected as thrashing
+    if (uvm_page_mask_test(&block_thrashing->thrashing_pages, page_index) &&
+        !thrashing_tuning_enabled(va_space_thrashing))
         UVM_ASSERT(page_thrashing->num_thrashing_events >= va_space_thrashing->params.threshold);
 
     if (page_thrashing->pinned) {
@@ -729,6 +843,7 @@ static bool thrashing_state_checks(uvm_va_block_t *va_block,
     else {
         UVM_ASSERT(!uvm_page_mask_test(&block_thrashing->pinned_pages.mask, page_index));
         UVM_ASSERT(UVM_ID_IS_INVALID(page_thrashing->pinned_residency_id));
+        UVM_ASSERT(!block_thrashing->pinned_pages.descs || !block_thrashing->pinned_pages.descs[page_index]);
 
         if (!uvm_processor_mask_empty(&page_thrashing->throttled_processors)) {
             UVM_ASSERT(page_thrashing->throttling_count > 0);
@@ -857,14 +972,10 @@ static void thrashing_throttling_reset_page(uvm_va_block_t *va_block,
 // page is not pinned.
 static pinned_page_t *find_pinned_page(block_thrashing_info_t *block_thrashing, uvm_page_index_t page_index)
 {
-    pinned_page_t *pinned_page;
-
-    list_for_each_entry(pinned_page, &block_thrashing->pinned_pages.list, va_block_list_entry) {
-        if (pinned_page->page_index == page_index)
-            return pinned_page;
-    }
+    if (!block_thrashing->pinned_pages.descs)
+        return NULL;
 
-    return NULL;
+    return block_thrashing->pinned_pages.descs[page_index];
 }
 
 // Pin a page on the specified processor. All thrashing processors will be
@@ -895,19 +1006,33 @@ static NV_STATUS thrashing_pin_page(va_space_thrashing_info_t *va_space_thrashin
         thrashing_throttling_reset_page(va_block, block_thrashing, page_thrashing, page_index);
 
     if (!page_thrashing->pinned) {
-        if (va_space_thrashing->params.pin_ns > 0) {
-            pinned_page_t *pinned_page = nv_kmem_cache_zalloc(g_pinned_page_cache, NV_UVM_GFP_FLAGS);
+        NvU64 pin_ns = READ_ONCE(va_space_thrashing->params.pin_ns);
+
+        if (pin_ns > 0) {
+            pinned_page_t *pinned_page;
+
+            if (!block_thrashing->pinned_pages.descs) {
+                size_t num_block_pages = uvm_va_block_size(va_block) / PAGE_SIZE;
+
+                block_thrashing->pinned_pages.descs =
+                    uvm_kvmalloc_zero(sizeof(*block_thrashing->pinned_pages.descs) * num_block_pages);
+                if (!block_thrashing->pinned_pages.descs)
+                    return NV_ERR_NO_MEMORY;
+            }
+
+            pinned_page = nv_kmem_cache_zalloc(g_pinned_page_cache, NV_UVM_GFP_FLAGS);
             if (!pinned_page)
                 return NV_ERR_NO_MEMORY;
 
             pinned_page->va_block = va_block;
             pinned_page->page_index = page_index;
-            pinned_page->deadline = time_stamp + va_space_thrashing->params.pin_ns;
+            pinned_page->deadline = time_stamp + pin_ns;
+
+            block_thrashing->pinned_pages.descs[page_index] = pinned_page;
 
             uvm_spin_lock(&va_space_thrashing->pinned_pages.lock);
 
             list_add_tail(&pinned_page->va_space_list_entry, &va_space_thrashing->pinned_pages.list);
-            list_add_tail(&pinned_page->va_block_list_entry, &block_thrashing->pinned_pages.list);
 
             // We only schedule the delayed work if the list was empty before
             // adding this page. Otherwise, we just add it to the list. The
@@ -918,7 +1043,7 @@ static NV_STATUS thrashing_pin_page(va_space_thrashing_info_t *va_space_thrashin
                 !va_space_thrashing->pinned_pages.in_va_space_teardown) {
                 int scheduled;
                 scheduled = schedule_delayed_work(&va_space_thrashing->pinned_pages.dwork,
-                                                  usecs_to_jiffies(va_space_thrashing->params.pin_ns / 1000));
+                                                  usecs_to_jiffies(pin_ns / 1000));
                 UVM_ASSERT(scheduled != 0);
             }
 
@@ -949,27 +1074,31 @@ static void thrashing_unpin_page(va_space_thrashing_info_t *va_space_thrashing,
                                  page_thrashing_info_t *page_thrashing,
                                  uvm_page_index_t page_index)
 {
+    pinned_page_t *pinned_page;
+
     uvm_assert_mutex_locked(&va_block->lock);
     UVM_ASSERT(page_thrashing->pinned);
 
-    if (va_space_thrashing->params.pin_ns > 0) {
+    // The pinning timeout may have been changed by the tuning controller
+    // since the page was pinned, so the descriptor array is checked instead.
+    pinned_page = find_pinned_page(block_thrashing, page_index);
+    if (pinned_page) {
         bool do_free = false;
-        pinned_page_t *pinned_page = find_pinned_page(block_thrashing, page_index);
 
-        UVM_ASSERT(pinned_page);
         UVM_ASSERT(pinned_page->page_index == page_index);
         UVM_ASSERT(pinned_page->va_block == va_block);
 
-        // The va_space_list_entry and va_block_list_entry have special
+        // The va_space_list_entry and the block descriptor array have special
         // meanings here:
         // - va_space_list_entry: when the delayed unpin worker removes the
         // pinned_page from this list, it takes the ownership of the page and
         // is in charge of freeing it.
-        // - va_block_list_entry: by removing the page from this list,
-        // thrashing_unpin_page tells the unpin delayed worker to skip
-        // unpinning that page.
+        // - descriptor array: by clearing the page's entry, which is protected
+        // by the VA block lock, thrashing_unpin_page tells the unpin delayed
+        // worker to skip unpinning that page.
+        block_thrashing->pinned_pages.descs[page_index] = NULL;
+
         uvm_spin_lock(&va_space_thrashing->pinned_pages.lock);
-        list_del_init(&pinned_page->va_block_list_entry);
 
         if (!list_empty(&pinned_page->va_space_list_entry)) {
             do_free = true;
@@ -999,8 +1128,11 @@ static void thrashing_detected(uvm_va_block_t *va_block,
                                uvm_processor_id_t processor_id)
 {
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    va_space_thrashing_info_t *va_space_thrashing = va_space_thrashing_info_get(va_space);
     NvU64 address = uvm_va_block_cpu_page_address(va_block, page_index);
 
+    atomic64_inc(&va_space_thrashing->tuning.num_detections);
+
     // Thrashing detected, record the event
     uvm_tools_record_thrashing(va_space, address, PAGE_SIZE, &page_thrashing->processors);
     if (!uvm_page_mask_test_and_set(&block_thrashing->thrashing_pages, page_index))
@@ -1295,6 +1427,8 @@ void thrashing_event_cb(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_
 
     time_stamp = NV_GETTIME();
 
+    thrashing_tuning_update(va_space_thrashing, time_stamp);
+
     if (!block_thrashing->pages) {
         // Don't create the per-page tracking structure unless there is some potential thrashing within the block
         NvU16 num_block_pages;
@@ -1339,10 +1473,15 @@ void thrashing_event_cb(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_
 
         if (time_stamp - last_time_stamp <= va_space_thrashing->params.lapse_ns) {
             UVM_PERF_SATURATING_INC(page_thrashing->num_thrashing_events);
-            if (page_thrashing->num_thrashing_events == va_space_thrashing->params.threshold)
+
+            // Once detected, the page is thrashing until its state is reset,
+            // regardless of later changes to the threshold by the tuning
+            // controller.
+            if (page_thrashing->num_thrashing_events >= va_space_thrashing->params.threshold &&
+                !uvm_page_mask_test(&block_thrashing->thrashing_pages, page_index))
                 thrashing_detected(va_block, block_thrashing, page_thrashing, page_index, processor_id);
 
-            if (page_thrashing->num_thrashing_events >= va_space_thrashing->params.threshold)
+            if (uvm_page_mask_test(&block_thrashing->thrashing_pages, page_index))
                 block_thrashing->last_thrashing_time_stamp = time_stamp;
 
             if (event_id == UVM_PERF_EVENT_MIGRATION)
@@ -1350,8 +1489,7 @@ void thrashing_event_cb(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_
             else
                 page_thrashing->has_revocation_events = true;
         }
-        else if (page_thrashing->num_thrashing_events >= va_space_thrashing->params.threshold &&
-                 !page_thrashing->pinned) {
+        else if (uvm_page_mask_test(&block_thrashing->thrashing_pages, page_index) && !page_thrashing->pinned) {
             thrashing_reset_page(va_space_thrashing, va_block, block_thrashing, page_index);
         }
     }
@@ -1634,7 +1772,7 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
     page_thrashing = &block_thrashing->pages[page_index];
 
     // Not enough thrashing events yet
-    if (page_thrashing->num_thrashing_events < va_space_thrashing->params.threshold)
+    if (!uvm_page_mask_test(&block_thrashing->thrashing_pages, page_index))
         goto done;
 
     // If the requesting processor is throttled, check the throttling end time
@@ -1809,6 +1947,7 @@ static void thrashing_unpin_pages(struct work_struct *work)
     while (1) {
         pinned_page_t *pinned_page;
         uvm_va_block_t *va_block;
+        block_thrashing_info_t *block_thrashing;
 
         uvm_spin_lock(&va_space_thrashing->pinned_pages.lock);
         pinned_page = list_first_entry_or_null(&va_space_thrashing->pinned_pages.list,
@@ -1848,15 +1987,17 @@ static void thrashing_unpin_pages(struct work_struct *work)
         va_block = pinned_page->va_block;
         uvm_mutex_lock(&va_block->lock);
 
+        block_thrashing = thrashing_info_get(va_block);
+
         // Only operate if the pinned page's tracking state isn't already
         // cleared by thrashing_unpin_page()
-        if (!list_empty(&pinned_page->va_block_list_entry)) {
+        if (block_thrashing && find_pinned_page(block_thrashing, pinned_page->page_index) == pinned_page) {
             uvm_page_index_t page_index = pinned_page->page_index;
-            block_thrashing_info_t *block_thrashing = thrashing_info_get(va_block);
 
-            UVM_ASSERT(block_thrashing);
             UVM_ASSERT(uvm_page_mask_test(&block_thrashing->pinned_pages.mask, page_index));
 
+            atomic64_inc(&va_space_thrashing->tuning.num_expired_pins);
+
             va_space_thrashing->pinned_pages.va_block_context.policy =
                 uvm_va_policy_get(va_block, uvm_va_block_cpu_page_address(va_block, page_index));
 
@@ -1984,6 +2125,8 @@ NV_STATUS uvm_perf_thrashing_init()
 
     INIT_THRASHING_PARAMETER(uvm_perf_thrashing_max_resets, UVM_PERF_THRASHING_MAX_RESETS_DEFAULT);
 
+    INIT_THRASHING_PARAMETER_TOGGLE(uvm_perf_thrashing_auto_tune, UVM_PERF_THRASHING_AUTO_TUNE_DEFAULT);
+
     g_va_block_thrashing_info_cache = NV_KMEM_CACHE_CREATE("uvm_block_thrashing_info_t", block_thrashing_info_t);
     if (!g_va_block_thrashing_info_cache) {
         status = NV_ERR_NO_MEMORY;
@@ -2042,6 +2185,8 @@ NV_STATUS uvm_test_get_page_thrashing_policy(UVM_TEST_GET_PAGE_THRASHING_POLICY_
         params->policy = UVM_TEST_PAGE_THRASHING_POLICY_ENABLE;
         params->nap_ns = va_space_thrashing->params.nap_ns;
         params->pin_ns = va_space_thrashing->params.pin_ns;
+        params->lapse_ns = va_space_thrashing->params.lapse_ns;
+        params->threshold = va_space_thrashing->params.threshold;
         params->map_remote_on_native_atomics_fault = uvm_perf_map_remote_on_native_atomics_fault != 0;
     }
     else {
@@ -24,6 +24,7 @@
 #include "uvm_perf_utils.h"
 #include "uvm_va_block.h"
 #include "uvm_test.h"
+#include "uvm_test_rng.h"
 
 static NV_STATUS test_saturating_counter_basic(void)
 {
@@ -711,6 +712,82 @@ static NV_STATUS test_bitmap_tree_traversal(void)
     return NV_OK;
 }
 
+static NV_STATUS check_page_mask_region_weights(const uvm_page_mask_t *mask1,
+                                                const uvm_page_mask_t *mask2,
+                                                uvm_va_block_region_t region)
+{
+    uvm_page_mask_t andnot_mask;
+    uvm_page_index_t page_index;
+    NvU32 weight = 0;
+    NvU32 intersection_weight = 0;
+    NvU32 andnot_weight = 0;
+
+    for_each_va_block_page_in_region(page_index, region) {
+        bool in1 = uvm_page_mask_test(mask1, page_index);
+        bool in2 = uvm_page_mask_test(mask2, page_index);
+
+        weight += in1 ? 1 : 0;
+        intersection_weight += (in1 && in2) ? 1 : 0;
+        andnot_weight += (in1 && !in2) ? 1 : 0;
+    }
+
+    TEST_CHECK_RET(uvm_page_mask_region_weight(mask1, region) == weight);
+    TEST_CHECK_RET(uvm_page_mask_intersection_region_weight(mask1, mask2, region) == intersection_weight);
+    TEST_CHECK_RET(uvm_page_mask_andnot_region_weight(&andnot_mask, mask1, mask2, region) == andnot_weight);
+
+    // The whole output mask is updated, not only the region
+    for (page_index = 0; page_index < PAGES_PER_UVM_VA_BLOCK; ++page_index) {
+        bool expected = uvm_page_mask_test(mask1, page_index) && !uvm_page_mask_test(mask2, page_index);
+
+        TEST_CHECK_RET(uvm_page_mask_test(&andnot_mask, page_index) == expected);
+    }
+
+    return NV_OK;
+}
+
+// Compare the single-pass page mask region weight helpers against a page by
+// page computation, for random masks and regions plus the region edge cases.
+static NV_STATUS test_page_mask_region_weights(void)
+{
+    uvm_page_mask_t mask1;
+    uvm_page_mask_t mask2;
+    uvm_test_rng_t rng;
+    NvU32 i;
+
+    uvm_test_rng_init(&rng, 0);
+
+    for (i = 0; i < 256; ++i) {
+        uvm_va_block_region_t region;
+        uvm_page_index_t first;
+        uvm_page_index_t outer;
+
+        uvm_test_rng_memset(&rng, &mask1, sizeof(mask1));
+        uvm_test_rng_memset(&rng, &mask2, sizeof(mask2));
+
+        TEST_NV_CHECK_RET(check_page_mask_region_weights(&mask1,
+                                                         &mask2,
+                                                         uvm_va_block_region(0, PAGES_PER_UVM_VA_BLOCK)));
+        TEST_NV_CHECK_RET(check_page_mask_region_weights(&mask1, &mask2, uvm_va_block_region(0, 0)));
+        TEST_NV_CHECK_RET(check_page_mask_region_weights(&mask1, &mask2, uvm_va_block_region(0, 1)));
+        TEST_NV_CHECK_RET(check_page_mask_region_weights(&mask1,
+                                                         &mask2,
+                                                         uvm_va_block_region(PAGES_PER_UVM_VA_BLOCK - 1,
+                                                                             PAGES_PER_UVM_VA_BLOCK)));
+
+        first = uvm_test_rng_range_32(&rng, 0, PAGES_PER_UVM_VA_BLOCK);
+        outer = uvm_test_rng_range_32(&rng, first, PAGES_PER_UVM_VA_BLOCK);
+        region = uvm_va_block_region(first, outer);
+        TEST_NV_CHECK_RET(check_page_mask_region_weights(&mask1, &mask2, region));
+
+        // Regions ending and starting at word boundaries
+        first = rounddown(first, BITS_PER_LONG);
+        outer = min((uvm_page_index_t)roundup(outer, BITS_PER_LONG), (uvm_page_index_t)PAGES_PER_UVM_VA_BLOCK);
+        TEST_NV_CHECK_RET(check_page_mask_region_weights(&mask1, &mask2, uvm_va_block_region(first, outer)));
+    }
+
+    return NV_OK;
+}
+
 static NV_STATUS test_trees(void)
 {
     NV_STATUS status;
@@ -741,6 +818,9 @@ NV_STATUS uvm_test_perf_utils_sanity(UVM_TEST_PERF_UTILS_SANITY_PARAMS *params,
     if (status != NV_OK)
         goto fail;
     status = test_trees();
+    if (status != NV_OK)
+        goto fail;
+    status = test_page_mask_region_weights();
 
 fail:
     return status;
@@ -26,13 +26,147 @@
 #include "uvm_kvmalloc.h"
 #include "uvm_va_block.h"
 #include "uvm_va_space.h"
+#include "uvm_procfs.h"
 
 static int uvm_cpu_chunk_allocation_sizes = UVM_CPU_CHUNK_SIZES;
 module_param(uvm_cpu_chunk_allocation_sizes, uint, S_IRUGO | S_IWUSR);
 MODULE_PARM_DESC(uvm_cpu_chunk_allocation_sizes, "OR'ed value of all CPU chunk allocation sizes.");
 
+// Time during which allocations of a given size are not attempted after a
+// high-order allocation of that size failed.
+static unsigned uvm_cpu_chunk_alloc_backoff_ms = 100;
+module_param(uvm_cpu_chunk_alloc_backoff_ms, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(uvm_cpu_chunk_alloc_backoff_ms,
+                 "Time in ms during which a CPU chunk size is skipped after a failed allocation of that size.");
+
 static struct kmem_cache *g_reverse_page_map_cache __read_mostly;
 
+typedef enum
+{
+    UVM_CPU_CHUNK_STATS_SIZE_4K = 0,
+    UVM_CPU_CHUNK_STATS_SIZE_64K,
+    UVM_CPU_CHUNK_STATS_SIZE_2M,
+    UVM_CPU_CHUNK_STATS_SIZE_OTHER,
+    UVM_CPU_CHUNK_STATS_SIZE_COUNT
+} uvm_cpu_chunk_stats_size_t;
+
+static const char *const g_cpu_chunk_stats_size_names[UVM_CPU_CHUNK_STATS_SIZE_COUNT] =
+{
+    "4K",
+    "64K",
+    "2M",
+    "other"
+};
+
+// Distribution of the sizes of the physical CPU chunks, reported in procfs
+static struct
+{
+    // Number of physical chunks allocated since module load
+    atomic64_t allocated[UVM_CPU_CHUNK_STATS_SIZE_COUNT];
+
+    // Number of physical chunks currently allocated
+    atomic64_t live[UVM_CPU_CHUNK_STATS_SIZE_COUNT];
+
+    // Number of high-order allocations that failed and fell back to a smaller
+    // size
+    atomic64_t failed[UVM_CPU_CHUNK_STATS_SIZE_COUNT];
+
+    // Number of allocations of the size that were not attempted because a
+    // previous allocation of that size failed recently
+    atomic64_t skipped[UVM_CPU_CHUNK_STATS_SIZE_COUNT];
+
+    // Timestamp of the last failed allocation of the size
+    atomic64_t last_failure_ns[UVM_CPU_CHUNK_STATS_SIZE_COUNT];
+
+    struct proc_dir_entry *procfs_file;
+} g_uvm_cpu_chunk_stats;
+
+static uvm_cpu_chunk_stats_size_t cpu_chunk_stats_size(uvm_chunk_size_t size)
+{
+    switch (size) {
+        case UVM_CHUNK_SIZE_4K:
+            return UVM_CPU_CHUNK_STATS_SIZE_4K;
+        case UVM_CHUNK_SIZE_64K:
+            return UVM_CPU_CHUNK_STATS_SIZE_64K;
+        case UVM_CHUNK_SIZE_2M:
+            return UVM_CPU_CHUNK_STATS_SIZE_2M;
+        default:
+            return UVM_CPU_CHUNK_STATS_SIZE_OTHER;
+    }
+}
+
+static void cpu_chunk_stats_alloc(uvm_chunk_size_t size)
+{
+    uvm_cpu_chunk_stats_size_t index = cpu_chunk_stats_size(size);
+
+    atomic64_inc(&g_uvm_cpu_chunk_stats.allocated[index]);
+    atomic64_inc(&g_uvm_cpu_chunk_stats.live[index]);
+}
+
+static void cpu_chunk_stats_free(uvm_chunk_size_t size)
+{
+    atomic64_dec(&g_uvm_cpu_chunk_stats.live[cpu_chunk_stats_size(size)]);
+}
+
+#if !UVM_CPU_CHUNK_SIZE_IS_PAGE_SIZE()
+static void cpu_chunk_stats_alloc_failed(uvm_chunk_size_t size)
+{
+    uvm_cpu_chunk_stats_size_t index = cpu_chunk_stats_size(size);
+
+    atomic64_inc(&g_uvm_cpu_chunk_stats.failed[index]);
+    atomic64_set(&g_uvm_cpu_chunk_stats.last_failure_ns[index], NV_GETTIME());
+}
+
+// Returns true if a high-order allocation of the given size failed less than
+// uvm_cpu_chunk_alloc_backoff_ms ago. Memory is likely still too fragmented
+// to satisfy it, and the failed attempt is not free.
+static bool cpu_chunk_alloc_should_skip(uvm_chunk_size_t size)
+{
+    uvm_cpu_chunk_stats_size_t index = cpu_chunk_stats_size(size);
+    NvU64 last_failure_ns = atomic64_read(&g_uvm_cpu_chunk_stats.last_failure_ns[index]);
+
+    if (size == PAGE_SIZE || last_failure_ns == 0)
+        return false;
+
+    if (NV_GETTIME() - last_failure_ns >= (NvU64)uvm_cpu_chunk_alloc_backoff_ms * 1000 * 1000)
+        return false;
+
+    atomic64_inc(&g_uvm_cpu_chunk_stats.skipped[index]);
+    return true;
+}
+#endif
+
+static int nv_procfs_read_cpu_chunk_sizes(struct seq_file *s, void *v)
+{
+    uvm_cpu_chunk_stats_size_t i;
+
+    if (!uvm_down_read_trylock(&g_uvm_global.pm.lock))
+            return -EAGAIN;
+
+    UVM_SEQ_OR_DBG_PRINT(s, "allocation_sizes        0x%x\n", uvm_cpu_chunk_get_allocation_sizes());
+    UVM_SEQ_OR_DBG_PRINT(s, "size     allocated        live      failed     skipped\n");
+    for (i = 0; i < UVM_CPU_CHUNK_STATS_SIZE_COUNT; i++) {
+        UVM_SEQ_OR_DBG_PRINT(s,
+                             "%-5s %12llu %11llu %11llu %11llu\n",
+                             g_cpu_chunk_stats_size_names[i],
+                             (NvU64)atomic64_read(&g_uvm_cpu_chunk_stats.allocated[i]),
+                             (NvU64)atomic64_read(&g_uvm_cpu_chunk_stats.live[i]),
+                             (NvU64)atomic64_read(&g_uvm_cpu_chunk_stats.failed[i]),
+                             (NvU64)atomic64_read(&g_uvm_cpu_chunk_stats.skipped[i]));
+    }
+
+    uvm_up_read(&g_uvm_global.pm.lock);
+
+    return 0;
+}
+
+static int nv_procfs_read_cpu_chunk_sizes_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_cpu_chunk_sizes(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(cpu_chunk_sizes_entry);
+
 NV_STATUS uvm_pmm_sysmem_init(void)
 {
     g_reverse_page_map_cache = NV_KMEM_CACHE_CREATE("uvm_pmm_sysmem_page_reverse_map_t",
@@ -40,11 +174,25 @@ NV_STATUS uvm_pmm_sysmem_init(void)
     if (!g_reverse_page_map_cache)
         return NV_ERR_NO_MEMORY;
 
+    if (uvm_procfs_is_debug_enabled()) {
+        g_uvm_cpu_chunk_stats.procfs_file = NV_CREATE_PROC_FILE("cpu_chunk_sizes",
+                                                                uvm_procfs_get_cpu_base_dir(),
+                                                                cpu_chunk_sizes_entry,
+                                                                NULL);
+        if (!g_uvm_cpu_chunk_stats.procfs_file) {
+            kmem_cache_destroy_safe(&g_reverse_page_map_cache);
+            return NV_ERR_OPERATING_SYSTEM;
+        }
+    }
+
     return NV_OK;
 }
 
 void uvm_pmm_sysmem_exit(void)
 {
+    uvm_procfs_destroy_entry(g_uvm_cpu_chunk_stats.procfs_file);
+    g_uvm_cpu_chunk_stats.procfs_file = NULL;
+
     kmem_cache_destroy_safe(&g_reverse_page_map_cache);
 }
 
@@ -460,6 +608,7 @@ struct page *uvm_cpu_chunk_get_cpu_page(uvm_va_block_t *va_block, uvm_cpu_chunk_
 void uvm_cpu_chunk_put(uvm_cpu_chunk_t *chunk)
 {
     UVM_ASSERT(chunk);
+    cpu_chunk_stats_free(PAGE_SIZE);
     put_page(chunk);
 }
 
@@ -574,6 +723,8 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_va_block_t *va_block,
     if (alloc_flags & __GFP_ZERO)
         SetPageDirty(chunk);
 
+    cpu_chunk_stats_alloc(PAGE_SIZE);
+
     status = uvm_cpu_chunk_insert_in_block(va_block, chunk, page_index);
     if (status != NV_OK) {
         uvm_cpu_chunk_put(chunk);
@@ -614,6 +765,7 @@ static void cpu_chunk_release(nv_kref_t *kref)
     if (!parent) {
         uvm_assert_spinlock_unlocked(&chunk->lock);
         uvm_kvfree(chunk->dirty_bitmap);
+        cpu_chunk_stats_free(uvm_cpu_chunk_get_phys_size(chunk));
         put_page(chunk->page);
     }
     else {
@@ -1157,6 +1309,11 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_va_block_t *va_block,
         if (!uvm_page_mask_empty(&scratch_page_mask))
             continue;
 
+        // Don't keep hammering the page allocator with high-order requests
+        // that recently failed. Smaller chunks are used in the meantime.
+        if (cpu_chunk_alloc_should_skip(alloc_size))
+            continue;
+
         // For allocation sizes higher than PAGE_SIZE, use __GFP_NORETRY in
         // order to avoid higher allocation latency from the kernel compacting
         // memory to satisfy the request.
@@ -1177,6 +1334,9 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_va_block_t *va_block,
                 SetPageDirty(page);
             break;
         }
+
+        if (alloc_size > PAGE_SIZE)
+            cpu_chunk_stats_alloc_failed(alloc_size);
     }
 
     if (!page) {
@@ -1192,6 +1352,7 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_va_block_t *va_block,
 
     chunk->page = page;
     uvm_cpu_chunk_set_phys_size(chunk, alloc_size);
+    cpu_chunk_stats_alloc(alloc_size);
     chunk->region = region;
     nv_kref_init(&chunk->refcount);
     uvm_spin_lock_init(&chunk->lock, UVM_LOCK_ORDER_LEAF);
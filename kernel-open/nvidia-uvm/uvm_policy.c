@@ -592,7 +592,7 @@ static NV_STATUS va_block_set_read_duplication_locked(uvm_va_block_t *va_block,
 
     for_each_id_in_mask(src_id, &va_block->resident) {
         NV_STATUS status;
-        uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(va_block, src_id);
+        const uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(va_block, src_id);
 
         // Calling uvm_va_block_make_resident_read_duplicate will break all
         // SetAccessedBy and remote mappings
@@ -646,7 +646,7 @@ static NV_STATUS va_block_unset_read_duplication_locked(uvm_va_block_t *va_block
     // If preferred_location is set and has resident copies, give it preference
     if (UVM_ID_IS_VALID(preferred_location) &&
         uvm_processor_mask_test(&va_block->resident, preferred_location)) {
-        uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(va_block, preferred_location);
+        const uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(va_block, preferred_location);
         bool is_mask_empty = !uvm_page_mask_and(break_read_duplication_pages,
                                                 &va_block->read_duplicated_pages,
                                                 resident_mask);
@@ -668,7 +668,7 @@ static NV_STATUS va_block_unset_read_duplication_locked(uvm_va_block_t *va_block
 
     // Then iterate over the rest of processors
     for_each_id_in_mask(processor_id, &va_block->resident) {
-        uvm_page_mask_t *resident_mask;
+        const uvm_page_mask_t *resident_mask;
         bool is_mask_empty;
 
         if (uvm_id_equal(processor_id, preferred_location))
@@ -878,7 +878,7 @@ static NV_STATUS system_wide_atomics_set(uvm_va_space_t *va_space, const NvProce
                     continue;
                 }
 
-                uvm_page_mask_complement(non_resident_pages, &va_block->gpus[uvm_id_gpu_index(gpu->id)]->resident);
+                uvm_page_mask_complement(non_resident_pages, uvm_va_block_resident_mask_get(va_block, gpu->id));
 
                 status = uvm_va_block_revoke_prot(va_block,
                                                   va_block_context,
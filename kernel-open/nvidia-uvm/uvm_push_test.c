@@ -568,14 +568,20 @@ static NV_STATUS test_max_pushes_on_gpu(uvm_gpu_t *gpu)
     return NV_OK;
 }
 
-// Test doing UVM_PUSHBUFFER_CHUNKS independent pushes expecting each one to use
-// a different chunk in the pushbuffer.
-static NV_STATUS test_idle_chunks_on_gpu(uvm_gpu_t *gpu)
+#define HOME_CHUNK_TEST_PUSHES 8
+
+// Test doing consecutive pushes that stay pending on the GPU, expecting all the
+// ones begun and ended on the same CPU to land in the home chunk of that CPU.
+// Pushes during which the task migrated are skipped as their home chunk is not
+// known.
+static NV_STATUS test_home_chunk_on_gpu(uvm_gpu_t *gpu)
 {
     NV_STATUS status;
 
+    uvm_pushbuffer_t *pushbuffer = gpu->channel_manager->pushbuffer;
     uvm_gpu_semaphore_t sema;
     uvm_tracker_t tracker = UVM_TRACKER_INIT();
+    NvU32 num_checked = 0;
     NvU32 i;
 
     uvm_tracker_init(&tracker);
@@ -590,42 +596,65 @@ static NV_STATUS test_idle_chunks_on_gpu(uvm_gpu_t *gpu)
     status = uvm_channel_manager_wait(gpu->channel_manager);
     TEST_CHECK_GOTO(status == NV_OK, done);
 
-    for (i = 0; i < UVM_PUSHBUFFER_CHUNKS; ++i) {
+    for (i = 0; i < HOME_CHUNK_TEST_PUSHES; ++i) {
         NvU64 semaphore_gpu_va;
+        NvU32 cpu_before;
+        NvU32 cpu_after;
+        NvU32 chunk_index;
         uvm_push_t push;
 
-        status = uvm_push_begin(gpu->channel_manager, UVM_CHANNEL_TYPE_GPU_INTERNAL, &push, "Push using chunk %u", i);
+        cpu_before = raw_smp_processor_id();
+
+        status = uvm_push_begin(gpu->channel_manager, UVM_CHANNEL_TYPE_GPU_INTERNAL, &push, "Push %u", i);
         TEST_CHECK_GOTO(status == NV_OK, done);
 
+        chunk_index = uvm_pushbuffer_get_offset_for_push(pushbuffer, &push) / UVM_PUSHBUFFER_CHUNK_SIZE;
+
+        // Keep the push pending on the GPU so that its chunk is not idle for
+        // the next one.
         semaphore_gpu_va = uvm_gpu_semaphore_get_gpu_va(&sema, gpu, uvm_channel_is_proxy(push.channel));
-        gpu->parent->host_hal->semaphore_acquire(&push, semaphore_gpu_va, i + 1);
+        gpu->parent->host_hal->semaphore_acquire(&push, semaphore_gpu_va, 1);
         uvm_push_end(&push);
 
+        cpu_after = raw_smp_processor_id();
+
         TEST_NV_CHECK_GOTO(uvm_tracker_add_push(&tracker, &push), done);
 
-        if (test_count_idle_chunks(gpu->channel_manager->pushbuffer) != UVM_PUSHBUFFER_CHUNKS - i - 1) {
-            UVM_TEST_PRINT("Unexpected count of idle chunks in the pushbuffer %u instead of %u\n",
-                           test_count_idle_chunks(gpu->channel_manager->pushbuffer), UVM_PUSHBUFFER_CHUNKS - i - 1);
-            uvm_pushbuffer_print(gpu->channel_manager->pushbuffer);
+        if (cpu_before != cpu_after)
+            continue;
+
+        ++num_checked;
+
+        if (chunk_index != cpu_before % UVM_PUSHBUFFER_CHUNKS) {
+            UVM_TEST_PRINT("Push %u on CPU %u used chunk %u instead of its home chunk %u\n",
+                           i,
+                           cpu_before,
+                           chunk_index,
+                           cpu_before % UVM_PUSHBUFFER_CHUNKS);
+            uvm_pushbuffer_print(pushbuffer);
             status = NV_ERR_INVALID_STATE;
             goto done;
         }
     }
-    uvm_gpu_semaphore_set_payload(&sema, UVM_PUSHBUFFER_CHUNKS + 1);
+
+    // Very unlikely, but the task could have migrated during every push
+    if (num_checked == 0)
+        UVM_TEST_PRINT("Every push migrated, home chunk not checked\n");
+
+    uvm_gpu_semaphore_set_payload(&sema, 1);
 
     status = uvm_channel_manager_wait(gpu->channel_manager);
     TEST_CHECK_GOTO(status == NV_OK, done);
 
-    if (test_count_idle_chunks(gpu->channel_manager->pushbuffer) != UVM_PUSHBUFFER_CHUNKS) {
-        UVM_TEST_PRINT("Unexpected count of idle chunks in the pushbuffer %u\n",
-                       test_count_idle_chunks(gpu->channel_manager->pushbuffer));
-        uvm_pushbuffer_print(gpu->channel_manager->pushbuffer);
+    if (test_count_idle_chunks(pushbuffer) != UVM_PUSHBUFFER_CHUNKS) {
+        UVM_TEST_PRINT("Unexpected count of idle chunks in the pushbuffer %u\n", test_count_idle_chunks(pushbuffer));
+        uvm_pushbuffer_print(pushbuffer);
         status = NV_ERR_INVALID_STATE;
         goto done;
     }
 
 done:
-    uvm_gpu_semaphore_set_payload(&sema, UVM_PUSHBUFFER_CHUNKS + 1);
+    uvm_gpu_semaphore_set_payload(&sema, 1);
     uvm_tracker_wait(&tracker);
 
     uvm_gpu_semaphore_free(&sema);
@@ -640,7 +669,7 @@ static NV_STATUS test_pushbuffer(uvm_va_space_t *va_space)
 
     for_each_va_space_gpu(gpu, va_space) {
         TEST_NV_CHECK_RET(test_max_pushes_on_gpu(gpu));
-        TEST_NV_CHECK_RET(test_idle_chunks_on_gpu(gpu));
+        TEST_NV_CHECK_RET(test_home_chunk_on_gpu(gpu));
     }
     return NV_OK;
 }
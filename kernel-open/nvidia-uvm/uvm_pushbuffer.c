@@ -124,26 +124,40 @@ error:
     return status;
 }
 
-static uvm_pushbuffer_chunk_t *get_chunk_in_mask(uvm_pushbuffer_t *pushbuffer, unsigned long *mask)
+// Index of the home chunk of the current CPU. The pushbuffer lock needs to be
+// held so that the task cannot migrate while using the result.
+static NvU32 get_home_chunk_index(uvm_pushbuffer_t *pushbuffer)
 {
-    NvU32 index = find_first_bit(mask, UVM_PUSHBUFFER_CHUNKS);
+    uvm_assert_spinlock_locked(&pushbuffer->lock);
+
+    return smp_processor_id() % UVM_PUSHBUFFER_CHUNKS;
+}
+
+// Find the first chunk set in the mask, starting the search at the given index
+// and wrapping around.
+static uvm_pushbuffer_chunk_t *get_chunk_in_mask(uvm_pushbuffer_t *pushbuffer, unsigned long *mask, NvU32 start)
+{
+    NvU32 index = find_next_bit(mask, UVM_PUSHBUFFER_CHUNKS, start);
 
     uvm_assert_spinlock_locked(&pushbuffer->lock);
 
+    if (index == UVM_PUSHBUFFER_CHUNKS)
+        index = find_first_bit(mask, UVM_PUSHBUFFER_CHUNKS);
+
     if (index == UVM_PUSHBUFFER_CHUNKS)
         return NULL;
 
     return &pushbuffer->chunks[index];
 }
 
-static uvm_pushbuffer_chunk_t *get_available_chunk(uvm_pushbuffer_t *pushbuffer)
+static uvm_pushbuffer_chunk_t *get_available_chunk(uvm_pushbuffer_t *pushbuffer, NvU32 start)
 {
-    return get_chunk_in_mask(pushbuffer, pushbuffer->available_chunks);
+    return get_chunk_in_mask(pushbuffer, pushbuffer->available_chunks, start);
 }
 
-static uvm_pushbuffer_chunk_t *get_idle_chunk(uvm_pushbuffer_t *pushbuffer)
+static uvm_pushbuffer_chunk_t *get_idle_chunk(uvm_pushbuffer_t *pushbuffer, NvU32 start)
 {
-    return get_chunk_in_mask(pushbuffer, pushbuffer->idle_chunks);
+    return get_chunk_in_mask(pushbuffer, pushbuffer->idle_chunks, start);
 }
 
 static NvU32 chunk_get_index(uvm_pushbuffer_t *pushbuffer, uvm_pushbuffer_chunk_t *chunk)
@@ -176,14 +190,20 @@ static void clear_chunk(uvm_pushbuffer_t *pushbuffer, uvm_pushbuffer_chunk_t *ch
     __clear_bit(index, mask);
 }
 
-static uvm_pushbuffer_chunk_t *pick_chunk(uvm_pushbuffer_t *pushbuffer)
+// Pick the chunk for a new push: the home chunk if it has space for it, then an
+// idle chunk, then any available chunk, which steals it from its home CPU.
+static uvm_pushbuffer_chunk_t *pick_chunk(uvm_pushbuffer_t *pushbuffer, NvU32 home_index)
 {
-    uvm_pushbuffer_chunk_t *chunk = get_idle_chunk(pushbuffer);
+    uvm_pushbuffer_chunk_t *chunk;
 
     uvm_assert_spinlock_locked(&pushbuffer->lock);
 
+    if (test_bit(home_index, pushbuffer->available_chunks))
+        return &pushbuffer->chunks[home_index];
+
+    chunk = get_idle_chunk(pushbuffer, home_index);
     if (chunk == NULL)
-        chunk = get_available_chunk(pushbuffer);
+        chunk = get_available_chunk(pushbuffer, home_index);
 
     return chunk;
 }
@@ -191,13 +211,24 @@ static uvm_pushbuffer_chunk_t *pick_chunk(uvm_pushbuffer_t *pushbuffer)
 static bool try_claim_chunk(uvm_pushbuffer_t *pushbuffer, uvm_push_t *push, uvm_pushbuffer_chunk_t **chunk_out)
 {
     uvm_pushbuffer_chunk_t *chunk;
+    NvU32 home_index;
+    NvU32 index;
 
     uvm_spin_lock(&pushbuffer->lock);
 
-    chunk = pick_chunk(pushbuffer);
+    home_index = get_home_chunk_index(pushbuffer);
+    chunk = pick_chunk(pushbuffer, home_index);
     if (!chunk)
         goto done;
 
+    index = chunk_get_index(pushbuffer, chunk);
+    if (index == home_index)
+        ++pushbuffer->stats.num_claims_home;
+    else if (test_bit(index, pushbuffer->idle_chunks))
+        ++pushbuffer->stats.num_claims_idle;
+    else
+        ++pushbuffer->stats.num_claims_stolen;
+
     chunk->current_push = push;
     clear_chunk(pushbuffer, chunk, pushbuffer->idle_chunks);
     clear_chunk(pushbuffer, chunk, pushbuffer->available_chunks);
@@ -231,6 +262,10 @@ static NV_STATUS claim_chunk(uvm_pushbuffer_t *pushbuffer, uvm_push_t *push, uvm
 
     uvm_channel_manager_update_progress(channel_manager);
 
+    uvm_spin_lock(&pushbuffer->lock);
+    ++pushbuffer->stats.num_claim_waits;
+    uvm_spin_unlock(&pushbuffer->lock);
+
     uvm_spin_loop_init(&spin);
     while (!try_claim_chunk(pushbuffer, push, chunk_out) && status == NV_OK) {
         UVM_SPIN_LOOP(&spin);
@@ -302,6 +337,25 @@ static NvU32 chunk_get_gpu_get(uvm_pushbuffer_t *pushbuffer, uvm_pushbuffer_chun
         return 0;
 }
 
+// Get the amount of space in the chunk that cannot be used for new pushes
+// because it's between gpu_get and cpu_put, including the waste at the end of
+// the chunk if the pending pushes wrapped around.
+static NvU32 chunk_get_used_size(uvm_pushbuffer_t *pushbuffer, uvm_pushbuffer_chunk_t *chunk)
+{
+    NvU32 gpu_get = chunk_get_gpu_get(pushbuffer, chunk);
+    NvU32 cpu_put = chunk_get_cpu_put(pushbuffer, chunk);
+
+    uvm_assert_spinlock_locked(&pushbuffer->lock);
+
+    if (list_empty(&chunk->pending_gpfifos))
+        return 0;
+
+    if (gpu_get < cpu_put)
+        return cpu_put - gpu_get;
+
+    return UVM_PUSHBUFFER_CHUNK_SIZE - (gpu_get - cpu_put);
+}
+
 static void update_chunk(uvm_pushbuffer_t *pushbuffer, uvm_pushbuffer_chunk_t *chunk)
 {
     NvU32 gpu_get = chunk_get_gpu_get(pushbuffer, chunk);
@@ -451,16 +505,22 @@ bool uvm_pushbuffer_has_space(uvm_pushbuffer_t *pushbuffer)
 
     uvm_spin_lock(&pushbuffer->lock);
 
-    has_space = pick_chunk(pushbuffer) != NULL;
+    has_space = pick_chunk(pushbuffer, 0) != NULL;
 
     uvm_spin_unlock(&pushbuffer->lock);
 
     return has_space;
 }
 
+// Number of buckets of the chunk occupancy histogram. Bucket 0 counts empty
+// chunks and bucket i > 0 counts chunks with occupancy in
+// ((i - 1) / (N - 1), i / (N - 1)] of the chunk size.
+#define UVM_PUSHBUFFER_OCCUPANCY_BUCKETS 5
+
 void uvm_pushbuffer_print_common(uvm_pushbuffer_t *pushbuffer, struct seq_file *s)
 {
     NvU32 i;
+    NvU32 occupancy_histogram[UVM_PUSHBUFFER_OCCUPANCY_BUCKETS] = { 0 };
 
     UVM_SEQ_OR_DBG_PRINT(s, "Pushbuffer for GPU %s\n", uvm_gpu_name(pushbuffer->channel_manager->gpu));
     UVM_SEQ_OR_DBG_PRINT(s, " has space: %d\n", uvm_pushbuffer_has_space(pushbuffer));
@@ -471,14 +531,37 @@ void uvm_pushbuffer_print_common(uvm_pushbuffer_t *pushbuffer, struct seq_file *
         uvm_pushbuffer_chunk_t *chunk = &pushbuffer->chunks[i];
         NvU32 cpu_put = chunk_get_cpu_put(pushbuffer, chunk);
         NvU32 gpu_get = chunk_get_gpu_get(pushbuffer, chunk);
-        UVM_SEQ_OR_DBG_PRINT(s, " chunk %u put %u get %u next %u available %d idle %d\n",
+        NvU32 used = chunk_get_used_size(pushbuffer, chunk);
+        NvU32 bucket = 0;
+
+        if (used > 0)
+            bucket = 1 + (NvU32)(((NvU64)used - 1) * (UVM_PUSHBUFFER_OCCUPANCY_BUCKETS - 1) /
+                                 UVM_PUSHBUFFER_CHUNK_SIZE);
+        ++occupancy_histogram[bucket];
+
+        UVM_SEQ_OR_DBG_PRINT(s, " chunk %u put %u get %u next %u used %u available %d idle %d\n",
                 i,
-                cpu_put, gpu_get, chunk->next_push_start,
+                cpu_put, gpu_get, chunk->next_push_start, used,
                 test_bit(i, pushbuffer->available_chunks) ? 1 : 0,
                 test_bit(i, pushbuffer->idle_chunks) ? 1 : 0);
 
     }
 
+    UVM_SEQ_OR_DBG_PRINT(s, " chunk occupancy histogram:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "   0%%: %u\n", occupancy_histogram[0]);
+    for (i = 1; i < UVM_PUSHBUFFER_OCCUPANCY_BUCKETS; ++i) {
+        UVM_SEQ_OR_DBG_PRINT(s, "   %u-%u%%: %u\n",
+                             (i - 1) * 100 / (UVM_PUSHBUFFER_OCCUPANCY_BUCKETS - 1) + (i > 1 ? 1 : 0),
+                             i * 100 / (UVM_PUSHBUFFER_OCCUPANCY_BUCKETS - 1),
+                             occupancy_histogram[i]);
+    }
+
+    UVM_SEQ_OR_DBG_PRINT(s, " claims: idle %llu home %llu stolen %llu waits %llu\n",
+                         pushbuffer->stats.num_claims_idle,
+                         pushbuffer->stats.num_claims_home,
+                         pushbuffer->stats.num_claims_stolen,
+                         pushbuffer->stats.num_claim_waits);
+
     uvm_spin_unlock(&pushbuffer->lock);
 }
 
@@ -59,10 +59,18 @@
 // processed by the GPU. The pushbuffer maintains two bitmaps, one tracking
 // completely idle (with no pending pushes) chunks and a second one tracking
 // available (with pending pushes, but still enough space for a new push)
-// chunks. When a new allocation is requested, idle chunks are always used
-// first and after that available chunks are consulted. If none are available,
-// the CPU spin waits on the GPU to complete some of the pending pushes making
-// space for a new one.
+// chunks.
+//
+// Each CPU has a home chunk (the CPU index modulo the number of chunks). When a
+// new allocation is requested, the home chunk of the CPU doing the push is used
+// if it has space, so pushes begun on the same CPU keep landing in the same
+// chunk. Otherwise idle chunks are used first and after that available chunks
+// are consulted, both searches starting at the home chunk so that concurrent
+// pushers on different CPUs spread over different chunks instead of all racing
+// for the lowest index. Using an available chunk other than the home chunk
+// steals it from whichever CPU it belongs to, which is always allowed. If none
+// are available, the CPU spin waits on the GPU to complete some of the pending
+// pushes making space for a new one.
 //
 // To explain how chunks track pending pushes we will go through an example
 // modifying a chunk's state. Let's start with a few pending pushes in the
@@ -196,6 +204,22 @@ struct uvm_pushbuffer_struct
     // are supported.
     uvm_semaphore_t concurrent_pushes_sema;
 
+    // Chunk claim statistics, protected by the pushbuffer lock
+    struct
+    {
+        // Claims of the home chunk of the claiming CPU
+        NvU64 num_claims_home;
+
+        // Claims of a completely idle chunk other than the home chunk
+        NvU64 num_claims_idle;
+
+        // Claims of the home chunk of another CPU, with pending pushes
+        NvU64 num_claims_stolen;
+
+        // Number of times no chunk was available and claim_chunk() had to wait
+        NvU64 num_claim_waits;
+    } stats;
+
     struct
     {
         struct proc_dir_entry *info_file;
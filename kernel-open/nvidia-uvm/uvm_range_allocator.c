@@ -24,13 +24,161 @@
 #include "uvm_range_allocator.h"
 #include "uvm_kvmalloc.h"
 
+// Number of candidates, in size order, checked for an aligned fit before
+// falling back to a lookup of a free range large enough to fit the allocation
+// at any alignment. If there is no such range, all the remaining candidates are
+// checked.
+#define UVM_RANGE_ALLOCATOR_MAX_FIT_ATTEMPTS 8
+
+static uvm_range_allocator_node_t *allocator_node(uvm_range_tree_node_t *node)
+{
+    return container_of(node, uvm_range_allocator_node_t, range_node);
+}
+
+static NvU64 allocator_node_size(uvm_range_allocator_node_t *node)
+{
+    return uvm_range_tree_node_size(&node->range_node);
+}
+
+static void size_tree_insert(uvm_range_allocator_t *range_allocator, uvm_range_allocator_node_t *node)
+{
+    struct rb_node **link = &range_allocator->size_tree.rb_node;
+    struct rb_node *parent = NULL;
+    NvU64 size = allocator_node_size(node);
+    NvU64 start = node->range_node.start;
+
+    while (*link) {
+        uvm_range_allocator_node_t *other = rb_entry(*link, uvm_range_allocator_node_t, size_node);
+        NvU64 other_size = allocator_node_size(other);
+
+        parent = *link;
+        if (size < other_size || (size == other_size && start < other->range_node.start))
+            link = &(*link)->rb_left;
+        else
+            link = &(*link)->rb_right;
+    }
+
+    rb_link_node(&node->size_node, parent, link);
+    rb_insert_color(&node->size_node, &range_allocator->size_tree);
+}
+
+static void size_tree_remove(uvm_range_allocator_t *range_allocator, uvm_range_allocator_node_t *node)
+{
+    rb_erase(&node->size_node, &range_allocator->size_tree);
+}
+
+// Find the smallest, and then lowest, free range of at least the given size
+static uvm_range_allocator_node_t *size_tree_lower_bound(uvm_range_allocator_t *range_allocator, NvU64 size)
+{
+    struct rb_node *rb_node = range_allocator->size_tree.rb_node;
+    uvm_range_allocator_node_t *found = NULL;
+
+    while (rb_node) {
+        uvm_range_allocator_node_t *node = rb_entry(rb_node, uvm_range_allocator_node_t, size_node);
+
+        if (allocator_node_size(node) >= size) {
+            found = node;
+            rb_node = rb_node->rb_left;
+        }
+        else {
+            rb_node = rb_node->rb_right;
+        }
+    }
+
+    return found;
+}
+
+// Check whether an allocation of the given size and alignment fits in the free
+// range and if so, return its aligned start.
+static bool allocator_node_fits(uvm_range_allocator_node_t *node, NvU64 size, NvU64 alignment, NvU64 *aligned_start_out)
+{
+    NvU64 start = node->range_node.start;
+    NvU64 aligned_start = UVM_ALIGN_UP(start, alignment);
+    NvU64 aligned_end = aligned_start + size - 1;
+
+    // Check for overflow of aligned_start and aligned_end
+    if (aligned_start < start || aligned_end < aligned_start)
+        return false;
+
+    // Check whether it fits
+    if (aligned_end > node->range_node.end)
+        return false;
+
+    *aligned_start_out = aligned_start;
+    return true;
+}
+
+// Check up to max_attempts free ranges in size order, starting at node, for one
+// the allocation fits in.
+static uvm_range_allocator_node_t *find_fit_from(uvm_range_allocator_node_t *node,
+                                                 NvU32 max_attempts,
+                                                 NvU64 size,
+                                                 NvU64 alignment,
+                                                 NvU64 *aligned_start_out)
+{
+    NvU32 attempts;
+
+    for (attempts = 0; node && attempts < max_attempts; ++attempts) {
+        struct rb_node *next;
+
+        if (allocator_node_fits(node, size, alignment, aligned_start_out))
+            return node;
+
+        next = rb_next(&node->size_node);
+        node = next ? rb_entry(next, uvm_range_allocator_node_t, size_node) : NULL;
+    }
+
+    return NULL;
+}
+
+static uvm_range_allocator_node_t *find_fit(uvm_range_allocator_t *range_allocator,
+                                            NvU64 size,
+                                            NvU64 alignment,
+                                            NvU64 *aligned_start_out)
+{
+    uvm_range_allocator_node_t *first;
+    uvm_range_allocator_node_t *node;
+    NvU64 size_any_alignment;
+
+    // Best-fit: the smallest free ranges that are big enough are usually
+    // suitably aligned, as allocations tend to use uniform alignments.
+    first = size_tree_lower_bound(range_allocator, size);
+    node = find_fit_from(first, UVM_RANGE_ALLOCATOR_MAX_FIT_ATTEMPTS, size, alignment, aligned_start_out);
+    if (node)
+        return node;
+
+    // With no alignment the first candidate always fits
+    if (alignment == 1)
+        return NULL;
+
+    // Otherwise skip straight to the free ranges that can fit the allocation
+    // regardless of their alignment. Any range of at least
+    // size + alignment - 1 is suitable, unless that size overflows, in which
+    // case no range is.
+    size_any_alignment = size + alignment - 1;
+    if (size_any_alignment >= size) {
+        node = find_fit_from(size_tree_lower_bound(range_allocator, size_any_alignment),
+                             1,
+                             size,
+                             alignment,
+                             aligned_start_out);
+        if (node)
+            return node;
+    }
+
+    // There is no such range, but a smaller one past the candidates checked
+    // above may still happen to be suitably aligned, so check all of them.
+    return find_fit_from(first, UINT_MAX, size, alignment, aligned_start_out);
+}
+
 NV_STATUS uvm_range_allocator_init(NvU64 size, uvm_range_allocator_t *range_allocator)
 {
     NV_STATUS status;
-    uvm_range_tree_node_t *node;
+    uvm_range_allocator_node_t *node;
 
     uvm_spin_lock_init(&range_allocator->lock, UVM_LOCK_ORDER_LEAF);
     uvm_range_tree_init(&range_allocator->range_tree);
+    range_allocator->size_tree = RB_ROOT;
 
     UVM_ASSERT(size > 0);
 
@@ -38,12 +186,14 @@ NV_STATUS uvm_range_allocator_init(NvU64 size, uvm_range_allocator_t *range_allo
     if (!node)
         return NV_ERR_NO_MEMORY;
 
-    node->start = 0;
-    node->end = size - 1;
+    node->range_node.start = 0;
+    node->range_node.end = size - 1;
 
-    status = uvm_range_tree_add(&range_allocator->range_tree, node);
+    status = uvm_range_tree_add(&range_allocator->range_tree, &node->range_node);
     UVM_ASSERT(status == NV_OK);
 
+    size_tree_insert(range_allocator, node);
+
     range_allocator->size = size;
 
     return NV_OK;
@@ -60,14 +210,18 @@ void uvm_range_allocator_deinit(uvm_range_allocator_t *range_allocator)
     // Remove the node for completeness even though after deinit the state of
     // tree doesn't matter anyway.
     uvm_range_tree_remove(&range_allocator->range_tree, node);
+    size_tree_remove(range_allocator, allocator_node(node));
+    UVM_ASSERT(RB_EMPTY_ROOT(&range_allocator->size_tree));
 
-    uvm_kvfree(node);
+    uvm_kvfree(allocator_node(node));
 }
 
 NV_STATUS uvm_range_allocator_alloc(uvm_range_allocator_t *range_allocator, NvU64 size, NvU64 alignment, uvm_range_allocation_t *range_alloc)
 {
-    uvm_range_tree_node_t *node;
-    bool found = false;
+    uvm_range_allocator_node_t *node;
+    uvm_range_allocator_node_t *alloc_node;
+    NvU64 aligned_start = 0;
+    NvU64 aligned_end;
 
     UVM_ASSERT(size > 0);
 
@@ -81,58 +235,47 @@ NV_STATUS uvm_range_allocator_alloc(uvm_range_allocator_t *range_allocator, NvU6
 
     // Pre-allocate a tree node as part of the allocation so that freeing the
     // range won't require allocating memory and will always succeed.
-    range_alloc->node = uvm_kvmalloc(sizeof(*range_alloc->node));
-    if (!range_alloc->node)
+    alloc_node = uvm_kvmalloc(sizeof(*alloc_node));
+    if (!alloc_node)
         return NV_ERR_NO_MEMORY;
 
     uvm_spin_lock(&range_allocator->lock);
 
-    // This is a very simple brute force going over all the free ranges in
-    // address order and returning the first one that's big enough.
-    // This could be improved by e.g. also maintaining a binary tree of free
-    // ranges ordered by their size.
-    uvm_range_tree_for_each_in(node, &range_allocator->range_tree, 0, range_allocator->size - size) {
-        NvU64 aligned_start = UVM_ALIGN_UP(node->start, alignment);
-        NvU64 aligned_end = aligned_start + size - 1;
-
-        // Check for overflow of aligned_start and aligned_end
-        if (aligned_start < node->start || aligned_end < aligned_start)
-            continue;
-
-        // Check whether it fits
-        if (aligned_end > node->end)
-            continue;
-
-        // The allocation always wastes the [node->start, aligned_start) space,
-        // but it's expected that there will always be plenty of free space to
-        // allocate from and wasting that space should help avoid fragmentation.
-
-        range_alloc->aligned_start = aligned_start;
-        range_alloc->node->start = node->start;
-        range_alloc->node->end = aligned_end;
-
-        if (aligned_end < node->end) {
-            // Shrink the node if the claimed size is smaller than the node.
-            uvm_range_tree_shrink_node(&range_allocator->range_tree, node, aligned_end + 1, node->end);
-        }
-        else {
-            // Otherwise just remove it. The removal is safe to do in the loop
-            // over nodes as a break is following immediately.
-            UVM_ASSERT(node->end == aligned_end);
-            uvm_range_tree_remove(&range_allocator->range_tree, node);
-            uvm_kvfree(node);
-        }
-        found = true;
-        break;
+    node = find_fit(range_allocator, size, alignment, &aligned_start);
+    if (!node) {
+        uvm_spin_unlock(&range_allocator->lock);
+        uvm_kvfree(alloc_node);
+        range_alloc->node = NULL;
+        return NV_ERR_UVM_ADDRESS_IN_USE;
     }
 
-    uvm_spin_unlock(&range_allocator->lock);
+    aligned_end = aligned_start + size - 1;
 
-    if (!found) {
-        uvm_kvfree(range_alloc->node);
-        range_alloc->node = NULL;
-        return NV_ERR_UVM_ADDRESS_IN_USE;
+    // The allocation always wastes the [node->start, aligned_start) space,
+    // but it's expected that there will always be plenty of free space to
+    // allocate from and wasting that space should help avoid fragmentation.
+
+    range_alloc->aligned_start = aligned_start;
+    range_alloc->node = &alloc_node->range_node;
+    range_alloc->node->start = node->range_node.start;
+    range_alloc->node->end = aligned_end;
+
+    size_tree_remove(range_allocator, node);
+
+    if (aligned_end < node->range_node.end) {
+        // Shrink the node if the claimed size is smaller than the node, and
+        // re-insert it in the size tree with its new size.
+        uvm_range_tree_shrink_node(&range_allocator->range_tree, &node->range_node, aligned_end + 1, node->range_node.end);
+        size_tree_insert(range_allocator, node);
     }
+    else {
+        // Otherwise just remove it
+        UVM_ASSERT(node->range_node.end == aligned_end);
+        uvm_range_tree_remove(&range_allocator->range_tree, &node->range_node);
+        uvm_kvfree(node);
+    }
+
+    uvm_spin_unlock(&range_allocator->lock);
 
     return NV_OK;
 }
@@ -153,14 +296,23 @@ void uvm_range_allocator_free(uvm_range_allocator_t *range_allocator, uvm_range_
     status = uvm_range_tree_add(&range_allocator->range_tree, range_alloc->node);
     UVM_ASSERT(status == NV_OK);
 
-    // And try merging it with adjacent nodes
+    // And try merging it with adjacent nodes. The merged nodes are removed
+    // from the range tree by the merge, but still need to be removed from the
+    // size tree.
     adjacent_node = uvm_range_tree_merge_prev(&range_allocator->range_tree, range_alloc->node);
-    if (adjacent_node)
-        uvm_kvfree(adjacent_node);
+    if (adjacent_node) {
+        size_tree_remove(range_allocator, allocator_node(adjacent_node));
+        uvm_kvfree(allocator_node(adjacent_node));
+    }
 
     adjacent_node = uvm_range_tree_merge_next(&range_allocator->range_tree, range_alloc->node);
-    if (adjacent_node)
-        uvm_kvfree(adjacent_node);
+    if (adjacent_node) {
+        size_tree_remove(range_allocator, allocator_node(adjacent_node));
+        uvm_kvfree(allocator_node(adjacent_node));
+    }
+
+    // Index the free range by its final size
+    size_tree_insert(range_allocator, allocator_node(range_alloc->node));
 
     uvm_spin_unlock(&range_allocator->lock);
 
@@ -34,10 +34,23 @@ typedef struct {
     // Size of the range to allocate from
     NvU64 size;
 
-    // Range tree tracking all the free ranges
+    // Range tree tracking all the free ranges, used for coalescing on free
     uvm_range_tree_t range_tree;
+
+    // Tree of uvm_range_allocator_node_t's of all the free ranges sorted by
+    // (size, start), used for best-fit allocation
+    struct rb_root size_tree;
 } uvm_range_allocator_t;
 
+// A free range tracked by the range allocator
+typedef struct {
+    // Node in uvm_range_allocator_t::range_tree
+    uvm_range_tree_node_t range_node;
+
+    // Node in uvm_range_allocator_t::size_tree
+    struct rb_node size_node;
+} uvm_range_allocator_node_t;
+
 // A free range allocation
 typedef struct {
     // The allocated start of the range
@@ -46,6 +59,9 @@ typedef struct {
     // A tree node allocated at the time of range allocation and used by the
     // range allocator when the range allocation is freed. This allows to
     // guarantee that uvm_range_allocator_free() always succeeds.
+    //
+    // The node is embedded in a uvm_range_allocator_node_t and spans the whole
+    // allocated range, including any space wasted for alignment.
     uvm_range_tree_node_t *node;
 } uvm_range_allocation_t;
 
@@ -63,6 +79,10 @@ void uvm_range_allocator_deinit(uvm_range_allocator_t *range_allocator);
 // Alignment needs to be a power of 2 or 0. Alignment of 0 is converted into
 // alignment of 1.
 //
+// The smallest free range the allocation fits in is used (best-fit), and the
+// allocation is carved out of the start of it. Lookups are logarithmic in the
+// number of free ranges.
+//
 // On success, the start of the allocated range is returned in
 // free_range_alloc->aligned_start.
 NV_STATUS uvm_range_allocator_alloc(uvm_range_allocator_t *range_allocator, NvU64 size, NvU64 alignment, uvm_range_allocation_t *free_range_alloc);
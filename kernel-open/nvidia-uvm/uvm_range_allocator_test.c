@@ -193,6 +193,205 @@ static NV_STATUS basic_test(void)
     return NV_OK;
 }
 
+// Check that allocations use the smallest free range they fit in, and that
+// aligned allocations skip free ranges they can't be aligned in.
+//
+// Notably this test leaks memory on failure as it's hard to clean up correctly
+// if something goes wrong and uvm_range_allocator_deinit would likely hit
+// asserts.
+static NV_STATUS best_fit_test(void)
+{
+    NV_STATUS status;
+    uvm_range_allocator_t range_allocator;
+    uvm_range_allocation_t range_allocs[6];
+    NvU32 i;
+
+    status = uvm_range_allocator_init(1024, &range_allocator);
+    TEST_CHECK_RET(status == NV_OK);
+
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, 64, 1, &range_allocs[0]) == NV_OK);
+    for (i = 1; i < 4; ++i)
+        TEST_CHECK_RET(test_alloc_range(&range_allocator, 16, 1, &range_allocs[i]) == NV_OK);
+
+    TEST_CHECK_RET(range_allocs[2].aligned_start == 80);
+
+    // Leave a 64 byte hole at 0 and a 16 byte hole at 80 in front of the free
+    // tail at 112.
+    test_free_range(&range_allocator, &range_allocs[0]);
+    test_free_range(&range_allocator, &range_allocs[2]);
+
+    // The smallest hole is used even though it's not the lowest one
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, 16, 1, &range_allocs[0]) == NV_OK);
+    TEST_CHECK_RET(range_allocs[0].aligned_start == 80);
+
+    // Splitting the 64 byte hole leaves a 32 byte hole at 32
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, 32, 32, &range_allocs[2]) == NV_OK);
+    TEST_CHECK_RET(range_allocs[2].aligned_start == 0);
+    TEST_CHECK_RET(test_check_free_range(&range_allocator, 32, 32) == NV_OK);
+
+    // The 32 byte hole is big enough, but can't be aligned to 64
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, 16, 64, &range_allocs[4]) == NV_OK);
+    TEST_CHECK_RET(range_allocs[4].aligned_start == 128);
+    TEST_CHECK_RET(test_check_free_range(&range_allocator, 32, 32) == NV_OK);
+
+    // But it's used for an allocation that fits exactly
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, 32, 1, &range_allocs[5]) == NV_OK);
+    TEST_CHECK_RET(range_allocs[5].aligned_start == 32);
+
+    for (i = 0; i < ARRAY_SIZE(range_allocs); ++i)
+        test_free_range(&range_allocator, &range_allocs[i]);
+
+    TEST_CHECK_RET(test_check_range_allocator_empty(&range_allocator) == NV_OK);
+
+    uvm_range_allocator_deinit(&range_allocator);
+
+    return NV_OK;
+}
+
+#define ALIGNED_FIT_TEST_CHUNK_SIZE 16
+#define ALIGNED_FIT_TEST_CHUNKS 40
+
+// Check that an aligned allocation finds the only suitably aligned free range
+// when more same-sized free ranges that can't be aligned come before it in size
+// order than the best-fit lookup checks up front, and no free range is large
+// enough to fit the allocation at any alignment.
+//
+// Notably this test leaks memory on failure as it's hard to clean up correctly
+// if something goes wrong and uvm_range_allocator_deinit would likely hit
+// asserts.
+static NV_STATUS aligned_fit_test(void)
+{
+    NV_STATUS status;
+    uvm_range_allocator_t range_allocator;
+    uvm_range_allocation_t range_allocs[ALIGNED_FIT_TEST_CHUNKS];
+    uvm_range_allocation_t range_alloc;
+    const NvU64 alignment = 2 * ALIGNED_FIT_TEST_CHUNK_SIZE;
+    const NvU32 aligned_hole = ALIGNED_FIT_TEST_CHUNKS / 2;
+    NvU32 i;
+
+    status = uvm_range_allocator_init(ALIGNED_FIT_TEST_CHUNK_SIZE * ALIGNED_FIT_TEST_CHUNKS, &range_allocator);
+    TEST_CHECK_RET(status == NV_OK);
+
+    for (i = 0; i < ALIGNED_FIT_TEST_CHUNKS; ++i) {
+        TEST_CHECK_RET(test_alloc_range(&range_allocator, ALIGNED_FIT_TEST_CHUNK_SIZE, 1, &range_allocs[i]) == NV_OK);
+        TEST_CHECK_RET(range_allocs[i].aligned_start == (NvU64)i * ALIGNED_FIT_TEST_CHUNK_SIZE);
+    }
+
+    // Free every odd chunk below the one next to the aligned hole, leaving 9
+    // holes that each start half way into an aligned block, then free the even
+    // chunk at the aligned hole. None of the holes coalesce and all are the
+    // same size, so the aligned one comes last in size order.
+    for (i = 1; i + 1 < aligned_hole; i += 2)
+        test_free_range(&range_allocator, &range_allocs[i]);
+    test_free_range(&range_allocator, &range_allocs[aligned_hole]);
+
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, ALIGNED_FIT_TEST_CHUNK_SIZE, alignment, &range_allocs[aligned_hole]) == NV_OK);
+    TEST_CHECK_RET(range_allocs[aligned_hole].aligned_start == (NvU64)aligned_hole * ALIGNED_FIT_TEST_CHUNK_SIZE);
+
+    // None of the remaining holes can be aligned
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, ALIGNED_FIT_TEST_CHUNK_SIZE, alignment, &range_alloc) ==
+                   NV_ERR_UVM_ADDRESS_IN_USE);
+
+    // But they still fit unaligned allocations
+    for (i = 1; i + 1 < aligned_hole; i += 2)
+        TEST_CHECK_RET(test_alloc_range(&range_allocator, ALIGNED_FIT_TEST_CHUNK_SIZE, 1, &range_allocs[i]) == NV_OK);
+
+    for (i = 0; i < ARRAY_SIZE(range_allocs); ++i)
+        test_free_range(&range_allocator, &range_allocs[i]);
+
+    TEST_CHECK_RET(test_check_range_allocator_empty(&range_allocator) == NV_OK);
+
+    uvm_range_allocator_deinit(&range_allocator);
+
+    return NV_OK;
+}
+
+#define FRAGMENTATION_TEST_CHUNK_SIZE 16
+#define FRAGMENTATION_TEST_CHUNKS (16 * 1024)
+#define FRAGMENTATION_TEST_SIZE (FRAGMENTATION_TEST_CHUNK_SIZE * FRAGMENTATION_TEST_CHUNKS)
+
+// Fragment the whole allocator into free ranges that can't be coalesced, then
+// refill and drain it, timing the allocations and frees done while fragmented.
+//
+// Notably this test leaks memory on failure as it's hard to clean up correctly
+// if something goes wrong and uvm_range_allocator_deinit would likely hit
+// asserts.
+static NV_STATUS fragmentation_test(bool verbose)
+{
+    NV_STATUS status;
+    uvm_range_allocator_t range_allocator;
+    uvm_range_allocation_t *range_allocs;
+    uvm_range_allocation_t range_alloc;
+    NvU64 start_time;
+    NvU64 alloc_time;
+    NvU64 free_time;
+    NvU32 i;
+
+    range_allocs = uvm_kvmalloc(sizeof(*range_allocs) * FRAGMENTATION_TEST_CHUNKS);
+    if (!range_allocs)
+        return NV_ERR_NO_MEMORY;
+
+    status = uvm_range_allocator_init(FRAGMENTATION_TEST_SIZE, &range_allocator);
+    TEST_CHECK_RET(status == NV_OK);
+
+    for (i = 0; i < FRAGMENTATION_TEST_CHUNKS; ++i) {
+        TEST_CHECK_RET(test_alloc_range(&range_allocator, FRAGMENTATION_TEST_CHUNK_SIZE, 1, &range_allocs[i]) == NV_OK);
+        TEST_CHECK_RET(range_allocs[i].aligned_start == (NvU64)i * FRAGMENTATION_TEST_CHUNK_SIZE);
+    }
+
+    // Free every other chunk, leaving half of the space free in ranges that
+    // are all too small for anything bigger than a chunk.
+    for (i = 0; i < FRAGMENTATION_TEST_CHUNKS; i += 2)
+        test_free_range(&range_allocator, &range_allocs[i]);
+
+    TEST_CHECK_RET(test_alloc_range(&range_allocator,
+                                    2 * FRAGMENTATION_TEST_CHUNK_SIZE,
+                                    1,
+                                    &range_alloc) == NV_ERR_UVM_ADDRESS_IN_USE);
+    TEST_CHECK_RET(test_alloc_range(&range_allocator,
+                                    FRAGMENTATION_TEST_CHUNK_SIZE,
+                                    2 * FRAGMENTATION_TEST_CHUNK_SIZE,
+                                    &range_alloc) == NV_OK);
+    TEST_CHECK_RET(range_alloc.aligned_start == 0);
+    test_free_range(&range_allocator, &range_alloc);
+
+    // Refill all the holes
+    start_time = NV_GETTIME();
+    for (i = 0; i < FRAGMENTATION_TEST_CHUNKS; i += 2) {
+        TEST_CHECK_RET(test_alloc_range(&range_allocator,
+                                        FRAGMENTATION_TEST_CHUNK_SIZE,
+                                        FRAGMENTATION_TEST_CHUNK_SIZE,
+                                        &range_allocs[i]) == NV_OK);
+    }
+    alloc_time = NV_GETTIME() - start_time;
+
+    TEST_CHECK_RET(test_alloc_range(&range_allocator, 1, 1, &range_alloc) == NV_ERR_UVM_ADDRESS_IN_USE);
+
+    // Free the odd chunks first so that the free space stays fragmented until
+    // the even chunks are freed and everything coalesces back.
+    start_time = NV_GETTIME();
+    for (i = 1; i < FRAGMENTATION_TEST_CHUNKS; i += 2)
+        test_free_range(&range_allocator, &range_allocs[i]);
+    for (i = 0; i < FRAGMENTATION_TEST_CHUNKS; i += 2)
+        test_free_range(&range_allocator, &range_allocs[i]);
+    free_time = NV_GETTIME() - start_time;
+
+    TEST_CHECK_RET(test_check_range_allocator_empty(&range_allocator) == NV_OK);
+
+    if (verbose) {
+        UVM_TEST_PRINT("Fragmented allocs %u: alloc %llu ns/op, free %llu ns/op\n",
+                       FRAGMENTATION_TEST_CHUNKS / 2,
+                       alloc_time / (FRAGMENTATION_TEST_CHUNKS / 2),
+                       free_time / FRAGMENTATION_TEST_CHUNKS);
+    }
+
+    uvm_range_allocator_deinit(&range_allocator);
+
+    uvm_kvfree(range_allocs);
+
+    return NV_OK;
+}
+
 #define RANDOM_TEST_SIZE 1024
 
 typedef struct
@@ -345,6 +544,9 @@ static NV_STATUS random_test(NvU32 iters, NvU32 seed, bool verbose)
 NV_STATUS uvm_test_range_allocator_sanity(UVM_TEST_RANGE_ALLOCATOR_SANITY_PARAMS *params, struct file *filp)
 {
     TEST_CHECK_RET(basic_test() == NV_OK);
+    TEST_CHECK_RET(best_fit_test() == NV_OK);
+    TEST_CHECK_RET(aligned_fit_test() == NV_OK);
+    TEST_CHECK_RET(fragmentation_test(params->verbose > 0) == NV_OK);
     TEST_CHECK_RET(random_test(params->iters, params->seed, params->verbose > 0) == NV_OK);
 
     return NV_OK;
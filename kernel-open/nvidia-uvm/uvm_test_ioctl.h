@@ -254,6 +254,7 @@ typedef struct
 #define UVM_TEST_PAGE_TREE                               UVM_TEST_IOCTL_BASE(10)
 typedef struct
 {
+    NvBool    verbose;                      // In
     NV_STATUS rmStatus;                     // Out
 } UVM_TEST_PAGE_TREE_PARAMS;
 
@@ -316,6 +317,7 @@ typedef struct
 typedef struct
 {
     NV_STATUS rmStatus;               // Out
+    NvBool    verbose;                // In
 } UVM_TEST_TRACKER_SANITY_PARAMS;
 
 #define UVM_TEST_PUSH_SANITY                             UVM_TEST_IOCTL_BASE(13)
@@ -987,7 +989,9 @@ typedef enum
 
 // This ioctl returns the thrashing mitigation parameters on the current VA
 // space. Note that these values may change after a simulated/emulated GPU is
-// registered on the VA space.
+// registered on the VA space, and over time if uvm_perf_thrashing_auto_tune is
+// enabled and the policy has not been overridden with
+// UVM_TEST_SET_PAGE_THRASHING_POLICY.
 #define UVM_TEST_GET_PAGE_THRASHING_POLICY               UVM_TEST_IOCTL_BASE(62)
 typedef struct
 {
@@ -996,6 +1000,8 @@ typedef struct
     NvU64                           pin_ns                           NV_ALIGN_BYTES(8); // Out
     NvBool                          map_remote_on_native_atomics_fault;                 // Out
     NV_STATUS                       rmStatus;                                           // Out
+    NvU64                           lapse_ns                         NV_ALIGN_BYTES(8); // Out
+    NvU32                           threshold;                                          // Out
 } UVM_TEST_GET_PAGE_THRASHING_POLICY_PARAMS;
 
 #define UVM_TEST_SET_PAGE_THRASHING_POLICY               UVM_TEST_IOCTL_BASE(63)
@@ -1362,6 +1368,10 @@ typedef struct
     NvU64     hmm_length              NV_ALIGN_BYTES(8); // In
     NvU64     uvm_address             NV_ALIGN_BYTES(8); // In
     NvU64     uvm_length              NV_ALIGN_BYTES(8); // In
+
+    // Rate at which HMM va_blocks covering [hmm_address, hmm_address +
+    // hmm_length) were found or created, walking the range in order.
+    NvU64     find_create_pages_per_sec NV_ALIGN_BYTES(8); // Out
     NV_STATUS rmStatus;                                  // Out
 } UVM_TEST_HMM_SANITY_PARAMS;
 
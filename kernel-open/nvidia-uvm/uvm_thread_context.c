@@ -26,6 +26,7 @@
 
 #include "uvm_linux.h"
 #include "uvm_common.h"
+#include "uvm_procfs.h"
 
 // Thread local storage implementation.
 //
@@ -53,6 +54,15 @@
 // Both the table and array entries are cache aligned to avoid false sharing
 // overheads due to cache thrashing between concurrent operations on separate
 // thread contexts.
+//
+// Lookups of thread contexts stored in a red-black tree would otherwise take
+// the tree lock every time. To avoid that, every CPU remembers the last thread
+// context found in a tree, together with the value of the table entry's
+// tree_removals counter at the time of the lookup. A thread context can only be
+// removed by its own task (or during global teardown), and every removal from
+// the tree bumps tree_removals, so an unchanged counter proves that the cached
+// thread context is still live. The per-CPU cache is checked before the table,
+// which remains the authoritative store.
 
 #define UVM_THREAD_CONTEXT_ARRAY_SIZE 8
 
@@ -84,8 +94,33 @@ typedef struct  {
     // Spinlock protecting the tree. A raw lock is chosen because UVM locks
     // rely on thread context information to be available for lock tracking.
     spinlock_t tree_lock;
+
+    // Number of removals from the tree. Written under tree_lock, read without
+    // it to validate the per-CPU lookup cache.
+    unsigned long tree_removals;
 } ____cacheline_aligned_in_smp uvm_thread_context_table_entry_t;
 
+// Per CPU cache of the last thread context found in a table entry's tree, and
+// lookup statistics. Only accessed in non-interrupt paths, with preemption
+// disabled.
+typedef struct
+{
+    struct task_struct *task;
+
+    uvm_thread_context_t *thread_context;
+
+    uvm_thread_context_table_entry_t *table_entry;
+
+    // Value of table_entry->tree_removals when the cache was filled
+    unsigned long tree_removals;
+
+    // Lookups satisfied by this cache, by the lock-free array, and by the
+    // locked tree search, respectively
+    NvU64 cache_hits;
+    NvU64 array_hits;
+    NvU64 tree_lookups;
+} uvm_thread_context_lookup_cache_t;
+
 // Global data structure containing all the active thread contexts
 static uvm_thread_context_table_entry_t g_thread_context_table[UVM_THREAD_CONTEXT_TABLE_SIZE];
 
@@ -98,6 +133,11 @@ static DEFINE_PER_CPU(uvm_thread_context_wrapper_t, interrupt_thread_context_wra
 // allocates the array when locking for the first time.
 static DEFINE_PER_CPU(uvm_thread_context_lock_acquired_t, interrupt_thread_context_lock_acquired);
 
+// Per CPU lookup cache, used in the non-interrupt path. Zero initialized.
+static DEFINE_PER_CPU(uvm_thread_context_lookup_cache_t, thread_context_lookup_cache);
+
+static struct proc_dir_entry *g_thread_context_procfs_file;
+
 static void thread_context_non_interrupt_remove(uvm_thread_context_t *thread_context,
                                                 uvm_thread_context_table_entry_t *thread_context_entry);
 
@@ -187,6 +227,54 @@ void uvm_thread_context_global_exit(void)
     g_thread_context_table_initialized = false;
 }
 
+static int nv_procfs_read_thread_context_stats(struct seq_file *s, void *v)
+{
+    NvU64 cache_hits = 0;
+    NvU64 array_hits = 0;
+    NvU64 tree_lookups = 0;
+    int cpu;
+
+    // The per-CPU counters are read without synchronization, so the totals are
+    // not a consistent snapshot.
+    for_each_possible_cpu(cpu) {
+        uvm_thread_context_lookup_cache_t *cache = &per_cpu(thread_context_lookup_cache, cpu);
+
+        cache_hits += READ_ONCE(cache->cache_hits);
+        array_hits += READ_ONCE(cache->array_hits);
+        tree_lookups += READ_ONCE(cache->tree_lookups);
+    }
+
+    UVM_SEQ_OR_DBG_PRINT(s, "cache_hits      %llu\n", cache_hits);
+    UVM_SEQ_OR_DBG_PRINT(s, "array_hits      %llu\n", array_hits);
+    UVM_SEQ_OR_DBG_PRINT(s, "tree_lookups    %llu\n", tree_lookups);
+
+    return 0;
+}
+
+static int nv_procfs_read_thread_context_stats_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_thread_context_stats(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(thread_context_stats_entry);
+
+NV_STATUS uvm_thread_context_procfs_init(void)
+{
+    if (!uvm_procfs_is_debug_enabled())
+        return NV_OK;
+
+    // The file is removed along with the rest of the UVM procfs directory in
+    // uvm_procfs_exit().
+    g_thread_context_procfs_file = NV_CREATE_PROC_FILE("thread_context_stats",
+                                                       uvm_procfs_get_cpu_base_dir(),
+                                                       thread_context_stats_entry,
+                                                       NULL);
+    if (!g_thread_context_procfs_file)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    return NV_OK;
+}
+
 static uvm_thread_context_t *thread_context_non_interrupt_tree_search(struct rb_root *root, struct task_struct *task)
 {
     struct rb_node *node = root->rb_node;
@@ -330,12 +418,68 @@ static uvm_thread_context_table_entry_t *thread_context_non_interrupt_table_entr
     return g_thread_context_table + table_index;
 }
 
+// Return the thread context of the current task if it is the one cached by
+// this CPU, and the cached thread context has not been removed since.
+static uvm_thread_context_t *thread_context_non_interrupt_cache_lookup(void)
+{
+    uvm_thread_context_lookup_cache_t *cache;
+    uvm_thread_context_t *thread_context = NULL;
+
+    cache = &get_cpu_var(thread_context_lookup_cache);
+
+    if (cache->task == current &&
+        READ_ONCE(cache->table_entry->tree_removals) == cache->tree_removals) {
+        thread_context = cache->thread_context;
+        cache->cache_hits++;
+    }
+
+    put_cpu_var(thread_context_lookup_cache);
+
+    return thread_context;
+}
+
+static void thread_context_non_interrupt_cache_array_hit(void)
+{
+    get_cpu_var(thread_context_lookup_cache).array_hits++;
+    put_cpu_var(thread_context_lookup_cache);
+}
+
+// Must be called with the tree lock of table_entry held
+static void thread_context_non_interrupt_cache_fill(uvm_thread_context_table_entry_t *table_entry,
+                                                    uvm_thread_context_t *thread_context)
+{
+    uvm_thread_context_lookup_cache_t *cache;
+
+    cache = &get_cpu_var(thread_context_lookup_cache);
+
+    cache->tree_lookups++;
+
+    if (thread_context != NULL) {
+        cache->task = current;
+        cache->thread_context = thread_context;
+        cache->table_entry = table_entry;
+        cache->tree_removals = table_entry->tree_removals;
+    }
+
+    put_cpu_var(thread_context_lookup_cache);
+}
+
 static uvm_thread_context_t *thread_context_non_interrupt(void)
 {
     unsigned long flags;
     size_t i, array_index;
     uvm_thread_context_t *thread_context;
-    uvm_thread_context_table_entry_t *table_entry = thread_context_non_interrupt_table_entry(&array_index);
+    uvm_thread_context_table_entry_t *table_entry;
+
+    thread_context = thread_context_non_interrupt_cache_lookup();
+    if (thread_context != NULL) {
+        UVM_ASSERT(thread_context->task == current);
+        UVM_ASSERT(thread_context->array_index == UVM_THREAD_CONTEXT_ARRAY_SIZE);
+
+        return thread_context;
+    }
+
+    table_entry = thread_context_non_interrupt_table_entry(&array_index);
 
     for (i = array_index; i < (UVM_THREAD_CONTEXT_ARRAY_SIZE + array_index); i++) {
         size_t curr_array_index = i % UVM_THREAD_CONTEXT_ARRAY_SIZE;
@@ -347,12 +491,15 @@ static uvm_thread_context_t *thread_context_non_interrupt(void)
             UVM_ASSERT(thread_context != NULL);
             UVM_ASSERT(thread_context->array_index == curr_array_index);
 
+            thread_context_non_interrupt_cache_array_hit();
+
             return thread_context;
         }
     }
 
     spin_lock_irqsave(&table_entry->tree_lock, flags);
     thread_context = thread_context_non_interrupt_tree_search(&table_entry->tree, current);
+    thread_context_non_interrupt_cache_fill(table_entry, thread_context);
     spin_unlock_irqrestore(&table_entry->tree_lock, flags);
 
     return thread_context;
@@ -540,7 +687,7 @@ static void thread_context_non_interrupt_remove(uvm_thread_context_t *thread_con
         // A more detailed explanation about why the memory barrier is needed
         // before an atomic write, and why we are not using a different flavor
         // of atomic write such as atomic64_set_release, can be found in
-        // uvm_gpu_semaphore.c:update_completed_value_locked().
+        // uvm_gpu_semaphore.c:update_completed_value().
         smp_mb__before_atomic();
         atomic64_set(&array_entry->task, 0);
     }
@@ -549,6 +696,9 @@ static void thread_context_non_interrupt_remove(uvm_thread_context_t *thread_con
 
         spin_lock_irqsave(&table_entry->tree_lock, flags);
         rb_erase(&thread_context->node, &table_entry->tree);
+
+        // Invalidate any per-CPU lookup cache pointing to this table entry
+        WRITE_ONCE(table_entry->tree_removals, table_entry->tree_removals + 1);
         spin_unlock_irqrestore(&table_entry->tree_lock, flags);
     }
 
@@ -93,6 +93,11 @@ bool uvm_thread_context_global_initialized(void);
 void uvm_thread_context_global_init(void);
 void uvm_thread_context_global_exit(void);
 
+// Create the cpu/thread_context_stats procfs file, which reports how current
+// thread context lookups were resolved: by the per-CPU cache, the lock-free
+// array, or the locked tree search. Must be called after uvm_procfs_init().
+NV_STATUS uvm_thread_context_procfs_init(void);
+
 // Retrieve the current thread context. Asserts if it does not exist.
 uvm_thread_context_t *uvm_thread_context(void);
 
@@ -743,19 +743,10 @@ static void record_gpu_fault_instance(uvm_gpu_t *gpu,
     uvm_tools_record_event(va_space, &entry);
 }
 
-static void uvm_tools_record_fault(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data)
+// Caller must hold the tools lock in read mode
+static void record_fault(uvm_va_space_t *va_space, uvm_perf_event_data_t *event_data)
 {
-    uvm_va_space_t *va_space = event_data->fault.space;
-
-    UVM_ASSERT(event_id == UVM_PERF_EVENT_FAULT);
-    UVM_ASSERT(event_data->fault.space);
-
-    uvm_assert_rwsem_locked(&va_space->lock);
-    uvm_assert_rwsem_locked(&va_space->perf_events.lock);
-    UVM_ASSERT(va_space->tools.enabled);
-
-    uvm_down_read(&va_space->tools.lock);
-    UVM_ASSERT(tools_is_fault_callback_needed(va_space));
+    UVM_ASSERT(event_data->fault.space == va_space);
 
     if (UVM_ID_IS_CPU(event_data->fault.proc_id)) {
         if (tools_is_event_enabled(va_space, UvmEventTypeCpuFault)) {
@@ -814,9 +805,35 @@ static void uvm_tools_record_fault(uvm_perf_event_t event_id, uvm_perf_event_dat
         if (tools_is_counter_enabled(va_space, UvmCounterNameGpuPageFaultCount))
             uvm_tools_inc_counter(va_space, UvmCounterNameGpuPageFaultCount, 1, uvm_gpu_uuid(gpu));
     }
+}
+
+static void uvm_tools_record_fault_batch(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data, NvU32 count)
+{
+    uvm_va_space_t *va_space = event_data[0].fault.space;
+    NvU32 i;
+
+    UVM_ASSERT(event_id == UVM_PERF_EVENT_FAULT);
+    UVM_ASSERT(va_space);
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+    uvm_assert_rwsem_locked(&va_space->perf_events.lock);
+    UVM_ASSERT(va_space->tools.enabled);
+
+    // Take the tools lock once for the whole batch
+    uvm_down_read(&va_space->tools.lock);
+    UVM_ASSERT(tools_is_fault_callback_needed(va_space));
+
+    for (i = 0; i < count; ++i)
+        record_fault(va_space, &event_data[i]);
+
     uvm_up_read(&va_space->tools.lock);
 }
 
+static void uvm_tools_record_fault(uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data)
+{
+    uvm_tools_record_fault_batch(event_id, event_data, 1);
+}
+
 static void add_pending_event_for_channel(uvm_channel_t *channel)
 {
     uvm_assert_spinlock_locked(&g_tools_channel_list_lock);
@@ -1436,6 +1453,44 @@ void uvm_tools_record_throttling_end(uvm_va_space_t *va_space, NvU64 address, uv
     uvm_up_read(&va_space->tools.lock);
 }
 
+void uvm_tools_record_migration_stage(uvm_va_space_t *va_space,
+                                      UvmEventMigrationStage stage,
+                                      uvm_processor_id_t dst_id,
+                                      NvU64 address,
+                                      NvU64 size,
+                                      NvU64 begin_time_stamp,
+                                      NvU64 end_time_stamp)
+{
+    UVM_ASSERT(stage > UvmEventMigrationStageInvalid && stage < UvmEventNumMigrationStages);
+    UVM_ASSERT(UVM_ID_IS_VALID(dst_id));
+    UVM_ASSERT(size > 0);
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    if (!va_space->tools.enabled)
+        return;
+
+    uvm_down_read(&va_space->tools.lock);
+    if (tools_is_event_enabled(va_space, UvmEventTypeMigrationStage)) {
+        UvmEventEntry entry;
+        UvmEventMigrationStageInfo *info = &entry.eventData.migrationStage;
+        memset(&entry, 0, sizeof(entry));
+
+        info->eventType      = UvmEventTypeMigrationStage;
+        info->stage          = stage;
+        info->dstIndex       = uvm_id_value(dst_id);
+        info->blocks         = (UVM_ALIGN_UP(address + size, UVM_VA_BLOCK_SIZE) -
+                                UVM_ALIGN_DOWN(address, UVM_VA_BLOCK_SIZE)) / UVM_VA_BLOCK_SIZE;
+        info->address        = address;
+        info->size           = size;
+        info->beginTimeStamp = begin_time_stamp;
+        info->endTimeStamp   = end_time_stamp;
+
+        uvm_tools_record_event(va_space, &entry);
+    }
+    uvm_up_read(&va_space->tools.lock);
+}
+
 static void record_map_remote_events(void *args)
 {
     block_map_remote_data_t *block_map_remote = (block_map_remote_data_t *)args;
@@ -1701,9 +1756,10 @@ static NV_STATUS tools_update_perf_events_callbacks(uvm_va_space_t *va_space)
 
     if (tools_is_fault_callback_needed(va_space)) {
         if (!uvm_perf_is_event_callback_registered(&va_space->perf_events, UVM_PERF_EVENT_FAULT, uvm_tools_record_fault)) {
-            status = uvm_perf_register_event_callback_locked(&va_space->perf_events,
-                                                             UVM_PERF_EVENT_FAULT,
-                                                             uvm_tools_record_fault);
+            status = uvm_perf_register_event_batch_callback_locked(&va_space->perf_events,
+                                                                   UVM_PERF_EVENT_FAULT,
+                                                                   uvm_tools_record_fault,
+                                                                   uvm_tools_record_fault_batch);
 
             if (status != NV_OK)
                 return status;
@@ -77,6 +77,16 @@ void uvm_tools_record_throttling_start(uvm_va_space_t *va_space, NvU64 address,
 
 void uvm_tools_record_throttling_end(uvm_va_space_t *va_space, NvU64 address, uvm_processor_id_t processor);
 
+// Record a stage of a UvmMigrate call covering [address, address + size).
+// Requires the VA space lock to be held.
+void uvm_tools_record_migration_stage(uvm_va_space_t *va_space,
+                                      UvmEventMigrationStage stage,
+                                      uvm_processor_id_t dst_id,
+                                      NvU64 address,
+                                      NvU64 size,
+                                      NvU64 begin_time_stamp,
+                                      NvU64 end_time_stamp);
+
 void uvm_tools_record_map_remote(uvm_va_block_t *va_block,
                                  uvm_push_t *push,
                                  uvm_processor_id_t processor,
@@ -53,14 +53,33 @@ uvm_tracker_entry_t *uvm_tracker_get_entries(uvm_tracker_t *tracker)
     }
 }
 
-static uvm_tracker_entry_t *get_new_entry(uvm_tracker_t *tracker)
+// Tracker entries are kept sorted by channel. This makes looking up the entry
+// for a channel a binary search, and merging two trackers a single linear pass
+// over both, which matters for the large trackers accumulated by operations
+// spanning many GPUs and channels.
+static bool entry_channel_before(uvm_channel_t *a, uvm_channel_t *b)
 {
-    NV_STATUS status = uvm_tracker_reserve(tracker, 1);
-    if (status != NV_OK)
-        return NULL;
-    UVM_ASSERT(tracker->size < tracker->max_size);
+    return (uintptr_t)a < (uintptr_t)b;
+}
+
+// Return the index of the first entry whose channel is not before the given
+// channel, or tracker->size if there is none.
+static NvU32 find_entry_index(uvm_tracker_t *tracker, uvm_channel_t *channel)
+{
+    uvm_tracker_entry_t *entries = uvm_tracker_get_entries(tracker);
+    NvU32 first = 0;
+    NvU32 outer = tracker->size;
+
+    while (first < outer) {
+        NvU32 mid = first + (outer - first) / 2;
+
+        if (entry_channel_before(entries[mid].channel, channel))
+            first = mid + 1;
+        else
+            outer = mid;
+    }
 
-    return &uvm_tracker_get_entries(tracker)[tracker->size++];
+    return first;
 }
 
 NV_STATUS uvm_tracker_init_from(uvm_tracker_t *dst, uvm_tracker_t *src)
@@ -136,20 +155,24 @@ NV_STATUS uvm_tracker_add_push(uvm_tracker_t *tracker, uvm_push_t *push)
 
 NV_STATUS uvm_tracker_add_entry(uvm_tracker_t *tracker, uvm_tracker_entry_t *new_entry)
 {
-    uvm_tracker_entry_t *tracker_entry;
+    uvm_tracker_entry_t *entries = uvm_tracker_get_entries(tracker);
+    NvU32 index = find_entry_index(tracker, new_entry->channel);
+    NV_STATUS status;
 
-    for_each_tracker_entry(tracker_entry, tracker) {
-        if (tracker_entry->channel == new_entry->channel) {
-            tracker_entry->value = max(tracker_entry->value, new_entry->value);
-            return NV_OK;
-        }
+    if (index < tracker->size && entries[index].channel == new_entry->channel) {
+        entries[index].value = max(entries[index].value, new_entry->value);
+        return NV_OK;
     }
 
-    tracker_entry = get_new_entry(tracker);
-    if (tracker_entry == NULL)
-        return NV_ERR_NO_MEMORY;
+    status = uvm_tracker_reserve(tracker, 1);
+    if (status != NV_OK)
+        return status;
 
-    *tracker_entry = *new_entry;
+    // Reserving might have moved the entries
+    entries = uvm_tracker_get_entries(tracker);
+    memmove(&entries[index + 1], &entries[index], (tracker->size - index) * sizeof(*entries));
+    entries[index] = *new_entry;
+    ++tracker->size;
 
     return NV_OK;
 }
@@ -175,49 +198,82 @@ void uvm_tracker_overwrite_with_push(uvm_tracker_t *tracker, uvm_push_t *push)
     uvm_tracker_overwrite_with_entry(tracker, &entry);
 }
 
-static NV_STATUS reserve_for_entries_from_tracker(uvm_tracker_t *dst, uvm_tracker_t *src)
+// Count the entries of src tracking channels that dst doesn't track yet
+static NvU32 count_new_entries_from_tracker(uvm_tracker_t *dst, uvm_tracker_t *src)
 {
-    NvU32 needed_free_entries = 0;
-    uvm_tracker_entry_t *src_entry, *dst_entry;
-
-    for_each_tracker_entry(src_entry, src) {
-        bool found = false;
-        for_each_tracker_entry(dst_entry, dst) {
-            if (dst_entry->channel == src_entry->channel) {
-                found = true;
-                break;
-            }
-        }
-        if (!found)
-            needed_free_entries++;
+    uvm_tracker_entry_t *dst_entries = uvm_tracker_get_entries(dst);
+    uvm_tracker_entry_t *src_entries = uvm_tracker_get_entries(src);
+    NvU32 new_entries = 0;
+    NvU32 d = 0;
+    NvU32 s;
+
+    for (s = 0; s < src->size; ++s) {
+        while (d < dst->size && entry_channel_before(dst_entries[d].channel, src_entries[s].channel))
+            ++d;
+
+        if (d == dst->size || dst_entries[d].channel != src_entries[s].channel)
+            ++new_entries;
     }
 
-    return uvm_tracker_reserve(dst, needed_free_entries);
+    return new_entries;
 }
 
 NV_STATUS uvm_tracker_add_tracker(uvm_tracker_t *dst, uvm_tracker_t *src)
 {
     NV_STATUS status;
-    uvm_tracker_entry_t *src_entry;
+    uvm_tracker_entry_t *dst_entries;
+    uvm_tracker_entry_t *src_entries;
+    NvU32 new_entries;
+    NvU32 d, s, out;
 
-    if (src == dst)
+    if (src == dst || uvm_tracker_is_empty(src))
         return NV_OK;
 
-    status = uvm_tracker_reserve(dst, src->size);
+    new_entries = count_new_entries_from_tracker(dst, src);
+    status = uvm_tracker_reserve(dst, new_entries);
     if (status == NV_ERR_NO_MEMORY) {
         uvm_tracker_remove_completed(dst);
         uvm_tracker_remove_completed(src);
-        status = reserve_for_entries_from_tracker(dst, src);
+        new_entries = count_new_entries_from_tracker(dst, src);
+        status = uvm_tracker_reserve(dst, new_entries);
     }
     if (status != NV_OK) {
         return status;
     }
 
-    for_each_tracker_entry(src_entry, src) {
-        status = uvm_tracker_add_entry(dst, src_entry);
-        UVM_ASSERT_MSG(status == NV_OK, "Expected success with reserved memory but got error %d\n", status);
+    // Nothing to merge with, just copy src. The space is already reserved so
+    // this can't fail.
+    if (uvm_tracker_is_empty(dst))
+        return uvm_tracker_overwrite(dst, src);
+
+    // Merge both sorted arrays in place, starting from the back of dst so that
+    // no dst entry is overwritten before it's been moved.
+    dst_entries = uvm_tracker_get_entries(dst);
+    src_entries = uvm_tracker_get_entries(src);
+    d = dst->size;
+    s = src->size;
+    out = dst->size + new_entries;
+
+    while (s > 0) {
+        uvm_tracker_entry_t *src_entry = &src_entries[s - 1];
+
+        if (d > 0 && !entry_channel_before(dst_entries[d - 1].channel, src_entry->channel)) {
+            dst_entries[--out] = dst_entries[--d];
+            if (dst_entries[out].channel == src_entry->channel) {
+                dst_entries[out].value = max(dst_entries[out].value, src_entry->value);
+                --s;
+            }
+        }
+        else {
+            dst_entries[--out] = *src_entry;
+            --s;
+        }
     }
 
+    // The remaining dst entries are already in place
+    UVM_ASSERT(out == d);
+    dst->size += new_entries;
+
     return NV_OK;
 }
 
@@ -407,21 +463,21 @@ NV_STATUS uvm_tracker_query(uvm_tracker_t *tracker)
 
 void uvm_tracker_remove_completed(uvm_tracker_t *tracker)
 {
-    NvU32 i = 0;
-
     uvm_tracker_entry_t *entries = uvm_tracker_get_entries(tracker);
+    NvU32 i;
+    NvU32 remaining = 0;
 
-    // Keep removing completed entries until we run out of entries
-    while (i < tracker->size) {
-        if (uvm_tracker_is_entry_completed(&entries[i])) {
-            --tracker->size;
-            if (i != tracker->size)
-                entries[i] = entries[tracker->size];
-        }
-        else {
-            ++i;
-        }
+    // Compact the pending entries in a single pass, preserving their order
+    for (i = 0; i < tracker->size; ++i) {
+        if (uvm_tracker_is_entry_completed(&entries[i]))
+            continue;
+
+        if (i != remaining)
+            entries[remaining] = entries[i];
+        ++remaining;
     }
+
+    tracker->size = remaining;
 }
 
 bool uvm_tracker_is_completed(uvm_tracker_t *tracker)
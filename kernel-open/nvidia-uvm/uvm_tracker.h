@@ -55,6 +55,9 @@ typedef struct
         uvm_tracker_entry_t *dynamic_entries;
     };
 
+    // The entries are kept sorted by channel, with at most one entry per
+    // channel.
+
     // Number of used entries in the tracker
     NvU32 size;
 
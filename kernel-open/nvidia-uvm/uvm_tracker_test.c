@@ -414,6 +414,87 @@ done:
     return status;
 }
 
+// Merge trackers covering all the channels of all the GPUs, as done when
+// operations span many GPUs, and time it.
+static NV_STATUS test_tracker_add_tracker_perf(uvm_va_space_t *va_space, bool verbose)
+{
+    uvm_gpu_t *gpu;
+    uvm_tracker_t src_trackers[2];
+    uvm_tracker_t dst_tracker;
+    uvm_tracker_entry_t *entry_iter;
+    uvm_tracker_entry_t *prev_entry = NULL;
+    NV_STATUS status = NV_OK;
+    NvU32 count = 0;
+    NvU32 i;
+    NvU64 start_time;
+    NvU64 elapsed_time;
+    const NvU32 iters = 1000;
+
+    uvm_tracker_init(&src_trackers[0]);
+    uvm_tracker_init(&src_trackers[1]);
+    uvm_tracker_init(&dst_tracker);
+
+    // Spread the channels across two trackers, with the channels of the first
+    // GPU present in both so that the merge also has to combine entries.
+    for_each_va_space_gpu(gpu, va_space) {
+        uvm_channel_pool_t *pool;
+        bool first_gpu = count == 0;
+
+        uvm_for_each_pool(pool, gpu->channel_manager) {
+            uvm_channel_t *channel;
+
+            uvm_for_each_channel_in_pool(channel, pool) {
+                uvm_tracker_entry_t entry;
+
+                entry.channel = channel;
+                entry.value = uvm_channel_update_completed_value(channel);
+
+                TEST_NV_CHECK_GOTO(uvm_tracker_add_entry(&src_trackers[count & 1], &entry), done);
+                if (first_gpu)
+                    TEST_NV_CHECK_GOTO(uvm_tracker_add_entry(&src_trackers[(count & 1) ^ 1], &entry), done);
+
+                ++count;
+            }
+        }
+    }
+
+    start_time = NV_GETTIME();
+    for (i = 0; i < iters; ++i) {
+        uvm_tracker_clear(&dst_tracker);
+        TEST_NV_CHECK_GOTO(uvm_tracker_add_tracker(&dst_tracker, &src_trackers[0]), done);
+        TEST_NV_CHECK_GOTO(uvm_tracker_add_tracker(&dst_tracker, &src_trackers[1]), done);
+
+        // Merging a tracker that's already fully contained is a common case
+        TEST_NV_CHECK_GOTO(uvm_tracker_add_tracker(&dst_tracker, &src_trackers[0]), done);
+    }
+    elapsed_time = NV_GETTIME() - start_time;
+
+    TEST_CHECK_GOTO(dst_tracker.size == count, done);
+
+    // Each channel is tracked exactly once
+    for_each_tracker_entry(entry_iter, &dst_tracker) {
+        TEST_CHECK_GOTO(!prev_entry || prev_entry->channel != entry_iter->channel, done);
+        prev_entry = entry_iter;
+    }
+
+    if (verbose) {
+        UVM_TEST_PRINT("%u x 3 merges of trackers with %u/%u entries into %u entries: %llu ns/merge\n",
+                       iters,
+                       src_trackers[0].size,
+                       src_trackers[1].size,
+                       count,
+                       elapsed_time / (iters * 3));
+    }
+
+    TEST_NV_CHECK_GOTO(assert_tracker_is_completed(&dst_tracker), done);
+
+done:
+    uvm_tracker_deinit(&src_trackers[0]);
+    uvm_tracker_deinit(&src_trackers[1]);
+    uvm_tracker_deinit(&dst_tracker);
+    return status;
+}
+
 NV_STATUS uvm_test_tracker_sanity(UVM_TEST_TRACKER_SANITY_PARAMS *params, struct file *filp)
 {
     NV_STATUS status;
@@ -437,6 +518,10 @@ NV_STATUS uvm_test_tracker_sanity(UVM_TEST_TRACKER_SANITY_PARAMS *params, struct
     if (status != NV_OK)
         goto done;
 
+    status = test_tracker_add_tracker_perf(va_space, params->verbose);
+    if (status != NV_OK)
+        goto done;
+
 done:
     uvm_va_space_up_read_rm(va_space);
 
@@ -354,6 +354,7 @@ typedef enum
     UvmEventTypeThrottlingEnd              = 12,
     UvmEventTypeMapRemote                  = 13,
     UvmEventTypeEviction                   = 14,
+    UvmEventTypeMigrationStage             = 15,
 
     // ---- Add new values above this line
     UvmEventNumTypes,
@@ -386,6 +387,7 @@ typedef enum
 #define UVM_EVENT_ENABLE_THROTTLING_END               ((NvU64)1 << UvmEventTypeThrottlingEnd)
 #define UVM_EVENT_ENABLE_MAP_REMOTE                   ((NvU64)1 << UvmEventTypeMapRemote)
 #define UVM_EVENT_ENABLE_EVICTION                     ((NvU64)1 << UvmEventTypeEviction)
+#define UVM_EVENT_ENABLE_MIGRATION_STAGE              ((NvU64)1 << UvmEventTypeMigrationStage)
 #define UVM_EVENT_ENABLE_TEST_ACCESS_COUNTER          ((NvU64)1 << UvmEventTypeTestAccessCounter)
 
 //------------------------------------------------------------------------------
@@ -919,6 +921,44 @@ typedef struct
     NvU64 timeStamp;        // cpu time stamp when eviction starts on the cpu
 } UvmEventEvictionInfo;
 
+//------------------------------------------------------------------------------
+// Stages of a UvmMigrate call. The passes only submit the copy and mapping work
+// of each VA block, which the GPUs execute while the following blocks are
+// processed. The wait stage is the time a synchronous migration spends waiting
+// for the work that was still pending once all of it had been submitted.
+//------------------------------------------------------------------------------
+typedef enum
+{
+    UvmEventMigrationStageInvalid     = 0,
+    UvmEventMigrationStageFirstPass   = 1,
+    UvmEventMigrationStageSecondPass  = 2,
+    UvmEventMigrationStageWait        = 3,
+    UvmEventNumMigrationStages
+} UvmEventMigrationStage;
+
+typedef struct
+{
+    //
+    // eventType has to be the 1st argument of this structure.
+    // Setting eventType = UvmEventTypeMigrationStage helps to identify event
+    // data in a queue.
+    //
+    NvU8 eventType;
+    NvU8 stage;             // stage of the migration (UvmEventMigrationStage)
+    NvU8 dstIndex;          // index of the cpu/gpu the memory is migrated to
+    //
+    // This structure is shared between UVM kernel and tools.
+    // Manually padding the structure so that compiler options like pragma pack
+    // or malign-double will have no effect on the field offsets
+    //
+    NvU8  padding8bits;
+    NvU32 blocks;           // number of VA blocks covered by the stage
+    NvU64 address;          // start address of the migrated range
+    NvU64 size;             // size of the migrated range
+    NvU64 beginTimeStamp;   // cpu time stamp when the stage starts
+    NvU64 endTimeStamp;     // cpu time stamp when the stage ends
+} UvmEventMigrationStageInfo;
+
 // TODO: Bug 1870362: [uvm] Provide virtual address and processor index in
 // AccessCounter events
 //
@@ -1003,6 +1043,7 @@ typedef struct
             UvmEventThrottlingEndInfo throttlingEnd;
             UvmEventMapRemoteInfo mapRemote;
             UvmEventEvictionInfo eviction;
+            UvmEventMigrationStageInfo migrationStage;
         } eventData;
 
         union
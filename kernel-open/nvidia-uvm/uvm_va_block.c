@@ -38,6 +38,7 @@
 #include "uvm_mem.h"
 #include "uvm_gpu_access_counters.h"
 #include "uvm_va_space_mm.h"
+#include "uvm_procfs.h"
 #include "uvm_test_ioctl.h"
 
 
@@ -55,6 +56,28 @@ static NvU64 uvm_perf_authorized_cpu_fault_tracking_window_ns = 300000;
 static struct kmem_cache *g_uvm_va_block_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_block_gpu_state_cache __read_mostly;
 static struct kmem_cache *g_uvm_page_mask_cache __read_mostly;
+static struct kmem_cache *g_uvm_va_block_gpu_pte_bits_cache __read_mostly;
+
+// Page mask used in place of the per-GPU masks that are not allocated
+static const uvm_page_mask_t g_uvm_va_block_empty_page_mask;
+
+// Footprint of the per-GPU block state, reported in procfs
+static struct
+{
+    // Number of allocated uvm_va_block_gpu_state_t
+    atomic64_t gpu_states;
+
+    // Number of allocated uvm_va_block_gpu_state_t::resident masks
+    atomic64_t resident_masks;
+
+    // Number of allocated uvm_va_block_gpu_state_t::pte_bits arrays
+    atomic64_t pte_bits;
+
+    // Number of allocated uvm_va_block_gpu_state_t::evicted masks
+    atomic64_t evicted_masks;
+
+    struct proc_dir_entry *procfs_file;
+} g_uvm_va_block_footprint;
 static struct kmem_cache *g_uvm_va_block_context_cache __read_mostly;
 
 static int uvm_fault_force_sysmem __read_mostly = 0;
@@ -324,6 +347,70 @@ static block_phys_page_t block_phys_page(uvm_processor_id_t processor, uvm_page_
     return (block_phys_page_t){ processor, page_index };
 }
 
+// Number of GPU states without a given lazily-allocated member. The counters are
+// read independently, so the difference may be transiently negative.
+#define FOOTPRINT_SAVED(gpu_states, allocated) ((gpu_states) > (allocated) ? (gpu_states) - (allocated) : 0)
+
+static int nv_procfs_read_va_block_footprint(struct seq_file *s, void *v)
+{
+    NvU64 gpu_states = atomic64_read(&g_uvm_va_block_footprint.gpu_states);
+    NvU64 resident_masks = atomic64_read(&g_uvm_va_block_footprint.resident_masks);
+    NvU64 pte_bits = atomic64_read(&g_uvm_va_block_footprint.pte_bits);
+    NvU64 evicted_masks = atomic64_read(&g_uvm_va_block_footprint.evicted_masks);
+    const size_t pte_bits_size = sizeof(uvm_page_mask_t) * UVM_PTE_BITS_GPU_MAX;
+
+    if (!uvm_down_read_trylock(&g_uvm_global.pm.lock))
+            return -EAGAIN;
+
+    UVM_SEQ_OR_DBG_PRINT(s, "gpu_states              %llu\n", gpu_states);
+    UVM_SEQ_OR_DBG_PRINT(s, "gpu_state_bytes         %llu\n", gpu_states * sizeof(uvm_va_block_gpu_state_t));
+    UVM_SEQ_OR_DBG_PRINT(s, "resident_masks          %llu\n", resident_masks);
+    UVM_SEQ_OR_DBG_PRINT(s, "resident_mask_bytes     %llu\n", resident_masks * sizeof(uvm_page_mask_t));
+    UVM_SEQ_OR_DBG_PRINT(s,
+                         "resident_mask_saved     %llu\n",
+                         FOOTPRINT_SAVED(gpu_states, resident_masks) * sizeof(uvm_page_mask_t));
+    UVM_SEQ_OR_DBG_PRINT(s, "pte_bits                %llu\n", pte_bits);
+    UVM_SEQ_OR_DBG_PRINT(s, "pte_bits_bytes          %llu\n", pte_bits * pte_bits_size);
+    UVM_SEQ_OR_DBG_PRINT(s, "pte_bits_saved          %llu\n", FOOTPRINT_SAVED(gpu_states, pte_bits) * pte_bits_size);
+    UVM_SEQ_OR_DBG_PRINT(s, "evicted_masks           %llu\n", evicted_masks);
+    UVM_SEQ_OR_DBG_PRINT(s, "evicted_mask_bytes      %llu\n", evicted_masks * sizeof(uvm_page_mask_t));
+    UVM_SEQ_OR_DBG_PRINT(s,
+                         "evicted_mask_saved      %llu\n",
+                         FOOTPRINT_SAVED(gpu_states, evicted_masks) * sizeof(uvm_page_mask_t));
+
+    uvm_up_read(&g_uvm_global.pm.lock);
+
+    return 0;
+}
+
+static int nv_procfs_read_va_block_footprint_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_va_block_footprint(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(va_block_footprint_entry);
+
+static NV_STATUS va_block_footprint_procfs_init(void)
+{
+    if (!uvm_procfs_is_debug_enabled())
+        return NV_OK;
+
+    g_uvm_va_block_footprint.procfs_file = NV_CREATE_PROC_FILE("va_block_footprint",
+                                                               uvm_procfs_get_cpu_base_dir(),
+                                                               va_block_footprint_entry,
+                                                               NULL);
+    if (!g_uvm_va_block_footprint.procfs_file)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    return NV_OK;
+}
+
+static void va_block_footprint_procfs_exit(void)
+{
+    uvm_procfs_destroy_entry(g_uvm_va_block_footprint.procfs_file);
+    g_uvm_va_block_footprint.procfs_file = NULL;
+}
+
 NV_STATUS uvm_va_block_init(void)
 {
     if (uvm_enable_builtin_tests)
@@ -342,16 +429,24 @@ NV_STATUS uvm_va_block_init(void)
     if (!g_uvm_page_mask_cache)
         return NV_ERR_NO_MEMORY;
 
+    g_uvm_va_block_gpu_pte_bits_cache = nv_kmem_cache_create("uvm_va_block_gpu_pte_bits",
+                                                             sizeof(uvm_page_mask_t) * UVM_PTE_BITS_GPU_MAX,
+                                                             0);
+    if (!g_uvm_va_block_gpu_pte_bits_cache)
+        return NV_ERR_NO_MEMORY;
+
     g_uvm_va_block_context_cache = NV_KMEM_CACHE_CREATE("uvm_va_block_context_t", uvm_va_block_context_t);
     if (!g_uvm_va_block_context_cache)
         return NV_ERR_NO_MEMORY;
 
-    return NV_OK;
+    return va_block_footprint_procfs_init();
 }
 
 void uvm_va_block_exit(void)
 {
+    va_block_footprint_procfs_exit();
     kmem_cache_destroy_safe(&g_uvm_va_block_context_cache);
+    kmem_cache_destroy_safe(&g_uvm_va_block_gpu_pte_bits_cache);
     kmem_cache_destroy_safe(&g_uvm_page_mask_cache);
     kmem_cache_destroy_safe(&g_uvm_va_block_gpu_state_cache);
     kmem_cache_destroy_safe(&g_uvm_va_block_cache);
@@ -811,6 +906,8 @@ static uvm_va_block_gpu_state_t *block_gpu_state_get_alloc(uvm_va_block_t *block
     if (!gpu_state)
         return NULL;
 
+    atomic64_inc(&g_uvm_va_block_footprint.gpu_states);
+
     gpu_state->chunks = uvm_kvmalloc_zero(block_num_gpu_chunks(block, gpu) * sizeof(gpu_state->chunks[0]));
     if (!gpu_state->chunks)
         goto error;
@@ -833,6 +930,7 @@ error:
             uvm_kvfree(gpu_state->chunks);
         uvm_cpu_chunk_gpu_mapping_free(block, gpu->id);
         kmem_cache_free(g_uvm_va_block_gpu_state_cache, gpu_state);
+        atomic64_dec(&g_uvm_va_block_footprint.gpu_states);
     }
     block->gpus[uvm_id_gpu_index(gpu->id)] = NULL;
 
@@ -1252,6 +1350,92 @@ static void uvm_page_mask_init_from_big_ptes(uvm_va_block_t *block,
     }
 }
 
+static const uvm_page_mask_t *block_gpu_resident_mask_get(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (!gpu_state->resident)
+        return &g_uvm_va_block_empty_page_mask;
+
+    return gpu_state->resident;
+}
+
+// Allocate the resident mask of the GPU state, if not allocated already
+static NV_STATUS block_gpu_resident_mask_alloc(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (gpu_state->resident)
+        return NV_OK;
+
+    gpu_state->resident = nv_kmem_cache_zalloc(g_uvm_page_mask_cache, NV_UVM_GFP_FLAGS);
+    if (!gpu_state->resident)
+        return NV_ERR_NO_MEMORY;
+
+    atomic64_inc(&g_uvm_va_block_footprint.resident_masks);
+
+    return NV_OK;
+}
+
+static void block_gpu_resident_mask_free(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (!gpu_state->resident)
+        return;
+
+    kmem_cache_free(g_uvm_page_mask_cache, gpu_state->resident);
+    gpu_state->resident = NULL;
+
+    atomic64_dec(&g_uvm_va_block_footprint.resident_masks);
+}
+
+// Free the resident mask of the GPU state if no page is resident anymore.
+//
+// Callers may keep pointers to the mask while they operate on the block, so
+// this is only done at the end of top-level operations.
+static void block_gpu_resident_mask_compact(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (gpu_state->resident && uvm_page_mask_empty(gpu_state->resident))
+        block_gpu_resident_mask_free(gpu_state);
+}
+
+static const uvm_page_mask_t *block_gpu_pte_bits_get(uvm_va_block_gpu_state_t *gpu_state, uvm_pte_bits_gpu_t pte_bit)
+{
+    if (!gpu_state->pte_bits)
+        return &g_uvm_va_block_empty_page_mask;
+
+    return &gpu_state->pte_bits[pte_bit];
+}
+
+// Allocate the PTE bits of the GPU state, if not allocated already
+static NV_STATUS block_gpu_pte_bits_alloc(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (gpu_state->pte_bits)
+        return NV_OK;
+
+    gpu_state->pte_bits = nv_kmem_cache_zalloc(g_uvm_va_block_gpu_pte_bits_cache, NV_UVM_GFP_FLAGS);
+    if (!gpu_state->pte_bits)
+        return NV_ERR_NO_MEMORY;
+
+    atomic64_inc(&g_uvm_va_block_footprint.pte_bits);
+
+    return NV_OK;
+}
+
+static void block_gpu_pte_bits_free(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (!gpu_state->pte_bits)
+        return;
+
+    kmem_cache_free(g_uvm_va_block_gpu_pte_bits_cache, gpu_state->pte_bits);
+    gpu_state->pte_bits = NULL;
+
+    atomic64_dec(&g_uvm_va_block_footprint.pte_bits);
+}
+
+// Free the PTE bits of the GPU state if no page is mapped anymore. The same
+// restrictions as in block_gpu_resident_mask_compact() apply.
+static void block_gpu_pte_bits_compact(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (gpu_state->pte_bits && uvm_page_mask_empty(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ]))
+        block_gpu_pte_bits_free(gpu_state);
+}
+
 NvU32 uvm_va_block_page_size_cpu(uvm_va_block_t *va_block, uvm_page_index_t page_index)
 {
     if (!uvm_page_mask_test(&va_block->cpu.pte_bits[UVM_PTE_BITS_CPU_READ], page_index))
@@ -1274,7 +1458,7 @@ NvU32 uvm_va_block_page_size_gpu(uvm_va_block_t *va_block, uvm_gpu_id_t gpu_id,
     if (!gpu_state)
         return 0;
 
-    if (!uvm_page_mask_test(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ], page_index))
+    if (!uvm_page_mask_test(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ), page_index))
         return 0;
 
     UVM_ASSERT(uvm_processor_mask_test(&va_block->mapped, gpu_id));
@@ -1310,7 +1494,7 @@ static NvU32 block_phys_page_size(uvm_va_block_t *block, block_phys_page_t page)
     }
 
     gpu_state = uvm_va_block_gpu_state_get(block, page.processor);
-    if (!gpu_state || !uvm_page_mask_test(&gpu_state->resident, page.page_index))
+    if (!gpu_state || !uvm_page_mask_test(block_gpu_resident_mask_get(gpu_state), page.page_index))
         return 0;
 
     UVM_ASSERT(uvm_processor_mask_test(&block->resident, page.processor));
@@ -1349,7 +1533,7 @@ static uvm_pte_bits_gpu_t get_gpu_pte_bit_index(uvm_prot_t prot)
     return pte_bit_index;
 }
 
-uvm_page_mask_t *uvm_va_block_resident_mask_get(uvm_va_block_t *block, uvm_processor_id_t processor)
+const uvm_page_mask_t *uvm_va_block_resident_mask_get(uvm_va_block_t *block, uvm_processor_id_t processor)
 {
     uvm_va_block_gpu_state_t *gpu_state;
 
@@ -1359,13 +1543,32 @@ uvm_page_mask_t *uvm_va_block_resident_mask_get(uvm_va_block_t *block, uvm_proce
     gpu_state = uvm_va_block_gpu_state_get(block, processor);
 
     UVM_ASSERT(gpu_state);
-    return &gpu_state->resident;
+    return block_gpu_resident_mask_get(gpu_state);
+}
+
+// Get the page residency mask for a processor for modification
+//
+// If the processor is a GPU, this will assert that its resident mask has
+// already been allocated by block_resident_mask_get_alloc(), which is always
+// the case for processors in block->resident.
+static uvm_page_mask_t *block_resident_mask_get_mutable(uvm_va_block_t *block, uvm_processor_id_t processor)
+{
+    uvm_va_block_gpu_state_t *gpu_state;
+
+    if (UVM_ID_IS_CPU(processor))
+        return &block->cpu.resident;
+
+    gpu_state = uvm_va_block_gpu_state_get(block, processor);
+
+    UVM_ASSERT(gpu_state);
+    UVM_ASSERT(gpu_state->resident);
+    return gpu_state->resident;
 }
 
 // Get the page residency mask for a processor
 //
-// Notably this will allocate GPU state if not yet present and if that fails
-// NULL is returned.
+// Notably this will allocate GPU state and its resident mask if not yet present
+// and if that fails NULL is returned.
 static uvm_page_mask_t *block_resident_mask_get_alloc(uvm_va_block_t *block, uvm_processor_id_t processor)
 {
     uvm_va_block_gpu_state_t *gpu_state;
@@ -1377,7 +1580,10 @@ static uvm_page_mask_t *block_resident_mask_get_alloc(uvm_va_block_t *block, uvm
     if (!gpu_state)
         return NULL;
 
-    return &gpu_state->resident;
+    if (block_gpu_resident_mask_alloc(gpu_state) != NV_OK)
+        return NULL;
+
+    return gpu_state->resident;
 }
 
 static const uvm_page_mask_t *block_map_with_prot_mask_get(uvm_va_block_t *block,
@@ -1392,7 +1598,7 @@ static const uvm_page_mask_t *block_map_with_prot_mask_get(uvm_va_block_t *block
     gpu_state = uvm_va_block_gpu_state_get(block, processor);
 
     UVM_ASSERT(gpu_state);
-    return &gpu_state->pte_bits[get_gpu_pte_bit_index(prot)];
+    return block_gpu_pte_bits_get(gpu_state, get_gpu_pte_bit_index(prot));
 }
 
 const uvm_page_mask_t *uvm_va_block_map_mask_get(uvm_va_block_t *block, uvm_processor_id_t processor)
@@ -1400,12 +1606,53 @@ const uvm_page_mask_t *uvm_va_block_map_mask_get(uvm_va_block_t *block, uvm_proc
     return block_map_with_prot_mask_get(block, processor, UVM_PROT_READ_ONLY);
 }
 
+static const uvm_page_mask_t *block_gpu_evicted_mask_get(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (!gpu_state->evicted)
+        return &g_uvm_va_block_empty_page_mask;
+
+    return gpu_state->evicted;
+}
+
 static const uvm_page_mask_t *block_evicted_mask_get(uvm_va_block_t *block, uvm_gpu_id_t gpu_id)
 {
     uvm_va_block_gpu_state_t *gpu_state = uvm_va_block_gpu_state_get(block, gpu_id);
     UVM_ASSERT(gpu_state);
 
-    return &gpu_state->evicted;
+    return block_gpu_evicted_mask_get(gpu_state);
+}
+
+// Allocate the evicted mask of the GPU state, if not allocated already
+static NV_STATUS block_gpu_evicted_mask_alloc(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (gpu_state->evicted)
+        return NV_OK;
+
+    gpu_state->evicted = nv_kmem_cache_zalloc(g_uvm_page_mask_cache, NV_UVM_GFP_FLAGS);
+    if (!gpu_state->evicted)
+        return NV_ERR_NO_MEMORY;
+
+    atomic64_inc(&g_uvm_va_block_footprint.evicted_masks);
+
+    return NV_OK;
+}
+
+static void block_gpu_evicted_mask_free(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (!gpu_state->evicted)
+        return;
+
+    kmem_cache_free(g_uvm_page_mask_cache, gpu_state->evicted);
+    gpu_state->evicted = NULL;
+
+    atomic64_dec(&g_uvm_va_block_footprint.evicted_masks);
+}
+
+// Free the evicted mask of the GPU state if no page is evicted anymore
+static void block_gpu_evicted_mask_compact(uvm_va_block_gpu_state_t *gpu_state)
+{
+    if (gpu_state->evicted && uvm_page_mask_empty(gpu_state->evicted))
+        block_gpu_evicted_mask_free(gpu_state);
 }
 
 static bool block_is_page_resident_anywhere(uvm_va_block_t *block, uvm_page_index_t page_index)
@@ -1447,7 +1694,7 @@ static bool block_processor_page_is_resident_on(uvm_va_block_t *block, uvm_proce
         if (!gpu_state)
             return false;
 
-        resident_mask = &gpu_state->resident;
+        resident_mask = block_gpu_resident_mask_get(gpu_state);
     }
 
     return uvm_page_mask_test(resident_mask, page_index);
@@ -1466,7 +1713,7 @@ void uvm_va_block_region_authorized_gpus(uvm_va_block_t *va_block,
     // Test all GPUs with mappings on the block
     for_each_gpu_id_in_mask(gpu_id, &va_block->mapped) {
         uvm_va_block_gpu_state_t *gpu_state = uvm_va_block_gpu_state_get(va_block, gpu_id);
-        if (gpu_state && !uvm_page_mask_region_empty(&gpu_state->pte_bits[search_gpu_bit], region))
+        if (gpu_state && !uvm_page_mask_region_empty(block_gpu_pte_bits_get(gpu_state, search_gpu_bit), region))
             uvm_processor_mask_set(authorized_gpus, gpu_id);
     }
 }
@@ -1521,7 +1768,7 @@ bool uvm_va_block_is_gpu_authorized_on_whole_region(uvm_va_block_t *va_block,
     if (!gpu_state)
         return false;
 
-    return uvm_page_mask_region_full(&gpu_state->pte_bits[search_gpu_bit], region);
+    return uvm_page_mask_region_full(block_gpu_pte_bits_get(gpu_state, search_gpu_bit), region);
 }
 
 bool uvm_va_block_is_processor_authorized_on_whole_region(uvm_va_block_t *va_block,
@@ -1900,7 +2147,7 @@ static NV_STATUS block_populate_gpu_chunk(uvm_va_block_t *block,
     if (gpu_state->chunks[chunk_index])
         return NV_OK;
 
-    UVM_ASSERT(uvm_page_mask_region_empty(&gpu_state->resident, chunk_region));
+    UVM_ASSERT(uvm_page_mask_region_empty(block_gpu_resident_mask_get(gpu_state), chunk_region));
 
     status = block_alloc_gpu_chunk(block, retry, gpu, chunk_size, &chunk);
     if (status != NV_OK)
@@ -2421,8 +2668,8 @@ static NV_STATUS block_copy_resident_pages_between(uvm_va_block_t *block,
                                                    uvm_tracker_t *copy_tracker)
 {
     NV_STATUS tracker_status, status = NV_OK;
-    uvm_page_mask_t *src_resident_mask = uvm_va_block_resident_mask_get(block, src_id);
-    uvm_page_mask_t *dst_resident_mask = uvm_va_block_resident_mask_get(block, dst_id);
+    uvm_page_mask_t *src_resident_mask = block_resident_mask_get_mutable(block, src_id);
+    uvm_page_mask_t *dst_resident_mask = block_resident_mask_get_mutable(block, dst_id);
     uvm_gpu_t *copying_gpu = NULL;
     uvm_push_t push;
     uvm_page_index_t page_index;
@@ -2723,15 +2970,21 @@ static NV_STATUS block_copy_resident_pages_between(uvm_va_block_t *block,
             UVM_ASSERT(src_gpu_state);
             UVM_ASSERT(UVM_ID_IS_CPU(dst_id));
 
-            uvm_page_mask_or(&src_gpu_state->evicted, &src_gpu_state->evicted, copy_mask);
+            // Allocated by uvm_va_block_evict_chunks() before migrating
+            UVM_ASSERT(src_gpu_state->evicted);
+
+            uvm_page_mask_or(src_gpu_state->evicted, src_gpu_state->evicted, copy_mask);
             uvm_processor_mask_set(&block->evicted_gpus, src_id);
         }
         else if (UVM_ID_IS_GPU(dst_id) && uvm_processor_mask_test(&block->evicted_gpus, dst_id)) {
             uvm_va_block_gpu_state_t *dst_gpu_state = uvm_va_block_gpu_state_get(block, dst_id);
             UVM_ASSERT(dst_gpu_state);
+            UVM_ASSERT(dst_gpu_state->evicted);
 
-            if (!uvm_page_mask_andnot(&dst_gpu_state->evicted, &dst_gpu_state->evicted, copy_mask))
+            if (!uvm_page_mask_andnot(dst_gpu_state->evicted, dst_gpu_state->evicted, copy_mask)) {
                 uvm_processor_mask_clear(&block->evicted_gpus, dst_id);
+                block_gpu_evicted_mask_free(dst_gpu_state);
+            }
         }
     }
 
@@ -2819,7 +3072,7 @@ static void break_read_duplication_in_region(uvm_va_block_t *block,
         if (uvm_id_equal(id, dst_id))
             continue;
 
-        other_resident_mask = uvm_va_block_resident_mask_get(block, id);
+        other_resident_mask = block_resident_mask_get_mutable(block, id);
 
         if (!uvm_page_mask_andnot(other_resident_mask, other_resident_mask, break_pages_in_region))
             block_clear_resident_processor(block, id);
@@ -2833,7 +3086,7 @@ static void block_copy_set_first_touch_residency(uvm_va_block_t *block,
                                                  const uvm_page_mask_t *page_mask)
 {
     uvm_page_index_t page_index;
-    uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(block, dst_id);
+    uvm_page_mask_t *resident_mask = block_resident_mask_get_mutable(block, dst_id);
     uvm_page_mask_t *first_touch_mask = &block_context->make_resident.page_mask;
 
     if (page_mask)
@@ -2878,7 +3131,7 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
     NV_STATUS status = NV_OK;
     NV_STATUS tracker_status;
     uvm_tracker_t local_tracker = UVM_TRACKER_INIT();
-    uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(block, dst_id);
+    const uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(block, dst_id);
     NvU32 missing_pages_count;
     NvU32 pages_copied;
     NvU32 pages_copied_to_cpu;
@@ -2890,12 +3143,13 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
 
     uvm_page_mask_zero(migrated_pages);
 
-    if (page_mask)
-        uvm_page_mask_andnot(copy_page_mask, page_mask, resident_mask);
-    else
+    if (page_mask) {
+        missing_pages_count = uvm_page_mask_andnot_region_weight(copy_page_mask, page_mask, resident_mask, region);
+    }
+    else {
         uvm_page_mask_complement(copy_page_mask, resident_mask);
-
-    missing_pages_count = uvm_page_mask_region_weight(copy_page_mask, region);
+        missing_pages_count = uvm_page_mask_region_weight(copy_page_mask, region);
+    }
 
     // If nothing needs to be copied, just check if we need to break
     // read-duplication (i.e. transfer_mode is UVM_VA_BLOCK_TRANSFER_MODE_MOVE)
@@ -3312,11 +3566,11 @@ static uvm_prot_t block_page_prot_gpu(uvm_va_block_t *block, uvm_gpu_t *gpu, uvm
     if (!gpu_state)
         return UVM_PROT_NONE;
 
-    if (uvm_page_mask_test(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_ATOMIC], page_index))
+    if (uvm_page_mask_test(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_ATOMIC), page_index))
         prot = UVM_PROT_READ_WRITE_ATOMIC;
-    else if (uvm_page_mask_test(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_WRITE], page_index))
+    else if (uvm_page_mask_test(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_WRITE), page_index))
         prot = UVM_PROT_READ_WRITE;
-    else if (uvm_page_mask_test(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ], page_index))
+    else if (uvm_page_mask_test(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ), page_index))
         prot = UVM_PROT_READ_ONLY;
     else
         prot = UVM_PROT_NONE;
@@ -3755,9 +4009,9 @@ static bool block_check_mappings_ptes(uvm_va_block_t *block, uvm_gpu_t *gpu)
         // All page permissions match
         for (pte_bit = 0; pte_bit < UVM_PTE_BITS_GPU_MAX; pte_bit++) {
             if (prot == UVM_PROT_NONE || pte_bit > get_gpu_pte_bit_index(prot))
-                UVM_ASSERT(uvm_page_mask_empty(&gpu_state->pte_bits[pte_bit]));
+                UVM_ASSERT(uvm_page_mask_empty(block_gpu_pte_bits_get(gpu_state, pte_bit)));
             else
-                UVM_ASSERT(uvm_page_mask_full(&gpu_state->pte_bits[pte_bit]));
+                UVM_ASSERT(uvm_page_mask_full(block_gpu_pte_bits_get(gpu_state, pte_bit)));
         }
 
         if (prot != UVM_PROT_NONE) {
@@ -3800,7 +4054,7 @@ static bool block_check_mappings_ptes(uvm_va_block_t *block, uvm_gpu_t *gpu)
             if (!test_bit(big_page_index, gpu_state->big_ptes)) {
                 // If there are valid mappings but this isn't a big PTE, the
                 // mapping must be using the 4k PTEs.
-                if (!uvm_page_mask_region_empty(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ], big_region))
+                if (!uvm_page_mask_region_empty(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ), big_region))
                     UVM_ASSERT(gpu_state->page_table_range_4k.table);
                 continue;
             }
@@ -3810,9 +4064,9 @@ static bool block_check_mappings_ptes(uvm_va_block_t *block, uvm_gpu_t *gpu)
             // All page permissions match
             for (pte_bit = 0; pte_bit < UVM_PTE_BITS_GPU_MAX; pte_bit++) {
                 if (prot == UVM_PROT_NONE || pte_bit > get_gpu_pte_bit_index(prot))
-                    UVM_ASSERT(uvm_page_mask_region_empty(&gpu_state->pte_bits[pte_bit], big_region));
+                    UVM_ASSERT(uvm_page_mask_region_empty(block_gpu_pte_bits_get(gpu_state, pte_bit), big_region));
                 else
-                    UVM_ASSERT(uvm_page_mask_region_full(&gpu_state->pte_bits[pte_bit], big_region));
+                    UVM_ASSERT(uvm_page_mask_region_full(block_gpu_pte_bits_get(gpu_state, pte_bit), big_region));
             }
 
             if (prot != UVM_PROT_NONE) {
@@ -3963,7 +4217,7 @@ static bool block_has_remote_mapping_gpu(uvm_va_block_t *block,
         return false;
 
     // The caller must ensure that all pages of the input mask are really mapped
-    UVM_ASSERT(uvm_page_mask_subset(mapped_pages, &gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ]));
+    UVM_ASSERT(uvm_page_mask_subset(mapped_pages, block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ)));
 
     // UVM-Lite GPUs map the preferred location if it's accessible, regardless
     // of the resident location.
@@ -3975,7 +4229,9 @@ static bool block_has_remote_mapping_gpu(uvm_va_block_t *block,
     }
 
     // Remote pages are pages which are mapped but not resident locally
-    return uvm_page_mask_andnot(&block_context->scratch_page_mask, mapped_pages, &gpu_state->resident);
+    return uvm_page_mask_andnot(&block_context->scratch_page_mask,
+                                mapped_pages,
+                                block_gpu_resident_mask_get(gpu_state));
 }
 
 // Writes pte_clear_val to the 4k PTEs covered by clear_page_mask. If
@@ -5044,7 +5300,7 @@ static void block_gpu_map_big_and_4k(uvm_va_block_t *block,
     bitmap_zero(big_ptes_mask, MAX_BIG_PAGES_PER_UVM_VA_BLOCK);
     for_each_set_bit(big_page_index, big_ptes_split, MAX_BIG_PAGES_PER_UVM_VA_BLOCK) {
         big_region = uvm_va_block_big_page_region(block, big_page_index, big_page_size);
-        if (uvm_page_mask_test(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ], big_region.first))
+        if (uvm_page_mask_test(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ), big_region.first))
             __set_bit(big_page_index, big_ptes_mask);
     }
 
@@ -5847,13 +6103,15 @@ static NV_STATUS block_unmap_gpu(uvm_va_block_t *block,
     if (!block_gpu_has_page_tables(block, gpu))
         return NV_OK;
 
-    if (!uvm_page_mask_and(pages_to_unmap, unmap_page_mask, &gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ]))
+    if (!uvm_page_mask_and(pages_to_unmap, unmap_page_mask, block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ)))
         return NV_OK;
 
     // block_gpu_compute_new_pte_state needs a mask of pages which will have
     // matching attributes after the operation is performed. In the case of
     // unmap, those are the pages with unset bits.
-    uvm_page_mask_andnot(&block_context->scratch_page_mask, &gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ], pages_to_unmap);
+    uvm_page_mask_andnot(&block_context->scratch_page_mask,
+                         block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ),
+                         pages_to_unmap);
     uvm_page_mask_complement(&block_context->scratch_page_mask, &block_context->scratch_page_mask);
     block_gpu_compute_new_pte_state(block,
                                     gpu,
@@ -6252,7 +6510,7 @@ static NV_STATUS block_map_gpu_to(uvm_va_block_t *va_block,
 
     UVM_ASSERT(!uvm_page_mask_and(&block_context->scratch_page_mask,
                                   map_page_mask,
-                                  &gpu_state->pte_bits[prot_pte_bit]));
+                                  block_gpu_pte_bits_get(gpu_state, prot_pte_bit)));
 
     // The pages which will actually change are those in the input page mask
     // which are resident on the target.
@@ -6261,13 +6519,19 @@ static NV_STATUS block_map_gpu_to(uvm_va_block_t *va_block,
 
     UVM_ASSERT(block_check_mapping_residency(va_block, gpu, resident_id, pages_to_map));
 
+    // Updating the PTE bits once the mapping has been pushed can't fail, so
+    // make sure they are allocated upfront.
+    status = block_gpu_pte_bits_alloc(gpu_state);
+    if (status != NV_OK)
+        return status;
+
     // For PTE merge/split computation, compute all resident pages which will
     // have exactly new_prot after performing the mapping.
-    uvm_page_mask_or(&block_context->scratch_page_mask, &gpu_state->pte_bits[prot_pte_bit], pages_to_map);
+    uvm_page_mask_or(&block_context->scratch_page_mask, block_gpu_pte_bits_get(gpu_state, prot_pte_bit), pages_to_map);
     if (prot_pte_bit < UVM_PTE_BITS_GPU_ATOMIC) {
         uvm_page_mask_andnot(&block_context->scratch_page_mask,
                              &block_context->scratch_page_mask,
-                             &gpu_state->pte_bits[prot_pte_bit + 1]);
+                             block_gpu_pte_bits_get(gpu_state, prot_pte_bit + 1));
     }
     uvm_page_mask_and(&block_context->scratch_page_mask, &block_context->scratch_page_mask, resident_mask);
 
@@ -6434,7 +6698,7 @@ NV_STATUS uvm_va_block_map(uvm_va_block_t *va_block,
             return NV_ERR_NO_MEMORY;
 
         prot_pte_bit = get_gpu_pte_bit_index(new_prot);
-        pte_mask = &gpu_state->pte_bits[prot_pte_bit];
+        pte_mask = block_gpu_pte_bits_get(gpu_state, prot_pte_bit);
     }
 
     uvm_page_mask_init_from_region(running_page_mask, region, map_page_mask);
@@ -6536,7 +6800,9 @@ static void block_revoke_prot_gpu_perf_notify(uvm_va_block_t *block,
     for (pte_bit = UVM_PTE_BITS_GPU_ATOMIC; pte_bit >= get_gpu_pte_bit_index(prot_revoked); pte_bit--) {
         uvm_prot_t old_prot;
 
-        if (!uvm_page_mask_and(&block_context->scratch_page_mask, &gpu_state->pte_bits[pte_bit], pages_revoked))
+        if (!uvm_page_mask_and(&block_context->scratch_page_mask,
+                               block_gpu_pte_bits_get(gpu_state, pte_bit),
+                               pages_revoked))
             continue;
 
         if (pte_bit == UVM_PTE_BITS_GPU_ATOMIC)
@@ -6584,7 +6850,7 @@ static NV_STATUS block_revoke_prot_gpu_to(uvm_va_block_t *va_block,
     uvm_page_mask_t *pages_to_revoke = &block_context->mapping.page_mask;
 
     UVM_ASSERT(revoke_page_mask);
-    UVM_ASSERT(uvm_page_mask_subset(revoke_page_mask, &gpu_state->pte_bits[prot_pte_bit]));
+    UVM_ASSERT(uvm_page_mask_subset(revoke_page_mask, block_gpu_pte_bits_get(gpu_state, prot_pte_bit)));
 
     // The pages which will actually change are those in the input page mask
     // which are resident on the target.
@@ -6595,9 +6861,11 @@ static NV_STATUS block_revoke_prot_gpu_to(uvm_va_block_t *va_block,
 
     // For PTE merge/split computation, compute all resident pages which will
     // have exactly prot_to_revoke-1 after performing the revocation.
-    uvm_page_mask_andnot(&block_context->scratch_page_mask, &gpu_state->pte_bits[prot_pte_bit], pages_to_revoke);
     uvm_page_mask_andnot(&block_context->scratch_page_mask,
-                         &gpu_state->pte_bits[prot_pte_bit - 1],
+                         block_gpu_pte_bits_get(gpu_state, prot_pte_bit),
+                         pages_to_revoke);
+    uvm_page_mask_andnot(&block_context->scratch_page_mask,
+                         block_gpu_pte_bits_get(gpu_state, prot_pte_bit - 1),
                          &block_context->scratch_page_mask);
     uvm_page_mask_and(&block_context->scratch_page_mask, &block_context->scratch_page_mask, resident_mask);
 
@@ -6705,7 +6973,7 @@ NV_STATUS uvm_va_block_revoke_prot(uvm_va_block_t *va_block,
 
     uvm_page_mask_init_from_region(running_page_mask, region, revoke_page_mask);
 
-    if (!uvm_page_mask_and(running_page_mask, running_page_mask, &gpu_state->pte_bits[prot_pte_bit]))
+    if (!uvm_page_mask_and(running_page_mask, running_page_mask, block_gpu_pte_bits_get(gpu_state, prot_pte_bit)))
         return NV_OK;
 
     // Revoke per resident location so we can more easily detect physically-
@@ -6911,7 +7179,7 @@ static void block_destroy_gpu_state(uvm_va_block_t *block, uvm_gpu_id_t id)
         size_t i, num_chunks;
 
         update_read_duplicated_pages_mask(block, id, gpu_state);
-        uvm_page_mask_zero(&gpu_state->resident);
+        block_gpu_resident_mask_free(gpu_state);
         block_clear_resident_processor(block, id);
 
         num_chunks = block_num_gpu_chunks(block, gpu);
@@ -6937,8 +7205,12 @@ static void block_destroy_gpu_state(uvm_va_block_t *block, uvm_gpu_id_t id)
     block_gpu_unmap_phys_all_cpu_pages(block, gpu);
     uvm_cpu_chunk_gpu_mapping_free(block, gpu->id);
     uvm_processor_mask_clear(&block->evicted_gpus, id);
+    block_gpu_evicted_mask_free(gpu_state);
+    block_gpu_resident_mask_free(gpu_state);
+    block_gpu_pte_bits_free(gpu_state);
 
     kmem_cache_free(g_uvm_va_block_gpu_state_cache, gpu_state);
+    atomic64_dec(&g_uvm_va_block_footprint.gpu_states);
     block->gpus[uvm_id_gpu_index(id)] = NULL;
 }
 
@@ -7238,7 +7510,7 @@ static void block_unregister_gpu_locked(uvm_va_block_t *va_block, uvm_gpu_t *gpu
 
     // The mappings should've already been torn down by GPU VA space unregister
     UVM_ASSERT(!uvm_processor_mask_test(&va_block->mapped, gpu->id));
-    UVM_ASSERT(uvm_page_mask_empty(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ]));
+    UVM_ASSERT(uvm_page_mask_empty(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ)));
     UVM_ASSERT(!block_gpu_has_page_tables(va_block, gpu));
 
     // Use UVM_VA_BLOCK_RETRY_LOCKED() as the va block lock is already taken and
@@ -7768,6 +8040,26 @@ static NV_STATUS block_split_preallocate_no_retry(uvm_va_block_t *existing, uvm_
             status = NV_ERR_NO_MEMORY;
             goto error;
         }
+
+        // The new block may get some of the resident, mapped and evicted
+        // pages
+        if (uvm_va_block_gpu_state_get(existing, id)->resident) {
+            status = block_gpu_resident_mask_alloc(uvm_va_block_gpu_state_get(new, id));
+            if (status != NV_OK)
+                goto error;
+        }
+
+        if (uvm_va_block_gpu_state_get(existing, id)->pte_bits) {
+            status = block_gpu_pte_bits_alloc(uvm_va_block_gpu_state_get(new, id));
+            if (status != NV_OK)
+                goto error;
+        }
+
+        if (uvm_va_block_gpu_state_get(existing, id)->evicted) {
+            status = block_gpu_evicted_mask_alloc(uvm_va_block_gpu_state_get(new, id));
+            if (status != NV_OK)
+                goto error;
+        }
     }
 
     if (existing_va_range && existing_va_range->inject_split_error) {
@@ -7856,21 +8148,23 @@ static void block_set_processor_masks(uvm_va_block_t *block)
         if (!gpu_state)
             continue;
 
-        if (uvm_page_mask_region_empty(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_READ], block_region)) {
-            UVM_ASSERT(uvm_page_mask_region_empty(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_WRITE], block_region));
-            UVM_ASSERT(uvm_page_mask_region_empty(&gpu_state->pte_bits[UVM_PTE_BITS_GPU_ATOMIC], block_region));
+        if (uvm_page_mask_region_empty(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_READ), block_region)) {
+            UVM_ASSERT(uvm_page_mask_region_empty(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_WRITE),
+                                                  block_region));
+            UVM_ASSERT(uvm_page_mask_region_empty(block_gpu_pte_bits_get(gpu_state, UVM_PTE_BITS_GPU_ATOMIC),
+                                                  block_region));
             uvm_processor_mask_clear(&block->mapped, id);
         }
         else {
             uvm_processor_mask_set(&block->mapped, id);
         }
 
-        if (uvm_page_mask_region_empty(&gpu_state->resident, block_region))
+        if (uvm_page_mask_region_empty(block_gpu_resident_mask_get(gpu_state), block_region))
             block_clear_resident_processor(block, id);
         else
             block_set_resident_processor(block, id);
 
-        if (uvm_page_mask_region_empty(&gpu_state->evicted, block_region))
+        if (uvm_page_mask_region_empty(block_gpu_evicted_mask_get(gpu_state), block_region))
             uvm_processor_mask_clear(&block->evicted_gpus, id);
         else
             uvm_processor_mask_set(&block->evicted_gpus, id);
@@ -8123,14 +8417,24 @@ static void block_split_gpu(uvm_va_block_t *existing, uvm_va_block_t *new, uvm_g
         }
     }
 
-    block_split_page_mask(&existing_gpu_state->resident,
-                          existing_pages,
-                          &new_gpu_state->resident,
-                          new_pages);
+    if (existing_gpu_state->resident) {
+        // Allocated by block_split_preallocate_no_retry()
+        UVM_ASSERT(new_gpu_state->resident);
 
-    for (pte_bit = 0; pte_bit < UVM_PTE_BITS_GPU_MAX; pte_bit++) {
-        block_split_page_mask(&existing_gpu_state->pte_bits[pte_bit], existing_pages,
-                              &new_gpu_state->pte_bits[pte_bit], new_pages);
+        block_split_page_mask(existing_gpu_state->resident,
+                              existing_pages,
+                              new_gpu_state->resident,
+                              new_pages);
+    }
+
+    if (existing_gpu_state->pte_bits) {
+        // Allocated by block_split_preallocate_no_retry()
+        UVM_ASSERT(new_gpu_state->pte_bits);
+
+        for (pte_bit = 0; pte_bit < UVM_PTE_BITS_GPU_MAX; pte_bit++) {
+            block_split_page_mask(&existing_gpu_state->pte_bits[pte_bit], existing_pages,
+                                  &new_gpu_state->pte_bits[pte_bit], new_pages);
+        }
     }
 
     // Adjust page table ranges.
@@ -8211,7 +8515,19 @@ static void block_split_gpu(uvm_va_block_t *existing, uvm_va_block_t *new, uvm_g
         existing_gpu_state->activated_4k = false;
     }
 
-    block_split_page_mask(&existing_gpu_state->evicted, existing_pages, &new_gpu_state->evicted, new_pages);
+    if (existing_gpu_state->evicted) {
+        // Allocated by block_split_preallocate_no_retry()
+        UVM_ASSERT(new_gpu_state->evicted);
+
+        block_split_page_mask(existing_gpu_state->evicted, existing_pages, new_gpu_state->evicted, new_pages);
+    }
+
+    block_gpu_resident_mask_compact(existing_gpu_state);
+    block_gpu_resident_mask_compact(new_gpu_state);
+    block_gpu_pte_bits_compact(existing_gpu_state);
+    block_gpu_pte_bits_compact(new_gpu_state);
+    block_gpu_evicted_mask_compact(existing_gpu_state);
+    block_gpu_evicted_mask_compact(new_gpu_state);
 }
 
 NV_STATUS uvm_va_block_split(uvm_va_block_t *existing_va_block,
@@ -9939,7 +10255,7 @@ static void block_deferred_eviction_mappings(void *args)
                                                                            block_context,
                                                                            id,
                                                                            uvm_va_block_region_from_block(va_block),
-                                                                           &gpu_state->evicted,
+                                                                           block_gpu_evicted_mask_get(gpu_state),
                                                                            UvmEventMapRemoteCauseEviction));
                 if (status != NV_OK)
                     break;
@@ -10040,6 +10356,12 @@ NV_STATUS uvm_va_block_evict_chunks(uvm_va_block_t *va_block,
     // Only move pages resident on the GPU
     uvm_page_mask_and(pages_to_evict, pages_to_evict, uvm_va_block_resident_mask_get(va_block, gpu->id));
 
+    // Recording the evicted pages once they have been migrated can't fail, so
+    // make sure the evicted mask is allocated upfront.
+    status = block_gpu_evicted_mask_alloc(gpu_state);
+    if (status != NV_OK)
+        goto out;
+
     block_context->policy = uvm_va_range_get_policy(va_block->va_range);
 
     // TODO: Bug 1765193: make_resident() breaks read-duplication, but it's not
@@ -10053,6 +10375,9 @@ NV_STATUS uvm_va_block_evict_chunks(uvm_va_block_t *va_block,
                                         pages_to_evict,
                                         NULL,
                                         UVM_MAKE_RESIDENT_CAUSE_EVICTION);
+    block_gpu_resident_mask_compact(gpu_state);
+    block_gpu_pte_bits_compact(gpu_state);
+    block_gpu_evicted_mask_compact(gpu_state);
     if (status != NV_OK)
         goto out;
 
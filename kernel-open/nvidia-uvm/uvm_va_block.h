@@ -105,10 +105,20 @@ typedef struct
     // This follows the same semantics as the CPU residency bit vector and
     // notably each bit still represents a PAGE_SIZE amount of data, but the
     // physical GPU memory is tracked by an array of GPU chunks below.
-    uvm_page_mask_t resident;
+    //
+    // GPUs which only map the block remotely never have any page resident, so
+    // the mask is only allocated by block_resident_mask_get_alloc() before
+    // pages are populated on the GPU. NULL means no page is resident. Use
+    // uvm_va_block_resident_mask_get() for lookups.
+    uvm_page_mask_t *resident;
 
     // Pages that have been evicted to sysmem
-    uvm_page_mask_t evicted;
+    //
+    // Most blocks never get any pages evicted, so the mask is only allocated
+    // when the block is being evicted from the GPU and it's freed again once
+    // it becomes empty. NULL means no page is evicted. Use
+    // block_evicted_mask_get() for lookups.
+    uvm_page_mask_t *evicted;
 
     NvU64 *cpu_chunks_dma_addrs;
 
@@ -224,7 +234,12 @@ typedef struct
     // granularity of operations on the VA blocks. As a future optimization we
     // could consider sub-PAGE_SIZE operations if PAGE_SIZE > 4K and the CPU
     // isn't involved, for example false sharing among peer GPUs.
-    uvm_page_mask_t pte_bits[UVM_PTE_BITS_GPU_MAX];
+    //
+    // Array of UVM_PTE_BITS_GPU_MAX masks. GPUs which only hold resident pages
+    // for other processors never map the block, so the array is only allocated
+    // by block_map_gpu_to() before the first mapping is created. NULL means no
+    // page is mapped. Use block_gpu_pte_bits_get() for lookups.
+    uvm_page_mask_t *pte_bits;
 
 } uvm_va_block_gpu_state_t;
 
@@ -1147,10 +1162,11 @@ static uvm_va_block_test_t *uvm_va_block_get_test(uvm_va_block_t *va_block)
     return NULL;
 }
 
-// Get the page residency mask for a processor if it's known to be there.
+// Get the page residency mask for a processor if it's known to be there. The
+// returned mask cannot be directly modified by the caller.
 //
 // If the processor is a GPU, this will assert that GPU state is indeed present.
-uvm_page_mask_t *uvm_va_block_resident_mask_get(uvm_va_block_t *block, uvm_processor_id_t processor);
+const uvm_page_mask_t *uvm_va_block_resident_mask_get(uvm_va_block_t *block, uvm_processor_id_t processor);
 
 // Get the page mapped mask for a processor. The returned mask cannot be
 // directly modified by the caller
@@ -1436,14 +1452,81 @@ static bool uvm_page_mask_region_test(const uvm_page_mask_t *mask,
     return !mask || uvm_page_mask_test(mask, page_index);
 }
 
+// Mask of the bits of the given bitmap word that fall within the region. The
+// word must overlap the region.
+static unsigned long uvm_page_mask_region_word_mask(uvm_va_block_region_t region, size_t word)
+{
+    unsigned long word_mask = ~0UL;
+
+    UVM_ASSERT(word >= BIT_WORD(region.first));
+    UVM_ASSERT(word <= BIT_WORD(region.outer - 1));
+
+    if (word == BIT_WORD(region.first))
+        word_mask &= BITMAP_FIRST_WORD_MASK(region.first);
+    if (word == BIT_WORD(region.outer - 1))
+        word_mask &= BITMAP_LAST_WORD_MASK(region.outer);
+
+    return word_mask;
+}
+
+// The region weight helpers below only access the words of the bitmaps that
+// overlap the region, and compute their result in a single pass.
 static NvU32 uvm_page_mask_region_weight(const uvm_page_mask_t *mask, uvm_va_block_region_t region)
 {
-    NvU32 weight_before = 0;
+    NvU32 weight = 0;
+    size_t word;
 
-    if (region.first > 0)
-        weight_before = bitmap_weight(mask->bitmap, region.first);
+    if (region.first >= region.outer)
+        return 0;
+
+    for (word = BIT_WORD(region.first); word <= BIT_WORD(region.outer - 1); ++word)
+        weight += hweight_long(mask->bitmap[word] & uvm_page_mask_region_word_mask(region, word));
+
+    return weight;
+}
+
+// Number of pages within the region set in both masks
+static NvU32 uvm_page_mask_intersection_region_weight(const uvm_page_mask_t *mask1,
+                                                      const uvm_page_mask_t *mask2,
+                                                      uvm_va_block_region_t region)
+{
+    NvU32 weight = 0;
+    size_t word;
+
+    if (region.first >= region.outer)
+        return 0;
+
+    for (word = BIT_WORD(region.first); word <= BIT_WORD(region.outer - 1); ++word) {
+        unsigned long bits = mask1->bitmap[word] & mask2->bitmap[word];
+
+        weight += hweight_long(bits & uvm_page_mask_region_word_mask(region, word));
+    }
+
+    return weight;
+}
+
+// Same as uvm_page_mask_andnot(), but returns the number of pages set in
+// mask_out within the given region. The whole mask_out is updated.
+static NvU32 uvm_page_mask_andnot_region_weight(uvm_page_mask_t *mask_out,
+                                                const uvm_page_mask_t *mask_in1,
+                                                const uvm_page_mask_t *mask_in2,
+                                                uvm_va_block_region_t region)
+{
+    NvU32 weight = 0;
+    size_t word;
+
+    for (word = 0; word < BITS_TO_LONGS(PAGES_PER_UVM_VA_BLOCK); ++word) {
+        unsigned long bits = mask_in1->bitmap[word] & ~mask_in2->bitmap[word];
+
+        mask_out->bitmap[word] = bits;
+
+        if (region.first < region.outer &&
+            word >= BIT_WORD(region.first) &&
+            word <= BIT_WORD(region.outer - 1))
+            weight += hweight_long(bits & uvm_page_mask_region_word_mask(region, word));
+    }
 
-    return bitmap_weight(mask->bitmap, region.outer) - weight_before;
+    return weight;
 }
 
 static bool uvm_page_mask_region_empty(const uvm_page_mask_t *mask, uvm_va_block_region_t region)
@@ -549,6 +549,16 @@ void uvm_va_range_destroy(uvm_va_range_t *va_range, struct list_head *deferred_f
     kmem_cache_free(g_uvm_va_range_cache, va_range);
 }
 
+void uvm_va_range_unlink(uvm_va_range_t *va_range)
+{
+    UVM_ASSERT(va_range->type == UVM_VA_RANGE_TYPE_EXTERNAL);
+    uvm_assert_rwsem_locked_write(&va_range->va_space->lock);
+    UVM_ASSERT(!RB_EMPTY_NODE(&va_range->node.rb_node));
+
+    uvm_range_tree_remove(&va_range->va_space->va_range_tree, &va_range->node);
+    RB_CLEAR_NODE(&va_range->node.rb_node);
+}
+
 void uvm_va_range_zombify(uvm_va_range_t *va_range)
 {
     if (!va_range)
@@ -455,6 +455,15 @@ NV_STATUS uvm_va_range_create_semaphore_pool(uvm_va_space_t *va_space,
 // processing by uvm_deferred_free_object_list.
 void uvm_va_range_destroy(uvm_va_range_t *va_range, struct list_head *deferred_free_list);
 
+// Removes the VA range from the VA space range tree without destroying it, so
+// that lookups no longer find it. uvm_va_range_destroy can then be called on
+// it with the VA space lock held in read mode, as long as the VA range's
+// interval is locked in va_space->range_lock. Only external VA ranges are
+// supported.
+//
+// LOCKING: The VA space lock must be held in write mode.
+void uvm_va_range_unlink(uvm_va_range_t *va_range);
+
 void uvm_va_range_zombify(uvm_va_range_t *va_range);
 
 NV_STATUS uvm_api_clean_up_zombie_resources(UVM_CLEAN_UP_ZOMBIE_RESOURCES_PARAMS *params, struct file *filp);
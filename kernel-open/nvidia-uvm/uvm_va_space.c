@@ -41,6 +41,98 @@
 #include "uvm_common.h"
 #include "nv_uvm_interface.h"
 #include "nv-kthread-q.h"
+#include "uvm_procfs.h"
+
+static struct
+{
+    // Time spent waiting to acquire the VA space lock in each mode, including
+    // the time spent waiting for the auxiliary VA space mutexes.
+    uvm_lock_time_histogram_t read_wait;
+    uvm_lock_time_histogram_t write_wait;
+
+    // Time the VA space lock is held in write mode until it's released or
+    // downgraded to read mode.
+    uvm_lock_time_histogram_t write_hold;
+
+    struct proc_dir_entry *procfs_file;
+} g_uvm_va_space_lock_stats;
+
+NvU64 uvm_va_space_lock_stats_begin(void)
+{
+    if (!uvm_procfs_is_debug_enabled())
+        return 0;
+
+    return NV_GETTIME();
+}
+
+void uvm_va_space_lock_stats_read_acquired(NvU64 begin_ns)
+{
+    if (begin_ns == 0)
+        return;
+
+    uvm_lock_time_histogram_add(&g_uvm_va_space_lock_stats.read_wait, NV_GETTIME() - begin_ns);
+}
+
+void uvm_va_space_lock_stats_write_acquired(uvm_va_space_t *va_space, NvU64 begin_ns)
+{
+    NvU64 now;
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    if (begin_ns == 0) {
+        va_space->lock_write_acquire_ns = 0;
+        return;
+    }
+
+    now = NV_GETTIME();
+    uvm_lock_time_histogram_add(&g_uvm_va_space_lock_stats.write_wait, now - begin_ns);
+    va_space->lock_write_acquire_ns = now;
+}
+
+void uvm_va_space_lock_stats_write_released(uvm_va_space_t *va_space)
+{
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    if (va_space->lock_write_acquire_ns == 0)
+        return;
+
+    uvm_lock_time_histogram_add(&g_uvm_va_space_lock_stats.write_hold,
+                                NV_GETTIME() - va_space->lock_write_acquire_ns);
+    va_space->lock_write_acquire_ns = 0;
+}
+
+static int nv_procfs_read_va_space_lock_stats(struct seq_file *s, void *v)
+{
+    uvm_lock_time_histogram_print(&g_uvm_va_space_lock_stats.read_wait, "read_wait", s);
+    uvm_lock_time_histogram_print(&g_uvm_va_space_lock_stats.write_wait, "write_wait", s);
+    uvm_lock_time_histogram_print(&g_uvm_va_space_lock_stats.write_hold, "write_hold", s);
+
+    return 0;
+}
+
+static int nv_procfs_read_va_space_lock_stats_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_va_space_lock_stats(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(va_space_lock_stats_entry);
+
+NV_STATUS uvm_va_space_procfs_init(void)
+{
+    if (!uvm_procfs_is_debug_enabled())
+        return NV_OK;
+
+    // The file is removed along with the rest of the UVM procfs directory in
+    // uvm_procfs_exit().
+    g_uvm_va_space_lock_stats.procfs_file = NV_CREATE_PROC_FILE("va_space_lock_stats",
+                                                                uvm_procfs_get_cpu_base_dir(),
+                                                                va_space_lock_stats_entry,
+                                                                NULL);
+    if (!g_uvm_va_space_lock_stats.procfs_file)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    return NV_OK;
+}
 
 static bool processor_mask_array_test(const uvm_processor_mask_t *mask,
                                       uvm_processor_id_t mask_id,
@@ -174,6 +266,7 @@ NV_STATUS uvm_va_space_create(struct inode *inode, struct file *filp)
     uvm_mutex_init(&va_space->read_acquire_write_release_lock,
                    UVM_LOCK_ORDER_VA_SPACE_READ_ACQUIRE_WRITE_RELEASE_LOCK);
     uvm_spin_lock_init(&va_space->va_space_mm.lock, UVM_LOCK_ORDER_LEAF);
+    uvm_range_lock_init(&va_space->range_lock, UVM_LOCK_ORDER_VA_SPACE_RANGE);
     uvm_range_tree_init(&va_space->va_range_tree);
     uvm_ats_init_va_space(va_space);
 
@@ -567,6 +660,8 @@ void uvm_va_space_destroy(uvm_va_space_t *va_space)
 
     uvm_mutex_unlock(&g_uvm_global.global_lock);
 
+    uvm_range_lock_deinit(&va_space->range_lock);
+
     uvm_kvfree(va_space);
 }
 
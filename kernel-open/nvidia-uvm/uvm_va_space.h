@@ -187,6 +187,15 @@ struct uvm_va_space_struct
     // UVM_LOCK_ORDER_VA_SPACE_READ_ACQUIRE_WRITE_RELEASE_LOCK in uvm_lock.h.
     uvm_mutex_t read_acquire_write_release_lock;
 
+    // Time at which the VA space lock was last acquired in write mode, or 0 if
+    // VA space lock statistics were not being collected at that time.
+    // Protected by lock in write mode.
+    NvU64 lock_write_acquire_ns;
+
+    // Locks VA intervals for operations which only hold the VA space lock in
+    // read mode. See UVM_LOCK_ORDER_VA_SPACE_RANGE in uvm_lock.h.
+    uvm_range_lock_t range_lock;
+
     // Tree of uvm_va_range_t's
     uvm_range_tree_t va_range_tree;
 
@@ -445,18 +454,36 @@ static NV_STATUS uvm_va_space_initialized(uvm_va_space_t *va_space)
 NV_STATUS uvm_va_space_create(struct inode *inode, struct file *filp);
 void uvm_va_space_destroy(uvm_va_space_t *va_space);
 
+// Create the cpu/va_space_lock_stats procfs file, which reports histograms of
+// the time spent waiting for the VA space lock in each mode and of the time it
+// is held in write mode, across all VA spaces. The statistics are only
+// collected when debug procfs is enabled. Must be called after
+// uvm_procfs_init().
+NV_STATUS uvm_va_space_procfs_init(void);
+
+// Helpers used by the VA space lock wrappers below to collect the VA space
+// lock statistics. uvm_va_space_lock_stats_begin() returns the time at which
+// a thread starts waiting for the lock, or 0 if statistics are disabled.
+NvU64 uvm_va_space_lock_stats_begin(void);
+void uvm_va_space_lock_stats_read_acquired(NvU64 begin_ns);
+void uvm_va_space_lock_stats_write_acquired(uvm_va_space_t *va_space, NvU64 begin_ns);
+void uvm_va_space_lock_stats_write_released(uvm_va_space_t *va_space);
+
 // All VA space locking should be done with these wrappers. They're macros so
 // lock assertions are attributed to line numbers correctly.
 
-#define uvm_va_space_down_write(__va_space)                             \
-    do {                                                                \
-        uvm_mutex_lock(&(__va_space)->serialize_writers_lock);          \
-        uvm_mutex_lock(&(__va_space)->read_acquire_write_release_lock); \
-        uvm_down_write(&(__va_space)->lock);                            \
+#define uvm_va_space_down_write(__va_space)                               \
+    do {                                                                  \
+        NvU64 __begin_ns = uvm_va_space_lock_stats_begin();               \
+        uvm_mutex_lock(&(__va_space)->serialize_writers_lock);            \
+        uvm_mutex_lock(&(__va_space)->read_acquire_write_release_lock);   \
+        uvm_down_write(&(__va_space)->lock);                              \
+        uvm_va_space_lock_stats_write_acquired((__va_space), __begin_ns); \
     } while (0)
 
 #define uvm_va_space_up_write(__va_space)                                   \
     do {                                                                    \
+        uvm_va_space_lock_stats_write_released(__va_space);                 \
         uvm_up_write(&(__va_space)->lock);                                  \
         uvm_mutex_unlock(&(__va_space)->read_acquire_write_release_lock);   \
         uvm_mutex_unlock(&(__va_space)->serialize_writers_lock);            \
@@ -464,6 +491,7 @@ void uvm_va_space_destroy(uvm_va_space_t *va_space);
 
 #define uvm_va_space_downgrade_write(__va_space)                                        \
     do {                                                                                \
+        uvm_va_space_lock_stats_write_released(__va_space);                             \
         uvm_downgrade_write(&(__va_space)->lock);                                       \
         uvm_mutex_unlock_out_of_order(&(__va_space)->read_acquire_write_release_lock);  \
         uvm_mutex_unlock_out_of_order(&(__va_space)->serialize_writers_lock);           \
@@ -474,15 +502,18 @@ void uvm_va_space_destroy(uvm_va_space_t *va_space);
 #define uvm_va_space_downgrade_write_rm(__va_space)                                     \
     do {                                                                                \
         uvm_assert_mutex_locked(&(__va_space)->serialize_writers_lock);                 \
+        uvm_va_space_lock_stats_write_released(__va_space);                             \
         uvm_downgrade_write(&(__va_space)->lock);                                       \
         uvm_mutex_unlock_out_of_order(&(__va_space)->read_acquire_write_release_lock);  \
     } while (0)
 
 #define uvm_va_space_down_read(__va_space)                                              \
     do {                                                                                \
+        NvU64 __begin_ns = uvm_va_space_lock_stats_begin();                             \
         uvm_mutex_lock(&(__va_space)->read_acquire_write_release_lock);                 \
         uvm_down_read(&(__va_space)->lock);                                             \
         uvm_mutex_unlock_out_of_order(&(__va_space)->read_acquire_write_release_lock);  \
+        uvm_va_space_lock_stats_read_acquired(__begin_ns);                              \
     } while (0)
 
 // Call this if RM calls need to be made while holding the VA space lock in read
@@ -491,8 +522,10 @@ void uvm_va_space_destroy(uvm_va_space_t *va_space);
 // serialize_writers_lock.
 #define uvm_va_space_down_read_rm(__va_space)                           \
     do {                                                                \
+        NvU64 __begin_ns = uvm_va_space_lock_stats_begin();             \
         uvm_mutex_lock(&(__va_space)->serialize_writers_lock);          \
         uvm_down_read(&(__va_space)->lock);                             \
+        uvm_va_space_lock_stats_read_acquired(__begin_ns);              \
     } while (0)
 
 #define uvm_va_space_up_read(__va_space) uvm_up_read(&(__va_space)->lock)
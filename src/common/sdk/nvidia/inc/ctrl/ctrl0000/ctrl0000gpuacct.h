@@ -255,4 +255,70 @@ typedef struct NV0000_CTRL_GPUACCT_CLEAR_ACCOUNTING_DATA_PARAMS {
     NvU32 pid;
 } NV0000_CTRL_GPUACCT_CLEAR_ACCOUNTING_DATA_PARAMS;
 
+/*
+ * NV0000_CTRL_CMD_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO
+ *
+ * This command returns GPU accounting data for a batch of processes in one
+ * call. Processes are reported in the same order as the pid table returned
+ * by NV0000_CTRL_CMD_GPUACCT_GET_ACCOUNTING_PIDS, dead processes first.
+ *
+ *   gpuId
+ *     This parameter should specify a valid GPU ID value. Refer to the
+ *     description of NV0000_CTRL_CMD_GPU_GET_ATTACHED_IDS for more
+ *     information. If there is no GPU present with the specified ID,
+ *     a status of NV_ERR_INVALID_ARGUMENT is returned.
+ *   pid
+ *     In case of VGX host, this parameter specifies VGPU plugin(VM) pid. This
+ *     parameter is set only when this RM control is called from VGPU plugin,
+ *     otherwise it is zero.
+ *   startIndex
+ *     This input parameter specifies the index of the first process to
+ *     return. Set it to zero on the first call and to nextIndex afterwards.
+ *   procCount
+ *     This parameter returns the number of valid entries in procInfo.
+ *   nextIndex
+ *     This parameter returns the startIndex to use for the next batch.
+ *   bMoreEntries
+ *     This parameter returns NV_TRUE if more processes are available past
+ *     nextIndex.
+ *   procInfo
+ *     This parameter returns the accounting data of each process. The
+ *     gpuUtil, fbUtil, maxFbUsage, startTime and endTime fields have the same
+ *     meaning as in NV0000_CTRL_GPUACCT_GET_PROC_ACCOUNTING_INFO_PARAMS.
+ *     maxGpuUtil and maxFbUtil return the highest single sample seen for the
+ *     process, and bIsRunning is set for processes that are still alive.
+ *
+ * Possible status values returned are:
+ *   NV_OK
+ *   NV_ERR_INVALID_ARGUMENT
+ *   NV_ERR_INVALID_STATE
+ */
+#define NV0000_CTRL_CMD_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO (0xb06) /* finn: Evaluated from "(FINN_NV01_ROOT_GPUACCT_INTERFACE_ID << 8) | NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS_MESSAGE_ID" */
+
+/* max number of processes returned per call */
+#define NV0000_CTRL_GPUACCT_PROC_INFO_BATCH_MAX_COUNT        256
+
+typedef struct NV0000_CTRL_GPUACCT_PROC_ACCOUNTING_INFO {
+    NvU32  pid;
+    NvU32  gpuUtil;
+    NvU32  fbUtil;
+    NvU32  maxGpuUtil;
+    NvU32  maxFbUtil;
+    NvBool bIsRunning;
+    NV_DECLARE_ALIGNED(NvU64 maxFbUsage, 8);
+    NV_DECLARE_ALIGNED(NvU64 startTime, 8);
+    NV_DECLARE_ALIGNED(NvU64 endTime, 8);
+} NV0000_CTRL_GPUACCT_PROC_ACCOUNTING_INFO;
+
+#define NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS_MESSAGE_ID (0x6U)
+
+typedef struct NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS {
+    NvU32  gpuId;
+    NvU32  pid;
+    NvU32  startIndex;
+    NvU32  procCount;
+    NvU32  nextIndex;
+    NvBool bMoreEntries;
+    NV_DECLARE_ALIGNED(NV0000_CTRL_GPUACCT_PROC_ACCOUNTING_INFO procInfo[NV0000_CTRL_GPUACCT_PROC_INFO_BATCH_MAX_COUNT], 8);
+} NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS;
 
@@ -61,7 +61,17 @@ typedef struct TMR_EVENT TMR_EVENT;
 
 #define IS_VALID_SUBPID(x) (((x) > 0) && ((x) != 0xFFFFFFFF))
 
+//
+// Peak utilization samples attributed to a process during one sampling
+// interval.
+//
 typedef struct
+{
+    NvU32  maxGrUtil;
+    NvU32  maxFbUtil;
+} GPUACCT_SAMPLE_INTERVAL;
+
+typedef struct GPUACCT_PROC_ENTRY
 {
     NvU32  procId;      // Pid of the process.
     NvU32  procType;    // Type of the process.
@@ -79,6 +89,12 @@ typedef struct
     NvU64  endTime;     // Time when accounting is stopped for the process.
     NvU32  refCount;    // Count to keep track of accounting requests.
 
+    GPUACCT_SAMPLE_INTERVAL  curInterval;  // Samples seen in the interval being processed.
+    NvU32  maxGpuUtil;                     // Highest single GR utilization sample.
+    NvU32  maxFbUtil;                      // Highest single FB utilization sample.
+    struct GPUACCT_PROC_ENTRY *pNextActive; // Next process active in the current interval.
+    NvBool bActive;                        // Set while linked on the active chain.
+
     // Following members are only used on Grid host.
     NvU32  isGuestProcess; // Set if the entry corresponds to a guest VM process.
 
@@ -95,6 +111,41 @@ typedef struct
     GPU_ACCT_PROC_LIST procList;
 } GPU_ACCT_PROC_DATA_STORE;
 
+//
+// Final accounting data of a process that stopped running on the GPU. Kept
+// compact since there is no more sampling to do for it.
+//
+typedef struct GPUACCT_DEAD_PROC_RECORD
+{
+    NvU32  procId;      // Pid of the process.
+    NvU32  gpuUtil;     // Lifetime average GR engine utilization.
+    NvU32  fbUtil;      // Lifetime average FB bandwidth utilization.
+    NvU32  maxGpuUtil;  // Highest single GR utilization sample.
+    NvU32  maxFbUtil;   // Highest single FB utilization sample.
+    NvU64  maxFbUsage;  // High watermark FB allocated (in bytes).
+    NvU64  startTime;   // Time when accounting was started for the process.
+    NvU64  endTime;     // Time when accounting was stopped for the process.
+
+    MapNode  mapNode;   // Node in the pid map.
+    ListNode listNode;  // Node in the eviction order list.
+} GPUACCT_DEAD_PROC_RECORD;
+
+MAKE_INTRUSIVE_MAP (GPU_ACCT_DEAD_PROC_MAP,  GPUACCT_DEAD_PROC_RECORD, mapNode);
+MAKE_INTRUSIVE_LIST(GPU_ACCT_DEAD_PROC_LIST, GPUACCT_DEAD_PROC_RECORD, listNode);
+
+//
+// Bounded store of dead process records, looked up by pid and evicted oldest
+// first. The record array is allocated when the first process dies, and its
+// first count entries are in use.
+//
+typedef struct
+{
+    GPUACCT_DEAD_PROC_RECORD *pRecords; // NV_MAX_DEAD_ACCT_PROCESS entries.
+    GPU_ACCT_DEAD_PROC_MAP    procMap;  // Records keyed by pid.
+    GPU_ACCT_DEAD_PROC_LIST   procList; // Records in eviction order, oldest first.
+    NvU32  count;                       // Number of records in use.
+} GPUACCT_DEAD_PROC_STORE;
+
 typedef struct
 {
     TMR_EVENT        *pTmrEvent;                // Pointer to the timer event created to schedule main callback
@@ -106,8 +157,8 @@ typedef struct
 
     GPU_ACCT_PROC_DATA_STORE  liveProcAcctInfo; // Pointer to list of live processes
                                                 // running on this GPU.
-    GPU_ACCT_PROC_DATA_STORE  deadProcAcctInfo; // Pointer to list of dead processes
-                                                // running on this GPU.
+    GPUACCT_DEAD_PROC_STORE   deadProcAcctInfo; // Store of processes that ran and
+                                                // exited on this GPU.
 
 } GPUACCT_GPU_INSTANCE_INFO;
 
@@ -246,6 +297,16 @@ static inline NV_STATUS gpuacctGetAcctPids(struct GpuAccounting *arg0, NV0000_CT
 #define gpuacctGetAcctPids(arg0, arg1) gpuacctGetAcctPids_IMPL(arg0, arg1)
 #endif //__nvoc_gpu_acct_h_disabled
 
+NV_STATUS gpuacctGetAllProcAcctInfo_IMPL(struct GpuAccounting *arg0, NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS *arg1);
+#ifdef __nvoc_gpu_acct_h_disabled
+static inline NV_STATUS gpuacctGetAllProcAcctInfo(struct GpuAccounting *arg0, NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS *arg1) {
+    NV_ASSERT_FAILED_PRECOMP("GpuAccounting was disabled!");
+    return NV_ERR_NOT_SUPPORTED;
+}
+#else //__nvoc_gpu_acct_h_disabled
+#define gpuacctGetAllProcAcctInfo(arg0, arg1) gpuacctGetAllProcAcctInfo_IMPL(arg0, arg1)
+#endif //__nvoc_gpu_acct_h_disabled
+
 NV_STATUS gpuacctSetProcType_IMPL(struct GpuAccounting *arg0, NvU32 arg1, NvU32 arg2, NvU32 arg3, NvU32 arg4);
 #ifdef __nvoc_gpu_acct_h_disabled
 static inline NV_STATUS gpuacctSetProcType(struct GpuAccounting *arg0, NvU32 arg1, NvU32 arg2, NvU32 arg3, NvU32 arg4) {
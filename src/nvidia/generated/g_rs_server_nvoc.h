@@ -56,12 +56,30 @@ struct CLIENT_ENTRY
     struct RsClient       *pClient;
     NvHandle        hClient;
     NvU64           lockOwnerTid; ///< Thread id of the lock owner
+    volatile NvU32  refCount; ///< One reference for the client hash, plus one per thread waiting on pLock
 
 #if LOCK_VAL_ENABLED
     LOCK_VAL_LOCK   lockVal;
 #endif
 };
 
+/**
+ * Open-addressing index from client handle to CLIENT_ENTRY
+ *
+ * Slots are probed linearly without blocking, inside a read section of
+ * pClientListLock. Removed entries leave a tombstone behind so that probe chains
+ * stay intact; tombstones are dropped when the table is rebuilt. A replaced
+ * table is retired, and freed once no read section can still be walking it.
+ */
+typedef struct RS_CLIENT_HASH_TABLE
+{
+    NvU32                    size; ///< Number of slots, always a power of two
+    NvU32                    numLive; ///< Slots holding a CLIENT_ENTRY
+    NvU32                    numUsed; ///< Slots holding a CLIENT_ENTRY or a tombstone
+    CLIENT_ENTRY * volatile *pSlots;
+    struct RS_CLIENT_HASH_TABLE *pNextRetired; ///< Next table on RsServer::pClientHashRetired
+} RS_CLIENT_HASH_TABLE;
+
 /**
  * Base-class for objects that are shared among multiple
  * RsResources (including RsResources from other clients)
@@ -258,6 +276,8 @@ struct RsServer
     RS_PRIV_LEVEL             privilegeLevel;
 
     RsClientList             *pClientSortedList; ///< Bucket if linked List of clients (and their locks) owned by this server
+    RS_CLIENT_HASH_TABLE * volatile pClientHashTable; ///< Non-blocking lookup index over the same clients
+    RS_CLIENT_HASH_TABLE     *pClientHashRetired; ///< Replaced tables that lookups may still be walking
     NvU32                     clientCurrentHandleIndex;
 
     NvBool                    bConstructed; ///< Determines whether the server is ready to be used
@@ -44,6 +44,41 @@ void *_portMemAllocatorAlloc(PORT_MEM_ALLOCATOR *pAlloc, NvLength length);
 void _portMemAllocatorFree(PORT_MEM_ALLOCATOR *pAlloc, void *pMem);
 
 
+#if PORT_MEM_TRACK_USE_PERCPU_COUNTER || PORT_MEM_TRACK_SAMPLE_BYTES
+/** @brief Index of the current CPU, used only as a hint. Platform specific */
+NvU32 _portMemGetCpuIndex(void);
+#endif
+
+#if PORT_MEM_TRACK_USE_PERCPU_COUNTER
+/** @brief Number of per-CPU slots; CPUs beyond this share slots */
+#define PORT_MEM_COUNTER_PERCPU_SLOTS 16
+#define PORT_MEM_COUNTER_SLOT_SIZE    64
+
+/**
+ * @brief Per-CPU part of the allocations counter
+ *
+ * Frees may be counted on a different CPU than the matching allocations, so
+ * the active values of a single slot can wrap; only their sum is meaningful.
+ */
+typedef union PORT_MEM_COUNTER_SLOT
+{
+    struct
+    {
+        volatile NvU32    activeAllocs;
+        volatile NvU32    totalAllocs;
+        volatile NvLength activeSize;
+        volatile NvLength totalSize;
+    } values;
+    NvU8 padding[PORT_MEM_COUNTER_SLOT_SIZE];
+} PORT_MEM_COUNTER_SLOT;
+
+typedef struct PORT_MEM_COUNTER
+{
+    PORT_MEM_COUNTER_SLOT slots[PORT_MEM_COUNTER_PERCPU_SLOTS];
+    volatile NvU32    peakAllocs;
+    volatile NvLength peakSize;
+} PORT_MEM_COUNTER;
+#else
 typedef struct PORT_MEM_COUNTER
 {
     volatile NvU32    activeAllocs;
@@ -53,6 +88,18 @@ typedef struct PORT_MEM_COUNTER
     volatile NvLength totalSize;
     volatile NvLength peakSize;
 } PORT_MEM_COUNTER;
+#endif // PORT_MEM_TRACK_USE_PERCPU_COUNTER
+
+/** @brief Folded values of a @ref PORT_MEM_COUNTER */
+typedef struct PORT_MEM_COUNTER_VALUES
+{
+    NvU32    activeAllocs;
+    NvU32    totalAllocs;
+    NvU32    peakAllocs;
+    NvLength activeSize;
+    NvLength totalSize;
+    NvLength peakSize;
+} PORT_MEM_COUNTER_VALUES;
 
 typedef struct PORT_MEM_FENCE_HEAD
 {
@@ -72,6 +119,15 @@ typedef struct PORT_MEM_LIST
     struct PORT_MEM_LIST *pNext;
 } PORT_MEM_LIST;
 
+#if PORT_MEM_TRACK_SAMPLE_BYTES
+/** @brief Call-site sample attributed to an allocation, credited back on free */
+typedef struct PORT_MEM_SAMPLE_INFO
+{
+    NvU32 siteIndex;  // Index in the site table plus one, 0 if not sampled
+    NvU32 numSamples;
+} PORT_MEM_SAMPLE_INFO;
+#endif
+
 #if PORT_MEM_TRACK_USE_CALLERINFO
 
 #if PORT_MEM_TRACK_USE_CALLERINFO_IP
@@ -146,12 +202,16 @@ PORT_MEM_ALLOCATOR *portMemExAllocatorCreateLockedOnExistingBlock_CallerInfo(voi
 #endif // CALLERINFO
 
 
-#if PORT_MEM_TRACK_USE_FENCEPOSTS || PORT_MEM_TRACK_USE_ALLOCLIST || PORT_MEM_TRACK_USE_CALLERINFO
+#if PORT_MEM_TRACK_USE_FENCEPOSTS || PORT_MEM_TRACK_USE_ALLOCLIST || PORT_MEM_TRACK_USE_CALLERINFO || \
+    PORT_MEM_TRACK_SAMPLE_BYTES
 typedef struct PORT_MEM_HEADER
 {
 #if PORT_MEM_TRACK_USE_CALLERINFO
                                     PORT_MEM_CALLERINFO callerInfo;
 #endif
+#if PORT_MEM_TRACK_SAMPLE_BYTES
+                                    PORT_MEM_SAMPLE_INFO sample;
+#endif
 #if PORT_MEM_TRACK_USE_ALLOCLIST
                                     PORT_MEM_LIST list;
 #endif
@@ -231,6 +291,11 @@ typedef struct
     PORT_MEM_BITVECTOR_CHUNK *pChunks;
     NvU32 numChunks;
     //
+    // Index of the first 64-chunk word that may contain a free chunk. All
+    // chunks below it are allocated, so searches for free runs start here.
+    //
+    NvU32 firstFreeWord;
+    //
     // What follows are two bitvectors one next to another:
     //  - The first represents availability of chunks: 0=free, 1=allocated
     //  - The second represents allocation sizes: 1=last chunk of an allocation
@@ -904,6 +904,28 @@ void portMemExUnmapIOSpace(void *addr, NvU64 byteSize);
  */
 #define PORT_MEM_TRACK_USE_LOGGING 0
 #endif
+#if !defined(PORT_MEM_TRACK_USE_PERCPU_COUNTER)
+/**
+ * @brief Split the allocations counter into per-CPU slots
+ *
+ * Each alloc and free updates only the slot of the current CPU, and the slots
+ * are folded together when the counter is read. Peak values are only updated
+ * on read in this mode. Has no effect unless PORT_MEM_TRACK_USE_COUNTER is set.
+ * Default is off.
+ */
+#define PORT_MEM_TRACK_USE_PERCPU_COUNTER 0
+#endif
+#if !defined(PORT_MEM_TRACK_SAMPLE_BYTES)
+/**
+ * @brief Record the call site of one allocation per this many bytes allocated
+ *
+ * Sampled call sites are aggregated in a fixed size table that is printed by
+ * @ref portMemPrintTrackingInfo. Each allocation gets a small header naming
+ * its sampled site, so that frees are credited back and the live estimate
+ * stays accurate. Default is 0 (off).
+ */
+#define PORT_MEM_TRACK_SAMPLE_BYTES 0
+#endif
 
 /** @brief Nothing is printed unless @ref portMemPrintTrackingInfo is called */
 #define PORT_MEM_TRACK_PRINT_LEVEL_SILENT  0
@@ -790,6 +790,79 @@ NvBool portSyncExSafeToWake(void);
 NvU64 portSyncExGetInterruptLevel(void);
 #define portSyncExGetInterruptLevel_SUPPORTED PORT_IS_KERNEL_BUILD
 
+/**
+ * @brief Initializes a RWLock optimized for read-mostly data.
+ *
+ * Readers are counted in per-CPU shards instead of a single shared counter,
+ * so readers on different CPUs do not write to the same cache lines. Writers
+ * must wait for the sum over all shards to drop to zero, which makes write
+ * acquires more expensive than with @ref portSyncRwLockInitialize.
+ *
+ * Once initialized, the lock is used and destroyed through the regular
+ * portSyncRwLock* functions, with the same semantics. Waiting readers do not
+ * block a writer; new readers wait while a writer holds or waits for the lock.
+ *
+ * @return
+ *    - NV_OK if successful
+ *    - NV_ERR_INVALID_POINTER if pLock is NULL
+ *    - NV_ERR_NO_MEMORY if the shards could not be allocated
+ *
+ * @pre Windows: IRQL <= DISPATCH_LEVEL
+ * @pre Unix:    Non-interrupt context
+ */
+NV_STATUS portSyncExRwLockInitializeSharded(PORT_RWLOCK *pLock);
+/**
+ * @brief Creates a new sharded RWLock using the provided allocator.
+ *
+ * See @ref portSyncExRwLockInitializeSharded for details.
+ *
+ * @return NULL on failed allocation / initialization.
+ */
+PORT_RWLOCK *portSyncExRwLockCreateSharded(PORT_MEM_ALLOCATOR *pAllocator);
+#define portSyncExRwLockInitializeSharded_SUPPORTED (PORT_IS_KERNEL_BUILD && NVOS_IS_UNIX)
+#define portSyncExRwLockCreateSharded_SUPPORTED     (PORT_IS_KERNEL_BUILD && NVOS_IS_UNIX)
+
+/**
+ * @brief Enters a read-side section of a sharded RWLock without locking it.
+ *
+ * The caller is counted in the reader shard of its current CPU, but it neither
+ * waits for nor excludes writers. A writer that holds the lock and has
+ * unpublished a piece of memory can then use
+ * @ref portSyncExRwLockReadSectionsDrained to tell when nobody who may have
+ * seen that memory is left, and free it.
+ *
+ * Sections must be short and must not block.
+ *
+ * @return The shard to pass to @ref portSyncExRwLockExitReadSection
+ *
+ * @pre pLock was initialized with @ref portSyncExRwLockInitializeSharded
+ * @pre Windows: Any IRQL
+ * @pre Unix:    Any context
+ */
+NvU32 portSyncExRwLockEnterReadSection(PORT_RWLOCK *pLock);
+/**
+ * @brief Leaves a section entered with @ref portSyncExRwLockEnterReadSection.
+ *
+ * @param shard The value returned by the matching enter, which may have run on
+ *              a different CPU.
+ *
+ * @pre Windows: Any IRQL
+ * @pre Unix:    Any context
+ */
+void portSyncExRwLockExitReadSection(PORT_RWLOCK *pLock, NvU32 shard);
+/**
+ * @brief Checks whether all read-side sections have been left.
+ *
+ * Every section that was entered before this call and could still be running
+ * has been left if this returns NV_TRUE. It never waits.
+ *
+ * @pre The caller holds pLock for write
+ */
+NvBool portSyncExRwLockReadSectionsDrained(PORT_RWLOCK *pLock);
+#define portSyncExRwLockEnterReadSection_SUPPORTED    portSyncExRwLockInitializeSharded_SUPPORTED
+#define portSyncExRwLockExitReadSection_SUPPORTED     portSyncExRwLockInitializeSharded_SUPPORTED
+#define portSyncExRwLockReadSectionsDrained_SUPPORTED portSyncExRwLockInitializeSharded_SUPPORTED
+
 /**
  * @brief Disable preemption on a given CPU
  *
@@ -43,6 +43,10 @@ static NV_STATUS gpuacctFreeProcEntry(GPU_ACCT_PROC_DATA_STORE *, GPUACCT_PROC_E
 static NV_STATUS gpuacctCleanupDataStore(GPU_ACCT_PROC_DATA_STORE *);
 static NV_STATUS gpuacctDestroyDataStore(GPU_ACCT_PROC_DATA_STORE *);
 static NV_STATUS gpuacctInitDataStore(GPU_ACCT_PROC_DATA_STORE *);
+static void gpuacctInitDeadProcStore(GPUACCT_DEAD_PROC_STORE *);
+static void gpuacctDestroyDeadProcStore(GPUACCT_DEAD_PROC_STORE *);
+static GPUACCT_DEAD_PROC_RECORD *gpuacctLookupDeadProcRecord(GPUACCT_DEAD_PROC_STORE *, NvU32);
+static NV_STATUS gpuacctAddDeadProcRecord(GPUACCT_DEAD_PROC_STORE *, GPUACCT_GPU_INSTANCE_INFO *, GPUACCT_PROC_ENTRY *);
 static NV_STATUS gpuacctStartTimerCallbacks(OBJGPU *, GPUACCT_GPU_INSTANCE_INFO *);
 static void gpuacctStopTimerCallbacks(OBJGPU *, GPUACCT_GPU_INSTANCE_INFO *);
 static NV_STATUS gpuacctSampleGpuUtil(OBJGPU *, OBJTMR *, TMR_EVENT *);
@@ -114,11 +118,7 @@ static NV_STATUS gpuacctInitState
         pGpuAcct->gpuInstanceInfo[i].pTmrEvent      = NULL;
         pGpuAcct->gpuInstanceInfo[i].pSamplesParams = NULL;
 
-        status = gpuacctInitDataStore(&pGpuAcct->gpuInstanceInfo[i].deadProcAcctInfo);
-        if (status != NV_OK)
-        {
-            goto gpuacctInitState_cleanup;
-        }
+        gpuacctInitDeadProcStore(&pGpuAcct->gpuInstanceInfo[i].deadProcAcctInfo);
 
         status = gpuacctInitDataStore(&pGpuAcct->gpuInstanceInfo[i].liveProcAcctInfo);
         if (status != NV_OK)
@@ -133,7 +133,7 @@ gpuacctInitState_cleanup:
 
     for (j = 0; j <= i; j++)
     {
-        gpuacctDestroyDataStore(&pGpuAcct->gpuInstanceInfo[j].deadProcAcctInfo);
+        gpuacctDestroyDeadProcStore(&pGpuAcct->gpuInstanceInfo[j].deadProcAcctInfo);
         gpuacctDestroyDataStore(&pGpuAcct->gpuInstanceInfo[j].liveProcAcctInfo);
     }
 
@@ -192,6 +192,172 @@ gpuacctDestroyDataStore
     return NV_OK;
 }
 
+/*!
+ * Initializes an empty dead process store.
+ *
+ * @param[in]  pStore    Pointer to dead process store.
+ */
+static void
+gpuacctInitDeadProcStore
+(
+    GPUACCT_DEAD_PROC_STORE *pStore
+)
+{
+    pStore->pRecords = NULL;
+    pStore->count    = 0;
+    mapInitIntrusive(&pStore->procMap);
+    listInitIntrusive(&pStore->procList);
+}
+
+/*!
+ * Drops all records of a dead process store, keeping the record array.
+ *
+ * @param[in]  pStore    Pointer to dead process store.
+ */
+static void
+gpuacctClearDeadProcStore
+(
+    GPUACCT_DEAD_PROC_STORE *pStore
+)
+{
+    mapClear(&pStore->procMap);
+    listClear(&pStore->procList);
+    pStore->count = 0;
+}
+
+/*!
+ * Drops all records of a dead process store and frees its record array.
+ *
+ * @param[in]  pStore    Pointer to dead process store.
+ */
+static void
+gpuacctDestroyDeadProcStore
+(
+    GPUACCT_DEAD_PROC_STORE *pStore
+)
+{
+    gpuacctClearDeadProcStore(pStore);
+    portMemFree(pStore->pRecords);
+    pStore->pRecords = NULL;
+}
+
+/*!
+ * Looks up the record for a process in a dead process store.
+ *
+ * @param[in]  pStore    Pointer to dead process store.
+ * @param[in]  pid       PID of the process.
+ *
+ * @return  Pointer to the record, or NULL if not found.
+ */
+static GPUACCT_DEAD_PROC_RECORD *
+gpuacctLookupDeadProcRecord
+(
+    GPUACCT_DEAD_PROC_STORE *pStore,
+    NvU32 pid
+)
+{
+    return mapFind(&pStore->procMap, pid);
+}
+
+/*!
+ * Computes the lifetime average utilization of a process from its running
+ * sums, in the units reported by the accounting controls.
+ *
+ * @param[in]  pGpuInstanceInfo   GPUACCT gpu instance info.
+ * @param[in]  pEntry             Pointer to live process entry.
+ * @param[out] pGpuUtil           Average GR utilization.
+ * @param[out] pFbUtil            Average FB bandwidth utilization.
+ */
+static void
+gpuacctGetProcAvgUtil
+(
+    GPUACCT_GPU_INSTANCE_INFO *pGpuInstanceInfo,
+    GPUACCT_PROC_ENTRY *pEntry,
+    NvU32 *pGpuUtil,
+    NvU32 *pFbUtil
+)
+{
+    NvU32 sampleCount = pGpuInstanceInfo->totalSampleCount - pEntry->startSampleCount;
+
+    *pGpuUtil = pEntry->gpuUtil;
+    *pFbUtil  = pEntry->fbUtil;
+
+    if (sampleCount)
+    {
+        *pGpuUtil = (NvU32)(pEntry->sumUtil / sampleCount);
+        *pGpuUtil /= 100;
+
+        *pFbUtil = (NvU32)(pEntry->sumFbUtil / sampleCount);
+        *pFbUtil /= 100;
+    }
+}
+
+/*!
+ * Compacts a stopped process entry into a dead process record.
+ *
+ * @note Only the latest record is kept for a pid. If the store is full, the
+ * oldest record is dropped. Either way the slot of the dropped record is
+ * reused, so the records in use always stay at the front of the array.
+ *
+ * @param[in]  pStore             Pointer to dead process store.
+ * @param[in]  pGpuInstanceInfo   GPUACCT gpu instance info.
+ * @param[in]  pEntry             Pointer to the stopped process entry.
+ *
+ * @return  NV_OK
+ * @return  NV_ERR_NO_MEMORY
+ */
+static NV_STATUS
+gpuacctAddDeadProcRecord
+(
+    GPUACCT_DEAD_PROC_STORE *pStore,
+    GPUACCT_GPU_INSTANCE_INFO *pGpuInstanceInfo,
+    GPUACCT_PROC_ENTRY *pEntry
+)
+{
+    GPUACCT_DEAD_PROC_RECORD *pRecord;
+
+    if (pStore->pRecords == NULL)
+    {
+        pStore->pRecords = portMemAllocNonPaged(sizeof(GPUACCT_DEAD_PROC_RECORD) *
+                                                NV_MAX_DEAD_ACCT_PROCESS);
+        if (pStore->pRecords == NULL)
+        {
+            return NV_ERR_NO_MEMORY;
+        }
+        portMemSet(pStore->pRecords, 0, sizeof(GPUACCT_DEAD_PROC_RECORD) * NV_MAX_DEAD_ACCT_PROCESS);
+    }
+
+    pRecord = gpuacctLookupDeadProcRecord(pStore, pEntry->procId);
+    if ((pRecord == NULL) && (pStore->count == NV_MAX_DEAD_ACCT_PROCESS))
+    {
+        pRecord = listHead(&pStore->procList);
+        NV_ASSERT_OR_RETURN(pRecord != NULL, NV_ERR_INVALID_STATE);
+    }
+
+    if (pRecord != NULL)
+    {
+        mapRemove(&pStore->procMap, pRecord);
+        listRemove(&pStore->procList, pRecord);
+    }
+    else
+    {
+        pRecord = &pStore->pRecords[pStore->count++];
+    }
+
+    pRecord->procId     = pEntry->procId;
+    pRecord->maxGpuUtil = pEntry->maxGpuUtil / 100;
+    pRecord->maxFbUtil  = pEntry->maxFbUtil / 100;
+    pRecord->maxFbUsage = pEntry->maxFbUsage;
+    pRecord->startTime  = pEntry->startTime;
+    pRecord->endTime    = pEntry->endTime;
+    gpuacctGetProcAvgUtil(pGpuInstanceInfo, pEntry, &pRecord->gpuUtil, &pRecord->fbUtil);
+
+    NV_ASSERT_OR_RETURN(mapInsertExisting(&pStore->procMap, pRecord->procId, pRecord), NV_ERR_INVALID_STATE);
+    listAppendExisting(&pStore->procList, pRecord);
+
+    return NV_OK;
+}
+
 /*!
  * Destructor
  *
@@ -206,7 +372,7 @@ void gpuacctDestruct_IMPL
 
     for (i = 0; i < NV0000_CTRL_GPU_MAX_ATTACHED_GPUS; i++)
     {
-        gpuacctDestroyDataStore(&pGpuAcct->gpuInstanceInfo[i].deadProcAcctInfo);
+        gpuacctDestroyDeadProcStore(&pGpuAcct->gpuInstanceInfo[i].deadProcAcctInfo);
         gpuacctDestroyDataStore(&pGpuAcct->gpuInstanceInfo[i].liveProcAcctInfo);
     }
 }
@@ -509,10 +675,75 @@ gpuacctSampleGpuUtil_out:
     return status;
 }
 
+/*!
+ * Accumulates one utilization sample into the current interval of a process
+ * and links the process on the active chain the first time it is seen in
+ * this interval.
+ *
+ * @param[in]     pEntry        Process entry the sample is attributed to.
+ * @param[in]     util          Sample value.
+ * @param[in]     bFb           NV_TRUE for an FB sample, NV_FALSE for GR.
+ * @param[in,out] ppActiveHead  Head of the active chain.
+ */
+static void
+gpuacctAccumulateSample
+(
+    GPUACCT_PROC_ENTRY *pEntry,
+    NvU32 util,
+    NvBool bFb,
+    GPUACCT_PROC_ENTRY **ppActiveHead
+)
+{
+    GPUACCT_SAMPLE_INTERVAL *pInterval = &pEntry->curInterval;
+
+    if (bFb)
+    {
+        pEntry->sumFbUtil += util;
+        pInterval->maxFbUtil = NV_MAX(pInterval->maxFbUtil, util);
+    }
+    else
+    {
+        pEntry->sumUtil += util;
+        pInterval->maxGrUtil = NV_MAX(pInterval->maxGrUtil, util);
+    }
+
+    if (!pEntry->bActive)
+    {
+        pEntry->bActive = NV_TRUE;
+        pEntry->pNextActive = *ppActiveHead;
+        *ppActiveHead = pEntry;
+    }
+}
+
+/*!
+ * Closes the current sampling interval of a process, folding it into the
+ * process's lifetime maxima.
+ *
+ * @param[in]  pEntry    Process entry.
+ */
+static void
+gpuacctCloseSampleInterval
+(
+    GPUACCT_PROC_ENTRY *pEntry
+)
+{
+    pEntry->maxGpuUtil = NV_MAX(pEntry->maxGpuUtil, pEntry->curInterval.maxGrUtil);
+    pEntry->maxFbUtil  = NV_MAX(pEntry->maxFbUtil, pEntry->curInterval.maxFbUtil);
+
+    portMemSet(&pEntry->curInterval, 0, sizeof(pEntry->curInterval));
+    pEntry->pNextActive = NULL;
+    pEntry->bActive = NV_FALSE;
+}
+
 /*!
  * Processes gpu utilization samples, updating running average for all
  * processes running in one GPU instance.
  *
+ * @note Only processes that show up in the sample buffer are touched. Each is
+ * linked on an active chain as it is first seen and its interval aggregate is
+ * closed once the whole buffer has been consumed, so the cost of a tick
+ * depends on the number of samples rather than on the number of processes.
+ *
  * @param[in]  pGpuInstanceInfo   GPUACCT gpu instance info.
  * @param[in]  pUtilSampleBuffer  perfmon samples collected for the GPU
  *
@@ -525,6 +756,9 @@ gpuacctProcessGpuUtil
 )
 {
     GPUACCT_PROC_ENTRY *pEntry;
+    GPUACCT_PROC_ENTRY *pActiveHead = NULL;
+    GPUACCT_PROC_ENTRY *pCachedEntry = NULL;
+    NvU32 cachedPid = NV2080_GPUMON_PID_INVALID;
     NV_STATUS status = NV_OK;
     NvU64 maxTimeStamp;
     NvU32 index;
@@ -533,7 +767,9 @@ gpuacctProcessGpuUtil
 
     for (index = 0; index < NV2080_CTRL_PERF_GPUMON_SAMPLE_COUNT_PERFMON_UTIL; ++index)
     {
-        if (pUtilSampleBuffer[index].base.timeStamp <= pGpuInstanceInfo->lastUpdateTimestamp)
+        NV2080_CTRL_PERF_GPUMON_PERFMON_UTIL_SAMPLE *pSample = &pUtilSampleBuffer[index];
+
+        if (pSample->base.timeStamp <= pGpuInstanceInfo->lastUpdateTimestamp)
         {
             // Skip this input sample entry if the sample has already been processed
             // in previous gpuacctSampleGpuUtil() call.
@@ -541,59 +777,72 @@ gpuacctProcessGpuUtil
         }
 
         // Find max timestamp in the input pUtilSampleBuffer pmon sample set.
-        maxTimeStamp = NV_MAX(maxTimeStamp, pUtilSampleBuffer[index].base.timeStamp);
+        maxTimeStamp = NV_MAX(maxTimeStamp, pSample->base.timeStamp);
 
         pGpuInstanceInfo->totalSampleCount++;
 
-        pEntry = NULL;
-
         // If the PMU sample entry's pid or subpid is invalid, then we won't find the
         // pid-subpid entry in data store, so skip processing this PMU gr sample.
-        if (pUtilSampleBuffer[index].gr.procId       != NV2080_GPUMON_PID_INVALID &&
-            pUtilSampleBuffer[index].gr.subProcessID != NV2080_GPUMON_PID_INVALID)
+        if (pSample->gr.procId       != NV2080_GPUMON_PID_INVALID &&
+            pSample->gr.subProcessID != NV2080_GPUMON_PID_INVALID)
         {
-            // Find data store in which we should look up the PMU gr sample's pid/subpid.
-            status = gpuacctFindProcEntryFromPidSubpid(pGpuInstanceInfo,
-                                                       pUtilSampleBuffer[index].gr.procId,
-                                                       pUtilSampleBuffer[index].gr.subProcessID,
-                                                       &pEntry);
-            if (status == NV_OK && pEntry != NULL)
+            // Consecutive samples usually belong to the same process.
+            if (pSample->gr.procId != cachedPid)
+            {
+                pEntry = NULL;
+                status = gpuacctFindProcEntryFromPidSubpid(pGpuInstanceInfo,
+                                                           pSample->gr.procId,
+                                                           pSample->gr.subProcessID,
+                                                           &pEntry);
+                cachedPid    = pSample->gr.procId;
+                pCachedEntry = (status == NV_OK) ? pEntry : NULL;
+            }
+
+            if (pCachedEntry != NULL)
             {
-                pEntry->sumUtil += pUtilSampleBuffer[index].gr.util;
+                gpuacctAccumulateSample(pCachedEntry, pSample->gr.util, NV_FALSE, &pActiveHead);
 
                 NV_PRINTF(LEVEL_INFO, "pid=%d subPid=%d util=%4d sumUtil=%lld sampleCount=%u (total=%u)\n",
-                          pUtilSampleBuffer[index].gr.procId,
-                          pUtilSampleBuffer[index].gr.subProcessID,
-                          pUtilSampleBuffer[index].gr.util,
-                          pEntry->sumUtil,
-                          pGpuInstanceInfo->totalSampleCount - pEntry->startSampleCount,
+                          pSample->gr.procId,
+                          pSample->gr.subProcessID,
+                          pSample->gr.util,
+                          pCachedEntry->sumUtil,
+                          pGpuInstanceInfo->totalSampleCount - pCachedEntry->startSampleCount,
                           pGpuInstanceInfo->totalSampleCount);
             }
         }
 
         // If the PMU sample entry's pid or subpid is invalid, then we won't find the
         // pid-subpid entry in data store, so skip processing this PMU fb sample.
-        if (pUtilSampleBuffer[index].fb.procId       != NV2080_GPUMON_PID_INVALID &&
-            pUtilSampleBuffer[index].fb.subProcessID != NV2080_GPUMON_PID_INVALID)
+        if (pSample->fb.procId       != NV2080_GPUMON_PID_INVALID &&
+            pSample->fb.subProcessID != NV2080_GPUMON_PID_INVALID)
         {
-            // If GR sample and FB sample are of same pid-subpid, no need to find the proc entry again.
-            if (pUtilSampleBuffer[index].gr.procId       != pUtilSampleBuffer[index].fb.procId ||
-                pUtilSampleBuffer[index].gr.subProcessID != pUtilSampleBuffer[index].fb.subProcessID)
+            if (pSample->fb.procId != cachedPid)
             {
-                // Find data store in which we should look up the PMU fb sample's pid/subpid.
                 pEntry = NULL;
                 status = gpuacctFindProcEntryFromPidSubpid(pGpuInstanceInfo,
-                                                           pUtilSampleBuffer[index].fb.procId,
-                                                           pUtilSampleBuffer[index].fb.subProcessID,
+                                                           pSample->fb.procId,
+                                                           pSample->fb.subProcessID,
                                                            &pEntry);
+                cachedPid    = pSample->fb.procId;
+                pCachedEntry = (status == NV_OK) ? pEntry : NULL;
             }
-            if (status == NV_OK && pEntry != NULL)
+
+            if (pCachedEntry != NULL)
             {
-                pEntry->sumFbUtil += pUtilSampleBuffer[index].fb.util;
+                gpuacctAccumulateSample(pCachedEntry, pSample->fb.util, NV_TRUE, &pActiveHead);
             }
         }
     }
 
+    // Close the interval for the processes that were active in it.
+    while (pActiveHead != NULL)
+    {
+        pEntry = pActiveHead;
+        pActiveHead = pEntry->pNextActive;
+        gpuacctCloseSampleInterval(pEntry);
+    }
+
     // Update max time stamp found in current input sample.
     pGpuInstanceInfo->lastUpdateTimestamp = maxTimeStamp;
 }
@@ -678,8 +927,8 @@ out:
 /*!
  * Stops gpu accounting for the process.
  *
- * @note Stops the timer for computing gpu utilization and moves the process
- * entry from list of live processes to dead processes.
+ * @note Stops the timer for computing gpu utilization and compacts the process
+ * entry from list of live processes into the store of dead processes.
  *
  * @param[in]  pGpuAcct    GPUACCT object pointer
  * @param[in]  gpuInstance gpu instance.
@@ -692,8 +941,8 @@ out:
  * @return  Other
  *     Bubbles up errors from:
  *         * gpuacctLookupProcEntry
- *         * gpuacctRemoveProcEntry
- *         * gpuacctAddProcEntry
+ *         * gpuacctAddDeadProcRecord
+ *         * gpuacctFreeProcEntry
  */
 NV_STATUS
 gpuacctStopGpuAccounting_IMPL
@@ -707,9 +956,8 @@ gpuacctStopGpuAccounting_IMPL
     OBJGPU *pGpu;
     GPUACCT_GPU_INSTANCE_INFO *pGpuInstanceInfo;
     GPU_ACCT_PROC_DATA_STORE *pLiveDS;
-    GPU_ACCT_PROC_DATA_STORE *pDeadDS;
+    GPUACCT_DEAD_PROC_STORE *pDeadStore;
     GPUACCT_PROC_ENTRY *pEntry;
-    GPUACCT_PROC_ENTRY *pOldEntry;
     NV_STATUS status;
     NvU32 searchPid;
     NvU32 vmIndex;
@@ -729,7 +977,7 @@ gpuacctStopGpuAccounting_IMPL
             return NV_OK;
         }
         pLiveDS = &pGpuInstanceInfo->liveProcAcctInfo;
-        pDeadDS = &pGpuInstanceInfo->deadProcAcctInfo;
+        pDeadStore = &pGpuInstanceInfo->deadProcAcctInfo;
 
         searchPid = pid;
     }
@@ -756,48 +1004,19 @@ gpuacctStopGpuAccounting_IMPL
 
     NV_PRINTF(LEVEL_INFO, "pid=%d\n", searchPid);
 
-    // Move process entry to dead process list for process that run on gpu.
+    // Keep the final accounting data for process that run on gpu.
     if (pEntry->procType == NV_GPUACCT_PROC_TYPE_GPU)
     {
-        // Only keep the latest entry for the pid.
-        status = gpuacctLookupProcEntry(pDeadDS, searchPid, &pOldEntry);
-        if (status != NV_OK)
-        {
-            return status;
-        }
-
-        if (pOldEntry != NULL)
-        {
-            status = gpuacctFreeProcEntry(pDeadDS, pOldEntry);
-            if (status != NV_OK)
-            {
-                return status;
-            }
-        }
-
-        // Move the entry to dead procs data store
-        status = gpuacctRemoveProcEntry(pLiveDS, pEntry);
-        if (status != NV_OK)
-        {
-            return status;
-        }
-
-        status = gpuacctAddProcEntry(pDeadDS, pEntry, NV_FALSE);
-        if (status != NV_OK)
-        {
-            portMemFree(pEntry);
-            return status;
-        }
-    }
-    else
-    {
-        status = gpuacctFreeProcEntry(pLiveDS, pEntry);
+        status = gpuacctAddDeadProcRecord(pDeadStore, pGpuInstanceInfo, pEntry);
         if (status != NV_OK)
         {
-            return status;
+            NV_PRINTF(LEVEL_ERROR, "Failed to record dead pid=%d\n", searchPid);
         }
     }
 
+    // The live entry goes away either way, the record holds all that is left.
+    NV_ASSERT_OK_OR_RETURN(gpuacctFreeProcEntry(pLiveDS, pEntry));
+
     return status;
 }
 
@@ -922,13 +1141,13 @@ gpuacctGetProcAcctInfo_IMPL
 )
 {
     GPUACCT_PROC_ENTRY *pEntry;
+    GPUACCT_DEAD_PROC_RECORD *pRecord = NULL;
     GPU_ACCT_PROC_DATA_STORE *pDS = NULL;
     NV_STATUS status;
     OBJGPU *pGpu;
     NvU32 vmIndex;
+    NvU32 searchPid;
     GPUACCT_GPU_INSTANCE_INFO *pGpuInstanceInfo;
-    NvU32 sampleCount;
-    NvBool isLiveProcess;
 
     NV_ASSERT_OR_RETURN(pParams != NULL, NV_ERR_INVALID_ARGUMENT);
 
@@ -938,77 +1157,48 @@ gpuacctGetProcAcctInfo_IMPL
     pGpuInstanceInfo = &pGpuAcct->gpuInstanceInfo[pGpu->gpuInstance];
     vmIndex = NV_INVALID_VM_INDEX;
 
-    isLiveProcess = NV_FALSE;
+    searchPid = (vmIndex == NV_INVALID_VM_INDEX) ? pParams->pid : pParams->subPid;
 
-    // Try finding process entry in dead process list.
+    // Try finding process record in dead process store.
     if (vmIndex == NV_INVALID_VM_INDEX)
     {
-        pDS = &pGpuInstanceInfo->deadProcAcctInfo;
+        pRecord = gpuacctLookupDeadProcRecord(&pGpuInstanceInfo->deadProcAcctInfo, searchPid);
     }
-    NV_ASSERT_OR_RETURN(pDS != NULL, NV_ERR_INVALID_STATE);
 
-    if (vmIndex == NV_INVALID_VM_INDEX)
+    if (pRecord != NULL)
     {
-        status = gpuacctLookupProcEntry(pDS, pParams->pid, &pEntry);
+        pParams->maxFbUsage = pRecord->maxFbUsage;
+        pParams->gpuUtil    = pRecord->gpuUtil;
+        pParams->fbUtil     = pRecord->fbUtil;
+        pParams->startTime  = pRecord->startTime;
+        pParams->endTime    = pRecord->endTime;
+
+        return NV_OK;
     }
-    else
+
+    // If process record not found in dead process store, try finding in live
+    // process list.
+    if (vmIndex == NV_INVALID_VM_INDEX)
     {
-        status = gpuacctLookupProcEntry(pDS, pParams->subPid, &pEntry);
+        pDS = &pGpuInstanceInfo->liveProcAcctInfo;
     }
+    NV_ASSERT_OR_RETURN(pDS != NULL, NV_ERR_INVALID_STATE);
 
+    status = gpuacctLookupProcEntry(pDS, searchPid, &pEntry);
     if (status != NV_OK)
     {
         return status;
     }
 
-    // If process entry not found in dead process list, try finding in live
-    // process list.
-    if (pEntry == NULL)
+    if ((pEntry == NULL) || (pEntry->procType != NV_GPUACCT_PROC_TYPE_GPU))
     {
-        isLiveProcess = NV_TRUE;
-
-        if (vmIndex == NV_INVALID_VM_INDEX)
-        {
-            pDS = &pGpuInstanceInfo->liveProcAcctInfo;
-        }
-        NV_ASSERT_OR_RETURN(pDS != NULL, NV_ERR_INVALID_STATE);
-
-        if (vmIndex == NV_INVALID_VM_INDEX)
-        {
-            status = gpuacctLookupProcEntry(pDS, pParams->pid, &pEntry);
-        }
-        else
-        {
-            status = gpuacctLookupProcEntry(pDS, pParams->subPid, &pEntry);
-        }
-        if (status != NV_OK)
-        {
-            return status;
-        }
-
-        if ((pEntry == NULL) || (pEntry->procType != NV_GPUACCT_PROC_TYPE_GPU))
-        {
-            return NV_ERR_OBJECT_NOT_FOUND;
-        }
+        return NV_ERR_OBJECT_NOT_FOUND;
     }
 
     pParams->maxFbUsage = pEntry->maxFbUsage;
-    pParams->gpuUtil    = pEntry->gpuUtil;
-    pParams->fbUtil     = pEntry->fbUtil;
     pParams->startTime  = pEntry->startTime;
     pParams->endTime    = pEntry->endTime;
-
-    sampleCount = isLiveProcess == NV_TRUE ?
-                  pGpuInstanceInfo->totalSampleCount - pEntry->startSampleCount:
-                  pEntry->totalSampleCount;
-    if (sampleCount)
-    {
-        pParams->gpuUtil = (NvU32)(pEntry->sumUtil / sampleCount);
-        pParams->gpuUtil /= 100;
-
-        pParams->fbUtil = (NvU32)(pEntry->sumFbUtil / sampleCount);
-        pParams->fbUtil /= 100;
-    }
+    gpuacctGetProcAvgUtil(pGpuInstanceInfo, pEntry, &pParams->gpuUtil, &pParams->fbUtil);
 
     return NV_OK;
 }
@@ -1031,7 +1221,8 @@ gpuacctGetAcctPids_IMPL
 )
 {
     GPUACCT_PROC_ENTRY *pEntry;
-    GPU_ACCT_PROC_LIST *pList;
+    GPUACCT_DEAD_PROC_STORE *pDeadStore = NULL;
+    GPU_ACCT_PROC_LIST *pList = NULL;
     OBJGPU *pGpu;
     NvU32 count;
     NvU32 vmIndex;
@@ -1052,7 +1243,19 @@ gpuacctGetAcctPids_IMPL
 
     if (vmIndex == NV_INVALID_VM_INDEX)
     {
-        pList = &pGpuInstanceInfo->deadProcAcctInfo.procList;
+        pDeadStore = &pGpuInstanceInfo->deadProcAcctInfo;
+    }
+    NV_ASSERT_OR_RETURN(pDeadStore != NULL, NV_ERR_INVALID_STATE);
+
+    GPU_ACCT_DEAD_PROC_LISTIter deadIter = listIterAll(&pDeadStore->procList);
+    while (listIterNext(&deadIter))
+    {
+        pParams->pidTbl[count++] = deadIter.pValue->procId;
+    }
+
+    if (vmIndex == NV_INVALID_VM_INDEX)
+    {
+        pList = &pGpuInstanceInfo->liveProcAcctInfo.procList;
     }
     NV_ASSERT_OR_RETURN(pList != NULL, NV_ERR_INVALID_STATE);
 
@@ -1060,29 +1263,125 @@ gpuacctGetAcctPids_IMPL
     while (listIterNext(&iter))
     {
         pEntry = iter.pValue;
-        if (pEntry)
+        if (pEntry && pEntry->procType == NV_GPUACCT_PROC_TYPE_GPU)
         {
             pParams->pidTbl[count++] = pEntry->procId;
         }
     }
 
+    pParams->pidCount = count;
+
+    return NV_OK;
+}
+
+/*!
+ * Gets accounting data for a batch of processes in one call.
+ *
+ * @note Processes are enumerated in the same order as gpuacctGetAcctPids,
+ * dead processes first, starting at pParams->startIndex.
+ *
+ * @param[in]     pGpuAcct    GPUACCT object pointer
+ * @param[in,out] pParams     NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS pointer.
+ *
+ * @return  NV_OK
+ * @return  NV_ERR_INVALID_ARGUMENT
+ * @return  NV_ERR_INVALID_STATE
+ */
+NV_STATUS
+gpuacctGetAllProcAcctInfo_IMPL
+(
+    GpuAccounting *pGpuAcct,
+    NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS *pParams
+)
+{
+    NV0000_CTRL_GPUACCT_PROC_ACCOUNTING_INFO *pInfo;
+    GPUACCT_DEAD_PROC_STORE *pDeadStore = NULL;
+    GPU_ACCT_PROC_LIST *pList = NULL;
+    GPUACCT_GPU_INSTANCE_INFO *pGpuInstanceInfo;
+    OBJGPU *pGpu;
+    NvU32 vmIndex;
+    NvU32 procIndex;
+    NvU32 count;
+
+    NV_ASSERT_OR_RETURN(pParams != NULL, NV_ERR_INVALID_ARGUMENT);
+
+    pGpu = gpumgrGetGpuFromId(pParams->gpuId);
+    NV_ASSERT_OR_RETURN(pGpu != NULL, NV_ERR_INVALID_ARGUMENT);
+
+    pGpuInstanceInfo = &pGpuAcct->gpuInstanceInfo[pGpu->gpuInstance];
+    vmIndex = NV_INVALID_VM_INDEX;
+
+    pParams->procCount    = 0;
+    pParams->bMoreEntries = NV_FALSE;
+    procIndex = 0;
+    count = 0;
+
     if (vmIndex == NV_INVALID_VM_INDEX)
     {
-        pList = &pGpuInstanceInfo->liveProcAcctInfo.procList;
+        pDeadStore = &pGpuInstanceInfo->deadProcAcctInfo;
+        pList      = &pGpuInstanceInfo->liveProcAcctInfo.procList;
     }
-    NV_ASSERT_OR_RETURN(pList != NULL, NV_ERR_INVALID_STATE);
+    NV_ASSERT_OR_RETURN(pDeadStore != NULL && pList != NULL, NV_ERR_INVALID_STATE);
+
+    GPU_ACCT_DEAD_PROC_LISTIter deadIter = listIterAll(&pDeadStore->procList);
+    while (listIterNext(&deadIter))
+    {
+        GPUACCT_DEAD_PROC_RECORD *pRecord = deadIter.pValue;
+
+        if (procIndex++ < pParams->startIndex)
+            continue;
+
+        if (count == NV0000_CTRL_GPUACCT_PROC_INFO_BATCH_MAX_COUNT)
+        {
+            pParams->bMoreEntries = NV_TRUE;
+            goto done;
+        }
 
-    iter = listIterAll(pList);
+        pInfo = &pParams->procInfo[count++];
+
+        pInfo->pid        = pRecord->procId;
+        pInfo->gpuUtil    = pRecord->gpuUtil;
+        pInfo->fbUtil     = pRecord->fbUtil;
+        pInfo->maxGpuUtil = pRecord->maxGpuUtil;
+        pInfo->maxFbUtil  = pRecord->maxFbUtil;
+        pInfo->bIsRunning = NV_FALSE;
+        pInfo->maxFbUsage = pRecord->maxFbUsage;
+        pInfo->startTime  = pRecord->startTime;
+        pInfo->endTime    = pRecord->endTime;
+    }
+
+    GPU_ACCT_PROC_LISTIter iter = listIterAll(pList);
     while (listIterNext(&iter))
     {
-        pEntry = iter.pValue;
-        if (pEntry && pEntry->procType == NV_GPUACCT_PROC_TYPE_GPU)
+        GPUACCT_PROC_ENTRY *pEntry = iter.pValue;
+
+        if ((pEntry == NULL) || (pEntry->procType != NV_GPUACCT_PROC_TYPE_GPU))
+            continue;
+
+        if (procIndex++ < pParams->startIndex)
+            continue;
+
+        if (count == NV0000_CTRL_GPUACCT_PROC_INFO_BATCH_MAX_COUNT)
         {
-            pParams->pidTbl[count++] = pEntry->procId;
+            pParams->bMoreEntries = NV_TRUE;
+            goto done;
         }
+
+        pInfo = &pParams->procInfo[count++];
+
+        pInfo->pid        = pEntry->procId;
+        pInfo->maxGpuUtil = pEntry->maxGpuUtil / 100;
+        pInfo->maxFbUtil  = pEntry->maxFbUtil / 100;
+        pInfo->bIsRunning = NV_TRUE;
+        pInfo->maxFbUsage = pEntry->maxFbUsage;
+        pInfo->startTime  = pEntry->startTime;
+        pInfo->endTime    = pEntry->endTime;
+        gpuacctGetProcAvgUtil(pGpuInstanceInfo, pEntry, &pInfo->gpuUtil, &pInfo->fbUtil);
     }
 
-    pParams->pidCount = count;
+done:
+    pParams->procCount = count;
+    pParams->nextIndex = pParams->startIndex + count;
 
     return NV_OK;
 }
@@ -1372,7 +1671,7 @@ gpuacctClearAccountingData_IMPL
 
     if (vmPid == NV_INVALID_VM_PID)
     {
-        gpuacctCleanupDataStore(&gpuInstanceInfo->deadProcAcctInfo);
+        gpuacctClearDeadProcStore(&gpuInstanceInfo->deadProcAcctInfo);
     }
 
     return NV_OK;
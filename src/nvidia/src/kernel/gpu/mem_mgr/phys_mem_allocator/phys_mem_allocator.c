@@ -194,7 +194,15 @@ pmaInitialize(PMA *pPma, NvU32 initFlags)
         goto error;
     }
 
+    //
+    // Every allocation takes this lock for read, while writes only happen when
+    // the scrubber is validated or invalidated, so use per-CPU reader shards.
+    //
+#if PORT_IS_FUNC_SUPPORTED(portSyncExRwLockInitializeSharded)
+    status = portSyncExRwLockInitializeSharded(pPma->pScrubberValidLock);
+#else
     status = portSyncRwLockInitialize(pPma->pScrubberValidLock);
+#endif
     if (status != NV_OK)
     {
         portMemFree(pPma->pScrubberValidLock);
@@ -1431,6 +1431,28 @@ cliresCtrlCmdGpuAcctGetAccountingPids_IMPL
     return gpuacctGetAcctPids(pGpuAcct, pAcctPidsParams);
 }
 
+NV_STATUS
+cliresCtrlCmdGpuAcctGetAllProcAccountingInfo_IMPL
+(
+    RmClientResource *pRmCliRes,
+    NV0000_CTRL_GPUACCT_GET_ALL_PROC_ACCOUNTING_INFO_PARAMS *pParams
+)
+{
+    OBJSYS     *pSys = SYS_GET_INSTANCE();
+    GpuAccounting *pGpuAcct = SYS_GET_GPUACCT(pSys);
+    OBJGPU     *pGpu;
+
+    LOCK_ASSERT_AND_RETURN(rmApiLockIsOwner());
+
+    pGpu = gpumgrGetGpuFromId(pParams->gpuId);
+    if (pGpu == NULL)
+    {
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    return gpuacctGetAllProcAcctInfo(pGpuAcct, pParams);
+}
+
 
 static void
 getHwbcInfo
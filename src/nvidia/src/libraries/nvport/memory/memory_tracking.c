@@ -131,6 +131,90 @@ _portMemCounterInit
 {
     portMemSet(pCounter, 0, sizeof(*pCounter));
 }
+
+#if PORT_MEM_TRACK_USE_PERCPU_COUNTER
+static NV_INLINE void
+_portMemCounterInc
+(
+    PORT_MEM_COUNTER *pCounter,
+    NvLength          size
+)
+{
+    PORT_MEM_COUNTER_SLOT *pSlot;
+
+    pSlot = &pCounter->slots[_portMemGetCpuIndex() % PORT_MEM_COUNTER_PERCPU_SLOTS];
+
+    //
+    // The thread may migrate, or share the slot with another CPU, so the
+    // updates still need to be atomic. They no longer bounce between CPUs.
+    //
+    portAtomicIncrementU32(&pSlot->values.activeAllocs);
+    portAtomicIncrementU32(&pSlot->values.totalAllocs);
+    if (PORT_MEM_TRACK_USE_FENCEPOSTS)
+    {
+        portAtomicAddSize(&pSlot->values.activeSize, size);
+    }
+    portAtomicAddSize(&pSlot->values.totalSize, size);
+}
+static NV_INLINE void
+_portMemCounterDec
+(
+    PORT_MEM_COUNTER *pCounter,
+    void             *pMem
+)
+{
+    PORT_MEM_COUNTER_SLOT *pSlot;
+
+    pSlot = &pCounter->slots[_portMemGetCpuIndex() % PORT_MEM_COUNTER_PERCPU_SLOTS];
+
+    portAtomicDecrementU32(&pSlot->values.activeAllocs);
+    if (PORT_MEM_TRACK_USE_FENCEPOSTS)
+    {
+        portAtomicSubSize(&pSlot->values.activeSize,
+                          ((PORT_MEM_FENCE_HEAD *)pMem-1)->blockSize);
+    }
+}
+
+//
+// Folds all per-CPU slots. Peak values are only sampled here, so they reflect
+// the highest active values observed by any reader.
+//
+static void
+_portMemCounterRead
+(
+    PORT_MEM_COUNTER        *pCounter,
+    PORT_MEM_COUNTER_VALUES *pValues
+)
+{
+    NvU32 i;
+
+    portMemSet(pValues, 0, sizeof(*pValues));
+    for (i = 0; i < PORT_MEM_COUNTER_PERCPU_SLOTS; i++)
+    {
+        pValues->activeAllocs += pCounter->slots[i].values.activeAllocs;
+        pValues->totalAllocs  += pCounter->slots[i].values.totalAllocs;
+        pValues->activeSize   += pCounter->slots[i].values.activeSize;
+        pValues->totalSize    += pCounter->slots[i].values.totalSize;
+    }
+
+    while (1)
+    {
+        NvU32 peakAllocs = pCounter->peakAllocs;
+        if (pValues->activeAllocs <= peakAllocs)
+            break;
+        portAtomicCompareAndSwapU32(&pCounter->peakAllocs, pValues->activeAllocs, peakAllocs);
+    }
+    while (1)
+    {
+        NvLength peakSize = pCounter->peakSize;
+        if (pValues->activeSize <= peakSize)
+            break;
+        portAtomicCompareAndSwapSize(&pCounter->peakSize, pValues->activeSize, peakSize);
+    }
+    pValues->peakAllocs = pCounter->peakAllocs;
+    pValues->peakSize   = pCounter->peakSize;
+}
+#else // PORT_MEM_TRACK_USE_PERCPU_COUNTER
 static NV_INLINE void
 _portMemCounterInc
 (
@@ -179,6 +263,21 @@ _portMemCounterDec
                           ((PORT_MEM_FENCE_HEAD *)pMem-1)->blockSize);
     }
 }
+static void
+_portMemCounterRead
+(
+    PORT_MEM_COUNTER        *pCounter,
+    PORT_MEM_COUNTER_VALUES *pValues
+)
+{
+    pValues->activeAllocs = pCounter->activeAllocs;
+    pValues->totalAllocs  = pCounter->totalAllocs;
+    pValues->peakAllocs   = pCounter->peakAllocs;
+    pValues->activeSize   = pCounter->activeSize;
+    pValues->totalSize    = pCounter->totalSize;
+    pValues->peakSize     = pCounter->peakSize;
+}
+#endif // PORT_MEM_TRACK_USE_PERCPU_COUNTER
 
 #define PORT_MEM_COUNTER_INIT(pCounter)      _portMemCounterInit(pCounter)
 #define PORT_MEM_COUNTER_INC(pCounter, size) _portMemCounterInc(pCounter, size)
@@ -425,6 +524,181 @@ _portMemLogAdd
 #endif // LOGGING
 
 
+//
+// Sampled call-site tracing implementation
+//
+#if PORT_MEM_TRACK_SAMPLE_BYTES
+#define PORT_MEM_SAMPLE_CPU_SLOTS 16
+#define PORT_MEM_SAMPLE_SITES     256
+
+/** @brief Per-CPU byte countdown to the next sample, padded to a cache line */
+typedef union PORT_MEM_SAMPLE_COUNTDOWN
+{
+    volatile NvLength bytesLeft;
+    NvU8 padding[64];
+} PORT_MEM_SAMPLE_COUNTDOWN;
+
+/** @brief Aggregated samples for a single call site. callSite 0 is unused. */
+typedef struct PORT_MEM_SAMPLE_SITE
+{
+    volatile NvUPtr callSite;
+    volatile NvU32  numSamples;
+    volatile NvU32  numAllocs;
+    volatile NvU32  liveSamples;  // numSamples minus those of freed allocations
+} PORT_MEM_SAMPLE_SITE;
+
+static struct
+{
+    PORT_MEM_SAMPLE_COUNTDOWN countdown[PORT_MEM_SAMPLE_CPU_SLOTS];
+    PORT_MEM_SAMPLE_SITE      sites[PORT_MEM_SAMPLE_SITES];
+    volatile NvU32            droppedSamples;
+} portMemSampling;
+
+static void
+_portMemSampleInit(void)
+{
+    NvU32 i;
+
+    portMemSet(&portMemSampling, 0, sizeof(portMemSampling));
+    for (i = 0; i < PORT_MEM_SAMPLE_CPU_SLOTS; i++)
+        portMemSampling.countdown[i].bytesLeft = PORT_MEM_TRACK_SAMPLE_BYTES;
+}
+
+//
+// Adds numSamples to the entry for callSite in an open addressing table.
+// Entries are claimed with a CAS on the callSite and never removed, so lookup
+// needs no lock. Samples are dropped (and counted) when the table is full.
+//
+// Returns the index of the entry plus one, or 0 if the samples were dropped.
+//
+static NvU32
+_portMemSampleRecord
+(
+    NvUPtr callSite,
+    NvU32  numSamples
+)
+{
+    NvU32 hash = (NvU32)((NvU64)callSite * 0x9E3779B97F4A7C15ULL >> 32);
+    NvU32 i;
+
+    if (callSite == 0)
+        callSite = 1;
+
+    for (i = 0; i < PORT_MEM_SAMPLE_SITES; i++)
+    {
+        PORT_MEM_SAMPLE_SITE *pSite = &portMemSampling.sites[(hash + i) % PORT_MEM_SAMPLE_SITES];
+        NvUPtr site = pSite->callSite;
+
+        if (site == 0)
+        {
+            if (portAtomicCompareAndSwapSize(&pSite->callSite, callSite, 0))
+                site = callSite;
+            else
+                site = pSite->callSite;
+        }
+        if (site == callSite)
+        {
+            portAtomicAddU32(&pSite->numSamples, numSamples);
+            portAtomicAddU32(&pSite->liveSamples, numSamples);
+            portAtomicIncrementU32(&pSite->numAllocs);
+            return ((hash + i) % PORT_MEM_SAMPLE_SITES) + 1;
+        }
+    }
+    portAtomicIncrementU32(&portMemSampling.droppedSamples);
+    return 0;
+}
+
+static NV_INLINE void
+_portMemSampleAlloc
+(
+    NvUPtr   callSite,
+    void    *pMem,
+    NvLength size
+)
+{
+    PORT_MEM_SAMPLE_INFO *pSample = &((PORT_MEM_HEADER*)pMem - 1)->sample;
+    PORT_MEM_SAMPLE_COUNTDOWN *pCountdown;
+    NvLength bytesLeft;
+    NvU32 numSamples = 0;
+
+    pCountdown = &portMemSampling.countdown[_portMemGetCpuIndex() % PORT_MEM_SAMPLE_CPU_SLOTS];
+
+    //
+    // Countdown races between CPUs sharing a slot only skew the sampling
+    // interval; they never corrupt the site table.
+    //
+    // One sample where the countdown runs out, then one per full interval.
+    bytesLeft = pCountdown->bytesLeft;
+    if (size >= bytesLeft)
+    {
+        NvLength rest = size - bytesLeft;
+
+        numSamples = (NvU32)(1 + rest / PORT_MEM_TRACK_SAMPLE_BYTES);
+        bytesLeft  = PORT_MEM_TRACK_SAMPLE_BYTES - rest % PORT_MEM_TRACK_SAMPLE_BYTES;
+    }
+    else
+    {
+        bytesLeft -= size;
+    }
+    pCountdown->bytesLeft = bytesLeft;
+
+    pSample->siteIndex  = (numSamples != 0) ? _portMemSampleRecord(callSite, numSamples) : 0;
+    pSample->numSamples = numSamples;
+}
+
+static NV_INLINE void
+_portMemSampleFree
+(
+    void *pMem
+)
+{
+    PORT_MEM_SAMPLE_INFO *pSample = &((PORT_MEM_HEADER*)pMem - 1)->sample;
+
+    if (pSample->siteIndex != 0)
+    {
+        portAtomicSubU32(&portMemSampling.sites[pSample->siteIndex - 1].liveSamples,
+                         pSample->numSamples);
+    }
+}
+
+static void
+_portMemSamplePrint(void)
+{
+    NvU32 i;
+
+    portDbgPrintf("Sampled allocation sites (1 sample per %llu bytes):\n",
+                  (NvU64)PORT_MEM_TRACK_SAMPLE_BYTES);
+    for (i = 0; i < PORT_MEM_SAMPLE_SITES; i++)
+    {
+        PORT_MEM_SAMPLE_SITE *pSite = &portMemSampling.sites[i];
+
+        if (pSite->callSite == 0)
+            continue;
+
+        portDbgPrintf(" - site 0x%016llx: %u sampled allocations, ~%llu bytes allocated, ~%llu bytes live\n",
+                      (NvU64)pSite->callSite, pSite->numAllocs,
+                      (NvU64)pSite->numSamples * PORT_MEM_TRACK_SAMPLE_BYTES,
+                      (NvU64)pSite->liveSamples * PORT_MEM_TRACK_SAMPLE_BYTES);
+    }
+    if (portMemSampling.droppedSamples != 0)
+    {
+        portDbgPrintf(" - %u samples dropped, site table full\n",
+                      portMemSampling.droppedSamples);
+    }
+}
+
+#define PORT_MEM_SAMPLE_INIT()                       _portMemSampleInit()
+#define PORT_MEM_SAMPLE_ALLOC(callSite, pMem, size)  _portMemSampleAlloc(callSite, pMem, size)
+#define PORT_MEM_SAMPLE_FREE(pMem)                   _portMemSampleFree(pMem)
+#define PORT_MEM_SAMPLE_PRINT()                      _portMemSamplePrint()
+#else
+#define PORT_MEM_SAMPLE_INIT()
+#define PORT_MEM_SAMPLE_ALLOC(x, y, z)
+#define PORT_MEM_SAMPLE_FREE(x)
+#define PORT_MEM_SAMPLE_PRINT()
+#endif // PORT_MEM_TRACK_SAMPLE_BYTES
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // Main memory tracking implementation
@@ -444,7 +718,8 @@ static void    *_portMemAllocatorAllocExistingWrapper(PORT_MEM_ALLOCATOR *pAlloc
 static void     _portMemAllocatorFreeExistingWrapper(PORT_MEM_ALLOCATOR *pAlloc, void *pMem);
 
 static void _portMemTrackingRelease(PORT_MEM_ALLOCATOR_TRACKING *pTracking);
-static void _portMemTrackAlloc(PORT_MEM_ALLOCATOR_TRACKING *pTracking, void *pMem, NvLength size PORT_MEM_CALLERINFO_COMMA_TYPE_PARAM);
+static void _portMemTrackAlloc(PORT_MEM_ALLOCATOR_TRACKING *pTracking, void *pMem, NvLength size, NvUPtr callSite PORT_MEM_CALLERINFO_COMMA_TYPE_PARAM);
+static void *_portMemAllocatorAllocAtSite(PORT_MEM_ALLOCATOR *pAlloc, NvLength length, NvUPtr callSite PORT_MEM_CALLERINFO_COMMA_TYPE_PARAM);
 static void _portMemTrackFree(PORT_MEM_ALLOCATOR_TRACKING *pTracking, void *pMem);
 
 
@@ -547,6 +822,7 @@ portMemInitialize(void)
         portMemGlobals.alloc.nonPaged.pTracking = &portMemGlobals.alloc.pagedImpl.tracking;
     }
     PORT_MEM_LOG_INIT();
+    PORT_MEM_SAMPLE_INIT();
 }
 void
 portMemShutdown(NvBool bForceSilent)
@@ -587,7 +863,8 @@ portMemAllocPaged
 )
 {
     PORT_MEM_ALLOCATOR *pAlloc = portMemAllocatorGetGlobalPaged();
-    return _portMemAllocatorAlloc(pAlloc, length PORT_MEM_CALLERINFO_COMMA_PARAM);
+    return _portMemAllocatorAllocAtSite(pAlloc, length, portUtilGetReturnAddress()
+                                        PORT_MEM_CALLERINFO_COMMA_PARAM);
 }
 
 void *
@@ -598,7 +875,8 @@ portMemAllocNonPaged
 )
 {
     PORT_MEM_ALLOCATOR *pAlloc = portMemAllocatorGetGlobalNonPaged();
-    return _portMemAllocatorAlloc(pAlloc, length PORT_MEM_CALLERINFO_COMMA_PARAM);
+    return _portMemAllocatorAllocAtSite(pAlloc, length, portUtilGetReturnAddress()
+                                        PORT_MEM_CALLERINFO_COMMA_PARAM);
 }
 
 void
@@ -757,6 +1035,23 @@ _portMemAllocatorAlloc
     NvLength length
     PORT_MEM_CALLERINFO_COMMA_TYPE_PARAM
 )
+{
+    return _portMemAllocatorAllocAtSite(pAlloc, length, portUtilGetReturnAddress()
+                                        PORT_MEM_CALLERINFO_COMMA_PARAM);
+}
+
+//
+// callSite is the return address of the public allocation entry point, used
+// to attribute sampled allocations.
+//
+static void *
+_portMemAllocatorAllocAtSite
+(
+    PORT_MEM_ALLOCATOR *pAlloc,
+    NvLength length,
+    NvUPtr callSite
+    PORT_MEM_CALLERINFO_COMMA_TYPE_PARAM
+)
 {
     void *pMem = NULL;
     if (pAlloc == NULL)
@@ -786,7 +1081,7 @@ _portMemAllocatorAlloc
     if (pMem != NULL)
     {
         pMem = PORT_MEM_ADD_HEADER_PTR(pMem);
-        _portMemTrackAlloc(_portMemGetTracking(pAlloc), pMem, length
+        _portMemTrackAlloc(_portMemGetTracking(pAlloc), pMem, length, callSite
                            PORT_MEM_CALLERINFO_COMMA_PARAM);
     }
     return pMem;
@@ -936,6 +1231,11 @@ next_tracking:
 
         pTracking = pTracking->pNext;
     }
+
+    if (pAllocator == NULL)
+    {
+        PORT_MEM_SAMPLE_PRINT();
+    }
 }
 
 #if portMemExTrackingGetActiveStats_SUPPORTED
@@ -947,12 +1247,14 @@ portMemExTrackingGetActiveStats
 )
 {
     PORT_MEM_ALLOCATOR_TRACKING *pTracking = _portMemGetTracking(pAllocator);
+    PORT_MEM_COUNTER_VALUES counter;
     if (pTracking == NULL)
     {
         return NV_ERR_OBJECT_NOT_FOUND;
     }
-    pStats->numAllocations = pTracking->counter.activeAllocs;
-    pStats->usefulSize     = pTracking->counter.activeSize;
+    _portMemCounterRead(&pTracking->counter, &counter);
+    pStats->numAllocations = counter.activeAllocs;
+    pStats->usefulSize     = counter.activeSize;
     pStats->metaSize       = pStats->numAllocations * PORT_MEM_STAGING_SIZE;
     pStats->allocatedSize  = pStats->usefulSize + pStats->metaSize;
     return NV_OK;
@@ -968,12 +1270,14 @@ portMemExTrackingGetTotalStats
 )
 {
     PORT_MEM_ALLOCATOR_TRACKING *pTracking = _portMemGetTracking(pAllocator);
+    PORT_MEM_COUNTER_VALUES counter;
     if (pTracking == NULL)
     {
         return NV_ERR_OBJECT_NOT_FOUND;
     }
-    pStats->numAllocations = pTracking->counter.totalAllocs;
-    pStats->usefulSize     = pTracking->counter.totalSize;
+    _portMemCounterRead(&pTracking->counter, &counter);
+    pStats->numAllocations = counter.totalAllocs;
+    pStats->usefulSize     = counter.totalSize;
     pStats->metaSize       = pStats->numAllocations * PORT_MEM_STAGING_SIZE;
     pStats->allocatedSize  = pStats->usefulSize + pStats->metaSize;
     return NV_OK;
@@ -989,12 +1293,14 @@ portMemExTrackingGetPeakStats
 )
 {
     PORT_MEM_ALLOCATOR_TRACKING *pTracking = _portMemGetTracking(pAllocator);
+    PORT_MEM_COUNTER_VALUES counter;
     if (pTracking == NULL)
     {
         return NV_ERR_OBJECT_NOT_FOUND;
     }
-    pStats->numAllocations = pTracking->counter.peakAllocs;
-    pStats->usefulSize     = pTracking->counter.peakSize;
+    _portMemCounterRead(&pTracking->counter, &counter);
+    pStats->numAllocations = counter.peakAllocs;
+    pStats->usefulSize     = counter.peakSize;
     pStats->metaSize       = pStats->numAllocations * PORT_MEM_STAGING_SIZE;
     pStats->allocatedSize  = pStats->usefulSize + pStats->metaSize;
     return NV_OK;
@@ -1055,9 +1361,19 @@ _portMemTrackingRelease
     PORT_MEM_ALLOCATOR_TRACKING *pTracking
 )
 {
+    NvBool bLeaked = NV_FALSE;
+
     if (pTracking == NULL) return;
 
-    if (pTracking->counter.activeAllocs != 0)
+#if PORT_MEM_TRACK_USE_COUNTER
+    {
+        PORT_MEM_COUNTER_VALUES counter;
+        _portMemCounterRead(&pTracking->counter, &counter);
+        bLeaked = (counter.activeAllocs != 0);
+    }
+#endif
+
+    if (bLeaked)
     {
         PORT_MEM_PRINT_ERROR("Allocator %p released with memory allocations\n", pTracking->pAllocator);
 #if (PORT_MEM_TRACK_PRINT_LEVEL > PORT_MEM_TRACK_PRINT_LEVEL_SILENT)
@@ -1075,11 +1391,13 @@ _portMemTrackAlloc
 (
     PORT_MEM_ALLOCATOR_TRACKING *pTracking,
     void                        *pMem,
-    NvLength                     size
+    NvLength                     size,
+    NvUPtr                       callSite
     PORT_MEM_CALLERINFO_COMMA_TYPE_PARAM
 )
 {
     PORT_UNREFERENCED_VARIABLE(pMem);
+    PORT_UNREFERENCED_VARIABLE(callSite);
     if (pTracking == NULL) return;
     PORT_MEM_PRINT_INFO("Allocating %u bytes at address %p", size, pMem);
     PORT_MEM_PRINT_INFO(PORT_MEM_CALLERINFO_PRINT_ARGS(PORT_MEM_CALLERINFO_PARAM));
@@ -1091,6 +1409,7 @@ _portMemTrackAlloc
     PORT_MEM_LIST_ADD(pTracking, pMem);
     PORT_MEM_CALLERINFO_INIT_MEM(pMem);
     PORT_MEM_LOG_ALLOC(pTracking->pAllocator, pMem, size);
+    PORT_MEM_SAMPLE_ALLOC(callSite, pMem, size);
 }
 
 static void
@@ -1109,6 +1428,7 @@ _portMemTrackFree
     PORT_MEM_FENCE_CHECK(pTracking->pAllocator, pMem);
     PORT_MEM_LIST_REMOVE(pTracking, pMem);
     PORT_MEM_LOG_FREE(pTracking->pAllocator, pMem);
+    PORT_MEM_SAMPLE_FREE(pMem);
 }
 
 
@@ -1154,18 +1474,185 @@ _portMemAllocatorReleaseWrapper
     portMemFree(pAllocator);
 }
 
-/// @todo Add these as intrinsics to UTIL module
-static NV_INLINE NvBool _isBitSet(NvU32 *vect, NvU32 bit)
+//
+// Bitvector helpers for allocators over existing blocks.
+//
+// The availability vector is scanned 64 bits at a time, using trailing zero
+// counts to measure runs of free/used chunks, instead of testing one bit per
+// iteration. Ranges are set and cleared with per-word masks.
+//
+// The bits array is only guaranteed to be 32-bit aligned and 2*numChunks bits
+// long, so 64-bit words are assembled from two NvU32 halves, and bits at or
+// beyond numChunks (which belong to the allocation-size vector) read as set.
+//
+static NV_INLINE NvU64
+_portMemBitVectorGetAvailWord
+(
+    const PORT_MEM_BITVECTOR *pBitVector,
+    NvU32                     wordIdx
+)
 {
-    return !!(vect[bit/32] & NVBIT32(bit%32));
+    NvU32 firstBit = wordIdx * 64;
+    NvU32 validBits = NV_MIN(pBitVector->numChunks - firstBit, 64U);
+    NvU64 word = pBitVector->bits[wordIdx * 2];
+
+    if (validBits > 32)
+    {
+        word |= (NvU64)pBitVector->bits[wordIdx * 2 + 1] << 32;
+    }
+    if (validBits < 64)
+    {
+        word |= ~(NvU64)0 << validBits;
+    }
+    return word;
 }
-static NV_INLINE void _setBit(NvU32 *vect, NvU32 bit)
+
+//
+// Finds the first run of chunksNeeded free chunks, starting the search from
+// the word at pBitVector->firstFreeWord. Returns NV_FALSE if no run fits.
+//
+static NvBool
+_portMemBitVectorFindFreeRun
+(
+    PORT_MEM_BITVECTOR *pBitVector,
+    NvU32               chunksNeeded,
+    NvU32              *pFirstChunk
+)
 {
-    vect[bit/32] |= NVBIT32(bit%32);
+    NvU32 numWords = NV_DIV_AND_CEIL(pBitVector->numChunks, 64);
+    NvU32 runStart = pBitVector->firstFreeWord * 64;
+    NvU32 runLength = 0;
+    NvBool bSeenFree = NV_FALSE;
+    NvU32 wordIdx;
+
+    for (wordIdx = pBitVector->firstFreeWord; wordIdx < numWords; wordIdx++)
+    {
+        NvU64 word = _portMemBitVectorGetAvailWord(pBitVector, wordIdx);
+        NvU32 bit = 0;
+
+        if (word == ~(NvU64)0)
+        {
+            //
+            // Every word below the first one with a free chunk is full, so
+            // later searches can start there.
+            //
+            if (!bSeenFree)
+                pBitVector->firstFreeWord = wordIdx + 1;
+
+            runLength = 0;
+            runStart = (wordIdx + 1) * 64;
+            continue;
+        }
+
+        bSeenFree = NV_TRUE;
+
+        while (bit < 64)
+        {
+            NvU32 freeBits = portUtilCountTrailingZeros64(word >> bit);
+            NvU32 usedBits;
+
+            if (freeBits > 64 - bit)
+                freeBits = 64 - bit;
+
+            runLength += freeBits;
+            if (runLength >= chunksNeeded)
+            {
+                *pFirstChunk = runStart;
+                return NV_TRUE;
+            }
+
+            bit += freeBits;
+            if (bit == 64)
+                break;
+
+            usedBits = portUtilCountTrailingZeros64(~word >> bit);
+            if (usedBits > 64 - bit)
+                usedBits = 64 - bit;
+
+            bit += usedBits;
+            runLength = 0;
+            runStart = wordIdx * 64 + bit;
+        }
+
+        // Not enough chunks left past the current run start
+        if ((runStart >= pBitVector->numChunks) ||
+            (pBitVector->numChunks - runStart < chunksNeeded))
+            break;
+    }
+    return NV_FALSE;
 }
-static NV_INLINE void _clearBit(NvU32 *vect, NvU32 bit)
+
+static NV_INLINE NvU32
+_portMemBitRangeMask
+(
+    NvU32 bit,
+    NvU32 count
+)
+{
+    return (count >= 32) ? ~0U : (NVBIT32(count) - 1) << bit;
+}
+
+static void
+_portMemBitVectorSetRange
+(
+    NvU32 *pBits,
+    NvU32  first,
+    NvU32  count
+)
 {
-    vect[bit/32] &= ~NVBIT32(bit%32);
+    while (count > 0)
+    {
+        NvU32 bit = first % 32;
+        NvU32 n = NV_MIN(count, 32 - bit);
+
+        pBits[first / 32] |= _portMemBitRangeMask(bit, n);
+        first += n;
+        count -= n;
+    }
+}
+
+static void
+_portMemBitVectorClearRange
+(
+    NvU32 *pBits,
+    NvU32  first,
+    NvU32  count
+)
+{
+    while (count > 0)
+    {
+        NvU32 bit = first % 32;
+        NvU32 n = NV_MIN(count, 32 - bit);
+
+        pBits[first / 32] &= ~_portMemBitRangeMask(bit, n);
+        first += n;
+        count -= n;
+    }
+}
+
+//
+// Returns the index of the first set bit in [first, limit), or limit if none.
+//
+static NvU32
+_portMemBitVectorFindNextSet
+(
+    const NvU32 *pBits,
+    NvU32        first,
+    NvU32        limit
+)
+{
+    while (first < limit)
+    {
+        NvU32 word = pBits[first / 32] >> (first % 32);
+
+        if (word != 0)
+        {
+            first += portUtilCountTrailingZeros32(word);
+            return NV_MIN(first, limit);
+        }
+        first = NV_ALIGN_DOWN(first, 32U) + 32;
+    }
+    return limit;
 }
 
 static PORT_MEM_ALLOCATOR *
@@ -1225,6 +1712,7 @@ _portMemAllocatorCreateOnExistingBlock
         bitVectorSize = (NvU32)((NvU8*)pBitVector->pChunks - (NvU8*)pBitVector->bits);
     }
     portMemSet(pBitVector->bits, 0, bitVectorSize);
+    pBitVector->firstFreeWord = 0;
 
     PORT_MEM_PRINT_INFO("Acquired preallocated block allocator %p (%llu bytes) ", pAllocator, (NvU64)blockSizeBytes);
     PORT_MEM_PRINT_INFO(PORT_MEM_CALLERINFO_PRINT_ARGS(PORT_MEM_CALLERINFO_PARAM));
@@ -1240,12 +1728,11 @@ _portMemAllocatorAllocExistingWrapper
 {
     NvU32 chunksNeeded = (NvU32)NV_DIV_AND_CEIL(length, PORT_MEM_BITVECTOR_CHUNK_SIZE);
     void *pMem = NULL;
-    NvU32 chunksFound = 0;
-    NvU32 i;
+    NvU32 firstChunk;
     PORT_MEM_BITVECTOR *pBitVector = (PORT_MEM_BITVECTOR*)(pAlloc->pImpl);
     PORT_SPINLOCK *pSpinlock = (PORT_SPINLOCK*)(pBitVector->pSpinlock);
 
-    if (chunksNeeded > pBitVector->numChunks)
+    if ((chunksNeeded == 0) || (chunksNeeded > pBitVector->numChunks))
     {
         return NULL;
     }
@@ -1253,43 +1740,14 @@ _portMemAllocatorAllocExistingWrapper
     {
         portSyncSpinlockAcquire(pSpinlock);
     }
-    for (i = 0; i < pBitVector->numChunks; i++)
+    if (_portMemBitVectorFindFreeRun(pBitVector, chunksNeeded, &firstChunk))
     {
-        NvBool bWholeWordSet;
-        bWholeWordSet = pBitVector->bits[i/32] == ~0U;
-        if (bWholeWordSet || (_isBitSet(pBitVector->bits, i)))
-        {
-            // Chunk not available as whole.
-            chunksFound = 0;
-            // Skip fully set words
-            if (bWholeWordSet)
-            {
-                i += 31;
-            }
-            if (chunksNeeded > (pBitVector->numChunks - i - (bWholeWordSet ? 1 : 0)))
-            {
-                break;
-            }
-        }
-        else
-        {
-            chunksFound++;
-            if (chunksFound == chunksNeeded)
-            {
-                NvU32 j;
-                NvU32 firstAllocatedChunk = i - chunksFound + 1;
-
-                pMem = pBitVector->pChunks[firstAllocatedChunk];
-                // Mark all acquired chunks as occupied
-                for (j = firstAllocatedChunk; j <= i; j++)
-                {
-                    _setBit(pBitVector->bits, j);
-                }
-                // Mark last chunk of allocation
-                _setBit(pBitVector->bits, pBitVector->numChunks + i);
-                break;
-            }
-        }
+        pMem = pBitVector->pChunks[firstChunk];
+        // Mark all acquired chunks as occupied
+        _portMemBitVectorSetRange(pBitVector->bits, firstChunk, chunksNeeded);
+        // Mark last chunk of allocation
+        _portMemBitVectorSetRange(pBitVector->bits,
+                                  pBitVector->numChunks + firstChunk + chunksNeeded - 1, 1);
     }
     if (pSpinlock != NULL)
     {
@@ -1306,33 +1764,45 @@ _portMemAllocatorFreeExistingWrapper
 )
 {
     PORT_MEM_BITVECTOR_CHUNK *pChunk = (PORT_MEM_BITVECTOR_CHUNK *)pMem;
-    NvU32 i;
+    NvU32 firstChunk;
+    NvU32 lastBit;
     PORT_MEM_BITVECTOR *pBitVector = (PORT_MEM_BITVECTOR*)(pAlloc->pImpl);
     PORT_SPINLOCK *pSpinlock = (PORT_SPINLOCK*)(pBitVector->pSpinlock);
 
     if (((NvUPtr)pMem < (NvUPtr)pBitVector->pChunks) ||
-        ((NvUPtr)pMem > (NvUPtr)(pBitVector->pChunks + pBitVector->numChunks)))
+        ((NvUPtr)pMem >= (NvUPtr)(pBitVector->pChunks + pBitVector->numChunks)))
     {
         // pMem not inside this allocator.
         PORT_BREAKPOINT_CHECKED();
         return;
     }
 
+    firstChunk = (NvU32)(pChunk - pBitVector->pChunks);
+
     if (pSpinlock != NULL)
     {
         portSyncSpinlockAcquire(pSpinlock);
     }
-    for (i = (NvU32)(pChunk - pBitVector->pChunks); i < pBitVector->numChunks; i++)
+
+    lastBit = _portMemBitVectorFindNextSet(pBitVector->bits,
+                                           pBitVector->numChunks + firstChunk,
+                                           2 * pBitVector->numChunks);
+    if (lastBit < 2 * pBitVector->numChunks)
     {
-        // Mark chunk as free
-        _clearBit(pBitVector->bits, i);
-        if (_isBitSet(pBitVector->bits, pBitVector->numChunks + i))
-        {
-            // Clear last-allocation-bit and bail
-            _clearBit(pBitVector->bits, pBitVector->numChunks + i);
-            break;
-        }
+        // Mark chunks as free, and clear last-allocation-bit
+        _portMemBitVectorClearRange(pBitVector->bits, firstChunk,
+                                    lastBit - pBitVector->numChunks - firstChunk + 1);
+        _portMemBitVectorClearRange(pBitVector->bits, lastBit, 1);
+
+        if (firstChunk / 64 < pBitVector->firstFreeWord)
+            pBitVector->firstFreeWord = firstChunk / 64;
     }
+    else
+    {
+        // No allocation ends at or after pMem; the bitvector is inconsistent.
+        PORT_BREAKPOINT_CHECKED();
+    }
+
     if (pSpinlock != NULL)
     {
         portSyncSpinlockRelease(pSpinlock);
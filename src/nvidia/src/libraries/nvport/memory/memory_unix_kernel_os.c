@@ -76,6 +76,14 @@ _portMemFreeUntracked
     }
 }
 
+#if PORT_MEM_TRACK_USE_PERCPU_COUNTER || PORT_MEM_TRACK_SAMPLE_BYTES
+NvU32
+_portMemGetCpuIndex(void)
+{
+    return os_get_cpu_number();
+}
+#endif
+
 void *
 portMemCopy
 (
@@ -30,12 +30,37 @@
 #ifndef _NVPORT_SYNC_RWLOCK_DEF_H_
 #define _NVPORT_SYNC_RWLOCK_DEF_H_
 
+/// @brief Maximum number of reader shards of a sharded PORT_RWLOCK
+#define PORT_RWLOCK_MAX_SHARDS 64
+
+/// @brief Reader count of one shard, padded to avoid false sharing
+typedef union PORT_RWLOCK_READER_SHARD
+{
+    volatile NvS32 numReaders;
+    NvU8 padding[64];
+} PORT_RWLOCK_READER_SHARD;
+
 struct PORT_RWLOCK
 {
     PORT_SEMAPHORE *pSemRead;
     PORT_SEMAPHORE *pSemWrite;
     volatile NvS32 numReaders;
     PORT_MEM_ALLOCATOR *pAllocator;
+
+    //
+    // Only used by locks created with portSyncExRwLockInitializeSharded.
+    // pShards is NULL for regular locks.
+    //
+    PORT_RWLOCK_READER_SHARD *pShards;
+    NvU32 numShards;
+    volatile NvU32 bWriterActive;
+    // Signaled by readers leaving while bWriterActive is set
+    PORT_SEMAPHORE *pSemDrained;
 };
 
+/// @brief Index of the current CPU, used only as a hint. Platform specific
+NvU32 _portSyncGetCpuIndex(void);
+/// @brief Number of CPUs in the system. Platform specific
+NvU32 _portSyncGetCpuCount(void);
+
 #endif
@@ -61,10 +61,289 @@ portSyncRwLockInitialize
 
     pLock->numReaders = 0;
     pLock->pAllocator = NULL;
+    pLock->pShards = NULL;
+    pLock->numShards = 0;
+    pLock->bWriterActive = NV_FALSE;
+    pLock->pSemDrained = NULL;
 
     return NV_OK;
 }
 
+//
+// Sharded (big-reader) variant
+//
+// Readers increment the shard of their current CPU, then check bWriterActive.
+// Writers set bWriterActive, then wait for the sum over all shards to reach
+// zero. Both sides use full-barrier atomics, so either the reader sees the
+// writer and backs out of the same shard it incremented, or the writer sees
+// the reader's increment. A reader may be released on a different CPU than it
+// was acquired on, so individual shards can go negative; only the sum matters.
+//
+// pSemWrite serializes writers, and blocked readers wait on it as well. A
+// writer waiting for the shards to drain sleeps on pSemDrained, which every
+// reader leaving a shard signals while bWriterActive is set. The count this
+// leaves behind only causes spurious rechecks, and is drained when the writer
+// releases the lock.
+//
+#if PORT_IS_FUNC_SUPPORTED(portSyncExRwLockInitializeSharded)
+NV_STATUS
+portSyncExRwLockInitializeSharded
+(
+    PORT_RWLOCK *pLock
+)
+{
+    PORT_MEM_ALLOCATOR *pAllocator = portMemAllocatorGetGlobalNonPaged();
+    NvU32 numShards;
+    NV_STATUS status;
+
+    status = portSyncRwLockInitialize(pLock);
+    if (status != NV_OK)
+    {
+        return status;
+    }
+
+    numShards = _portSyncGetCpuCount();
+    if (numShards == 0)
+        numShards = 1;
+    if (numShards > PORT_RWLOCK_MAX_SHARDS)
+        numShards = PORT_RWLOCK_MAX_SHARDS;
+
+    pLock->pSemDrained = portSyncSemaphoreCreate(pAllocator, 0);
+    if (pLock->pSemDrained == NULL)
+    {
+        portSyncSemaphoreDestroy(pLock->pSemRead);
+        portSyncSemaphoreDestroy(pLock->pSemWrite);
+        return NV_ERR_NO_MEMORY;
+    }
+
+    pLock->pShards = PORT_ALLOC(pAllocator, numShards * sizeof(*pLock->pShards));
+    if (pLock->pShards == NULL)
+    {
+        portSyncSemaphoreDestroy(pLock->pSemRead);
+        portSyncSemaphoreDestroy(pLock->pSemWrite);
+        portSyncSemaphoreDestroy(pLock->pSemDrained);
+        pLock->pSemDrained = NULL;
+        return NV_ERR_NO_MEMORY;
+    }
+    portMemSet(pLock->pShards, 0, numShards * sizeof(*pLock->pShards));
+    pLock->numShards = numShards;
+
+    return NV_OK;
+}
+
+PORT_RWLOCK *
+portSyncExRwLockCreateSharded
+(
+    PORT_MEM_ALLOCATOR *pAllocator
+)
+{
+    PORT_RWLOCK *pLock;
+    PORT_ASSERT_CHECKED(pAllocator != NULL);
+
+    pLock = PORT_ALLOC(pAllocator, portSyncRwLockSize);
+    if (pLock != NULL)
+    {
+        if (portSyncExRwLockInitializeSharded(pLock) != NV_OK)
+        {
+            PORT_FREE(pAllocator, pLock);
+            return NULL;
+        }
+        pLock->pAllocator = pAllocator;
+    }
+    return pLock;
+}
+
+//
+// Leave a reader shard, waking a writer that may be waiting for the last
+// reader to drain.
+//
+static void
+_portSyncRwLockShardedLeave
+(
+    PORT_RWLOCK *pLock,
+    PORT_RWLOCK_READER_SHARD *pShard
+)
+{
+    portAtomicDecrementS32(&pShard->numReaders);
+    if (pLock->bWriterActive)
+    {
+        portSyncSemaphoreRelease(pLock->pSemDrained);
+    }
+}
+
+static NvBool
+_portSyncRwLockShardedTryRead
+(
+    PORT_RWLOCK *pLock
+)
+{
+    PORT_RWLOCK_READER_SHARD *pShard;
+
+    pShard = &pLock->pShards[_portSyncGetCpuIndex() % pLock->numShards];
+
+    portAtomicIncrementS32(&pShard->numReaders);
+    if (!pLock->bWriterActive)
+    {
+        return NV_TRUE;
+    }
+
+    // Back out of the same shard, so that the writer's sum stays exact.
+    _portSyncRwLockShardedLeave(pLock, pShard);
+    return NV_FALSE;
+}
+
+static NvBool
+_portSyncRwLockShardedReadersDrained
+(
+    PORT_RWLOCK *pLock
+)
+{
+    NvS32 numReaders = 0;
+    NvU32 i;
+
+    for (i = 0; i < pLock->numShards; i++)
+    {
+        numReaders += pLock->pShards[i].numReaders;
+    }
+
+    PORT_ASSERT_CHECKED(numReaders >= 0);
+    return numReaders == 0;
+}
+
+static void
+_portSyncRwLockShardedAcquireRead
+(
+    PORT_RWLOCK *pLock
+)
+{
+    while (!_portSyncRwLockShardedTryRead(pLock))
+    {
+        // Wait for the writer to finish, then retry.
+        portSyncSemaphoreAcquire(pLock->pSemWrite);
+        portSyncSemaphoreRelease(pLock->pSemWrite);
+    }
+}
+
+static void
+_portSyncRwLockShardedReleaseRead
+(
+    PORT_RWLOCK *pLock
+)
+{
+    PORT_RWLOCK_READER_SHARD *pShard;
+
+    pShard = &pLock->pShards[_portSyncGetCpuIndex() % pLock->numShards];
+    _portSyncRwLockShardedLeave(pLock, pShard);
+}
+
+static void
+_portSyncRwLockShardedAcquireWrite
+(
+    PORT_RWLOCK *pLock
+)
+{
+    portSyncSemaphoreAcquire(pLock->pSemWrite);
+    portAtomicSetU32(&pLock->bWriterActive, NV_TRUE);
+
+    //
+    // Readers can hold the lock for a long time (PMA keeps pScrubberValidLock
+    // across a whole allocation), so sleep until one leaves and recheck.
+    //
+    while (!_portSyncRwLockShardedReadersDrained(pLock))
+    {
+        portSyncSemaphoreAcquire(pLock->pSemDrained);
+    }
+}
+
+static void
+_portSyncRwLockShardedReleaseWrite
+(
+    PORT_RWLOCK *pLock
+)
+{
+    portAtomicSetU32(&pLock->bWriterActive, NV_FALSE);
+
+    // Drop wakeups from readers that left after the shards drained.
+    while (portSyncSemaphoreAcquireConditional(pLock->pSemDrained))
+    {
+    }
+
+    portSyncSemaphoreRelease(pLock->pSemWrite);
+}
+
+static NvBool
+_portSyncRwLockShardedAcquireWriteConditional
+(
+    PORT_RWLOCK *pLock
+)
+{
+    if (!portSyncSemaphoreAcquireConditional(pLock->pSemWrite))
+    {
+        return NV_FALSE;
+    }
+    portAtomicSetU32(&pLock->bWriterActive, NV_TRUE);
+
+    if (!_portSyncRwLockShardedReadersDrained(pLock))
+    {
+        _portSyncRwLockShardedReleaseWrite(pLock);
+        return NV_FALSE;
+    }
+    return NV_TRUE;
+}
+
+//
+// Read-side sections only touch the shards. They leave through the shard they
+// entered on, so each one adds either 0 or 1 to that shard while the writer
+// sums them. A section that entered after the writer read its shard started
+// after whatever the writer unpublished was gone.
+//
+NvU32
+portSyncExRwLockEnterReadSection
+(
+    PORT_RWLOCK *pLock
+)
+{
+    NvU32 shard;
+
+    PORT_ASSERT_CHECKED(pLock != NULL && pLock->pShards != NULL);
+
+    shard = _portSyncGetCpuIndex() % pLock->numShards;
+    portAtomicIncrementS32(&pLock->pShards[shard].numReaders);
+    return shard;
+}
+
+void
+portSyncExRwLockExitReadSection
+(
+    PORT_RWLOCK *pLock,
+    NvU32 shard
+)
+{
+    PORT_ASSERT_CHECKED(pLock != NULL && shard < pLock->numShards);
+    _portSyncRwLockShardedLeave(pLock, &pLock->pShards[shard]);
+}
+
+NvBool
+portSyncExRwLockReadSectionsDrained
+(
+    PORT_RWLOCK *pLock
+)
+{
+    PORT_ASSERT_CHECKED(pLock != NULL && pLock->bWriterActive);
+    return _portSyncRwLockShardedReadersDrained(pLock);
+}
+
+#define PORT_RWLOCK_IS_SHARDED(pLock) ((pLock)->pShards != NULL)
+#else
+#define PORT_RWLOCK_IS_SHARDED(pLock) NV_FALSE
+#define _portSyncRwLockShardedTryRead(pLock)                  NV_FALSE
+#define _portSyncRwLockShardedAcquireRead(pLock)
+#define _portSyncRwLockShardedReleaseRead(pLock)
+#define _portSyncRwLockShardedAcquireWrite(pLock)
+#define _portSyncRwLockShardedAcquireWriteConditional(pLock)  NV_FALSE
+#define _portSyncRwLockShardedReleaseWrite(pLock)
+#endif // PORT_IS_FUNC_SUPPORTED(portSyncExRwLockInitializeSharded)
+
 
 void
 portSyncRwLockAcquireRead
@@ -73,6 +352,11 @@ portSyncRwLockAcquireRead
 )
 {
     PORT_ASSERT_CHECKED(pLock != NULL);
+    if (PORT_RWLOCK_IS_SHARDED(pLock))
+    {
+        _portSyncRwLockShardedAcquireRead(pLock);
+        return;
+    }
     portSyncSemaphoreAcquire(pLock->pSemRead);
     if (portAtomicIncrementS32(&pLock->numReaders) == 1)
     {
@@ -89,6 +373,10 @@ portSyncRwLockAcquireReadConditional
 {
     NvBool bAcquired;
     PORT_ASSERT_CHECKED(pLock != NULL);
+    if (PORT_RWLOCK_IS_SHARDED(pLock))
+    {
+        return _portSyncRwLockShardedTryRead(pLock);
+    }
     bAcquired = portSyncSemaphoreAcquireConditional(pLock->pSemRead);
     if (!bAcquired)
     {
@@ -113,6 +401,11 @@ portSyncRwLockAcquireWrite
 )
 {
     PORT_ASSERT_CHECKED(pLock != NULL);
+    if (PORT_RWLOCK_IS_SHARDED(pLock))
+    {
+        _portSyncRwLockShardedAcquireWrite(pLock);
+        return;
+    }
     portSyncSemaphoreAcquire(pLock->pSemRead);
     portSyncSemaphoreAcquire(pLock->pSemWrite);
     portSyncSemaphoreRelease(pLock->pSemRead);
@@ -126,6 +419,10 @@ portSyncRwLockAcquireWriteConditional
 {
     NvBool bAcquired;
     PORT_ASSERT_CHECKED(pLock != NULL);
+    if (PORT_RWLOCK_IS_SHARDED(pLock))
+    {
+        return _portSyncRwLockShardedAcquireWriteConditional(pLock);
+    }
     bAcquired = portSyncSemaphoreAcquireConditional(pLock->pSemRead);
     if (bAcquired)
     {
@@ -142,6 +439,11 @@ portSyncRwLockReleaseRead
 )
 {
     PORT_ASSERT_CHECKED(pLock != NULL);
+    if (PORT_RWLOCK_IS_SHARDED(pLock))
+    {
+        _portSyncRwLockShardedReleaseRead(pLock);
+        return;
+    }
     if (portAtomicDecrementS32(&pLock->numReaders) == 0)
     {
         portSyncSemaphoreRelease(pLock->pSemWrite);
@@ -155,6 +457,11 @@ portSyncRwLockReleaseWrite
 )
 {
     PORT_ASSERT_CHECKED(pLock != NULL);
+    if (PORT_RWLOCK_IS_SHARDED(pLock))
+    {
+        _portSyncRwLockShardedReleaseWrite(pLock);
+        return;
+    }
     portSyncSemaphoreRelease(pLock->pSemWrite);
 }
 
@@ -167,6 +474,11 @@ portSyncRwLockDestroy
     PORT_ASSERT_CHECKED(pLock != NULL);
     portSyncSemaphoreDestroy(pLock->pSemRead);
     portSyncSemaphoreDestroy(pLock->pSemWrite);
+    if (pLock->pShards != NULL)
+    {
+        portSyncSemaphoreDestroy(pLock->pSemDrained);
+        PORT_FREE(portMemAllocatorGetGlobalNonPaged(), pLock->pShards);
+    }
     if (pLock->pAllocator != NULL)
     {
         PORT_FREE(pLock->pAllocator, pLock);
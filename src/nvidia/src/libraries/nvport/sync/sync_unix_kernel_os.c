@@ -234,6 +234,15 @@ NvU64 portSyncExGetInterruptLevel()
     return !os_semaphore_may_sleep();
 }
 
+NvU32 _portSyncGetCpuIndex()
+{
+    return os_get_cpu_number();
+}
+NvU32 _portSyncGetCpuCount()
+{
+    return os_get_cpu_count();
+}
+
 // Include implementations common for all platforms
 #define PORT_SYNC_COMMON_DEFINE_SPINLOCK
 #define PORT_SYNC_COMMON_DEFINE_MUTEX
@@ -39,7 +39,7 @@
 static NV_STATUS _serverFindClient(RsServer *pServer, NvHandle hClient, RsClient **ppClient);
 
 /**
- * Get the CLIENT_ENTRY from a client handle without taking locks
+ * Get the CLIENT_ENTRY from a client handle. Never blocks.
  * @param[in]   pServer
  * @param[in]   hClient The handle to lookup
  * @param[in]   bFindPartial Include entries that have not finished constructing
@@ -47,6 +47,12 @@ static NV_STATUS _serverFindClient(RsServer *pServer, NvHandle hClient, RsClient
  */
 static NV_STATUS _serverFindClientEntry(RsServer *pServer, NvHandle hClient, NvBool bFindPartial, CLIENT_ENTRY **ppClientEntry);
 
+/**
+ * Same as _serverFindClientEntry, but the caller must hold pClientListLock or
+ * be in a read section of it
+ */
+static NV_STATUS _serverFindClientEntry_underlock(RsServer *pServer, NvHandle hClient, NvBool bFindPartial, CLIENT_ENTRY **ppClientEntry);
+
 /**
  * Insert a CLIENT_ENTRY in the server database without taking locks
  * @param[in]   pServer
@@ -54,6 +60,35 @@ static NV_STATUS _serverFindClientEntry(RsServer *pServer, NvHandle hClient, NvB
  */
 static NV_STATUS _serverInsertClientEntry(RsServer *pServer, CLIENT_ENTRY *pClientEntry, CLIENT_ENTRY **ppClientNext);
 
+/**
+ * Allocate an empty client hash table
+ * @param[in]   pAllocator
+ * @param[in]   size Number of slots, must be a power of two
+ */
+static RS_CLIENT_HASH_TABLE *_serverClientHashCreate(PORT_MEM_ALLOCATOR *pAllocator, NvU32 size);
+
+/**
+ * Add or remove a CLIENT_ENTRY from the client hash. Takes pClientListLock for write.
+ * @param[in]   pServer
+ * @param[in]   pClientEntry
+ */
+static NV_STATUS _serverClientHashInsert(RsServer *pServer, CLIENT_ENTRY *pClientEntry);
+static void _serverClientHashRemove(RsServer *pServer, NvHandle hClient, CLIENT_ENTRY *pClientEntry);
+
+/**
+ * Free replaced client hash tables once no lookup can still be walking them.
+ * The caller must hold pClientListLock for write.
+ * @param[in]   pServer
+ */
+static void _serverClientHashReclaim(RsServer *pServer);
+
+/**
+ * Drop a reference on a CLIENT_ENTRY, destroying its lock and freeing it on the last one.
+ * @param[in]   pServer
+ * @param[in]   pClientEntry
+ */
+static void _serverPutClientEntry(RsServer *pServer, CLIENT_ENTRY *pClientEntry);
+
 /**
  * Find the next available client handle in bucket.
  * @param[in]   pServer
@@ -208,6 +243,10 @@ NV_STATUS serverFreeResourceRpcUnderLock(RsServer *pServer, RS_RES_FREE_PARAMS *
 #define CLIENT_ENCODEHANDLE(index)                  (RS_CLIENT_HANDLE_BASE | index)
 #define CLIENT_ENCODEHANDLE_INTERNAL(internalBase, index)   (internalBase | index)
 
+// Client hash starts with one slot per sorted bucket and grows by doubling
+#define RS_CLIENT_HASH_INITIAL_SIZE                 RS_CLIENT_HANDLE_BUCKET_COUNT
+#define RS_CLIENT_HASH_TOMBSTONE                    ((CLIENT_ENTRY *)(NvUPtr)1)
+
 NV_STATUS
 serverConstruct
 (
@@ -240,7 +279,22 @@ serverConstruct
     }
     pServer->clientCurrentHandleIndex = 0;
 
+    pServer->pClientHashTable = _serverClientHashCreate(pAllocator, RS_CLIENT_HASH_INITIAL_SIZE);
+    if (pServer->pClientHashTable == NULL)
+        goto fail;
+    pServer->pClientHashRetired = NULL;
+
+    //
+    // Held for write when a client is added to or removed from the hash.
+    // Client hash probes (_serverFindClientEntry) only enter a read section,
+    // which never blocks, so they are safe at raised IRQL. The per-CPU reader
+    // shards also keep _serverLockClient's read side on a local counter.
+    //
+#if PORT_IS_FUNC_SUPPORTED(portSyncExRwLockCreateSharded)
+    pServer->pClientListLock = portSyncExRwLockCreateSharded(pAllocator);
+#else
     pServer->pClientListLock = portSyncRwLockCreate(pAllocator);
+#endif
     if (pServer->pClientListLock == NULL)
         goto fail;
 
@@ -299,6 +353,9 @@ fail:
         PORT_FREE(pAllocator, pServer->pClientSortedList);
     }
 
+    if (pServer->pClientHashTable != NULL)
+        PORT_FREE(pAllocator, pServer->pClientHashTable);
+
     if (pAllocator != NULL)
         portMemAllocatorRelease(pAllocator);
 
@@ -337,6 +394,15 @@ serverDestruct
     }
 
     PORT_FREE(pServer->pAllocator, pServer->pClientSortedList);
+
+    // No lookups are left, so every replaced table can go.
+    while (pServer->pClientHashRetired != NULL)
+    {
+        RS_CLIENT_HASH_TABLE *pRetired = pServer->pClientHashRetired;
+        pServer->pClientHashRetired = pRetired->pNextRetired;
+        PORT_FREE(pServer->pAllocator, pRetired);
+    }
+    PORT_FREE(pServer->pAllocator, pServer->pClientHashTable);
     mapDestroy(&pServer->shareMap);
     listDestroy(&pServer->defaultInheritedSharePolicyList);
     listDestroy(&pServer->globalInternalSharePolicyList);
@@ -386,11 +452,15 @@ _serverFreeClient_underlock
     objDelete(pClient);
 
     listRemoveFirstByValue(&pServer->pClientSortedList[hClient & RS_CLIENT_HANDLE_BUCKET_MASK], &pClientEntry);
+    _serverClientHashRemove(pServer, hClient, pClientEntry);
     pLock = pClientEntry->pLock;
 
+    //
+    // Threads that looked the entry up before it left the hash may still be
+    // waiting on pLock; the last of them frees the entry.
+    //
     RS_RWLOCK_RELEASE_WRITE_EXT(pLock, &pClientEntry->lockVal, NV_TRUE);
-    portSyncRwLockDestroy(pLock);
-    PORT_FREE(pServer->pAllocator, pClientEntry);
+    _serverPutClientEntry(pServer, pClientEntry);
 
     return NV_OK;
 }
@@ -520,6 +590,10 @@ serverAllocClient
     portAtomicIncrementU32(&pServer->activeClientCount);
 
 done:
+    // Threads already waiting on the client lock must not see a half-constructed client
+    if ((status != NV_OK) && (pClientEntry != NULL))
+        pClientEntry->pClient = NULL;
+
     if (bLockedClient)
         _serverUnlockClient(pServer, LOCK_ACCESS_WRITE, pParams->hClient);
 
@@ -528,8 +602,8 @@ done:
         if (_serverFindClientEntry(pServer, hClient, NV_TRUE, &pClientEntry) == NV_OK)
         {
             listRemoveFirstByValue(&pServer->pClientSortedList[hClient & RS_CLIENT_HANDLE_BUCKET_MASK], &pClientEntry);
-            portSyncRwLockDestroy(pClientEntry->pLock);
-            PORT_FREE(pServer->pAllocator, pClientEntry);
+            _serverClientHashRemove(pServer, hClient, pClientEntry);
+            _serverPutClientEntry(pServer, pClientEntry);
         }
 
         if (pClient != NULL)
@@ -1929,48 +2003,315 @@ serverReleaseClient
 }
 
 static
-NV_STATUS
-_serverFindClientEntry
+NvU32
+_serverClientHashIndex
 (
-    RsServer      *pServer,
-    NvHandle       hClient,
-    NvBool         bFindPartial,
-    CLIENT_ENTRY **ppClientEntry
+    NvHandle hClient,
+    NvU32    size
+)
+{
+    //
+    // Internal and external handles share their low bits, so mix the whole
+    // handle in rather than masking it like the sorted buckets do.
+    //
+    return (NvU32)(((NvU64)hClient * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+static
+RS_CLIENT_HASH_TABLE *
+_serverClientHashCreate
+(
+    PORT_MEM_ALLOCATOR *pAllocator,
+    NvU32               size
 )
 {
-    RsClientList  *pClientList       = &(pServer->pClientSortedList[hClient & RS_CLIENT_HANDLE_BUCKET_MASK]);
-    CLIENT_ENTRY **ppClientEntryLoop = listHead(pClientList);
+    RS_CLIENT_HASH_TABLE *pTable;
+    NvLength              slotsSize = sizeof(CLIENT_ENTRY *) * size;
 
-    if (ppClientEntry != NULL)
-        *ppClientEntry = NULL;
+    pTable = PORT_ALLOC(pAllocator, sizeof(*pTable) + slotsSize);
+    if (pTable == NULL)
+        return NULL;
+
+    pTable->size         = size;
+    pTable->numLive      = 0;
+    pTable->numUsed      = 0;
+    pTable->pNextRetired = NULL;
+    pTable->pSlots       = (CLIENT_ENTRY * volatile *)(pTable + 1);
+    portMemSet((void *)pTable->pSlots, 0, slotsSize);
+
+    return pTable;
+}
 
-    while (ppClientEntryLoop != NULL)
+static
+CLIENT_ENTRY *
+_serverClientHashLookup
+(
+    RsServer *pServer,
+    NvHandle  hClient
+)
+{
+    RS_CLIENT_HASH_TABLE *pTable;
+    NvU32 mask;
+    NvU32 idx;
+    NvU32 i;
+
+    // Pairs with the portAtomicSetSize() that publishes a rebuilt table
+    pTable = (RS_CLIENT_HASH_TABLE *)portAtomicOrSize(&pServer->pClientHashTable, 0);
+    mask   = pTable->size - 1;
+    idx    = _serverClientHashIndex(hClient, pTable->size);
+
+    for (i = 0; i < pTable->size; i++)
     {
-        CLIENT_ENTRY *pClientEntry = *ppClientEntryLoop;
-        ppClientEntryLoop = listNext(pClientList, ppClientEntryLoop);
+        CLIENT_ENTRY *pClientEntry = pTable->pSlots[idx];
+
         if (pClientEntry == NULL)
+            break;
+
+        if ((pClientEntry != RS_CLIENT_HASH_TOMBSTONE) &&
+            (pClientEntry->hClient == hClient))
         {
-            continue;
+            return pClientEntry;
         }
-        else if (pClientEntry->hClient == hClient)
-        {
-            // Client may not have finished constructing yet
-            if (pClientEntry->pClient == NULL && !bFindPartial)
-                return NV_ERR_INVALID_OBJECT_HANDLE;
 
-            if (ppClientEntry != NULL)
-                *ppClientEntry = pClientEntry;
+        idx = (idx + 1) & mask;
+    }
 
-            return NV_OK;
+    return NULL;
+}
+
+//
+// Place pClientEntry in the first free or tombstoned slot of its probe chain.
+// Slots are published with a full barrier so that a reader never sees an
+// entry before its fields are initialized.
+//
+static
+void
+_serverClientHashPlace
+(
+    RS_CLIENT_HASH_TABLE *pTable,
+    CLIENT_ENTRY         *pClientEntry
+)
+{
+    NvU32 mask = pTable->size - 1;
+    NvU32 idx  = _serverClientHashIndex(pClientEntry->hClient, pTable->size);
+
+    while ((pTable->pSlots[idx] != NULL) &&
+           (pTable->pSlots[idx] != RS_CLIENT_HASH_TOMBSTONE))
+    {
+        idx = (idx + 1) & mask;
+    }
+
+    if (pTable->pSlots[idx] == NULL)
+        pTable->numUsed++;
+    pTable->numLive++;
+
+    portAtomicSetSize(&pTable->pSlots[idx], pClientEntry);
+}
+
+static
+NV_STATUS
+_serverClientHashInsert
+(
+    RsServer     *pServer,
+    CLIENT_ENTRY *pClientEntry
+)
+{
+    RS_CLIENT_HASH_TABLE *pTable;
+    NV_STATUS             status = NV_OK;
+
+    portSyncRwLockAcquireWrite(pServer->pClientListLock);
+
+    pTable = pServer->pClientHashTable;
+
+    //
+    // Keep the load factor, tombstones included, under 3/4. Rebuilding also
+    // shrinks the table back down once most clients have gone away.
+    //
+    if ((pTable->numUsed + 1) * 4 > pTable->size * 3)
+    {
+        RS_CLIENT_HASH_TABLE *pNewTable;
+        NvU32 newSize = RS_CLIENT_HASH_INITIAL_SIZE;
+        NvU32 i;
+
+        while (newSize < (pTable->numLive + 1) * 2)
+            newSize <<= 1;
+
+        pNewTable = _serverClientHashCreate(pServer->pAllocator, newSize);
+        if (pNewTable == NULL)
+        {
+            status = NV_ERR_INSUFFICIENT_RESOURCES;
+            goto done;
         }
-        else if (pClientEntry->hClient > hClient)
+
+        for (i = 0; i < pTable->size; i++)
+        {
+            CLIENT_ENTRY *pEntry = pTable->pSlots[i];
+            if ((pEntry != NULL) && (pEntry != RS_CLIENT_HASH_TOMBSTONE))
+                _serverClientHashPlace(pNewTable, pEntry);
+        }
+
+        //
+        // Lookups do not take pClientListLock, so one may still be walking
+        // the old table. Retire it, and free it once they have all drained.
+        //
+        portAtomicSetSize(&pServer->pClientHashTable, pNewTable);
+        pTable->pNextRetired = pServer->pClientHashRetired;
+        pServer->pClientHashRetired = pTable;
+        pTable = pNewTable;
+    }
+
+    _serverClientHashPlace(pTable, pClientEntry);
+
+done:
+    _serverClientHashReclaim(pServer);
+    portSyncRwLockReleaseWrite(pServer->pClientListLock);
+    return status;
+}
+
+static
+void
+_serverClientHashRemove
+(
+    RsServer     *pServer,
+    NvHandle      hClient,
+    CLIENT_ENTRY *pClientEntry
+)
+{
+    RS_CLIENT_HASH_TABLE *pTable;
+    NvU32 mask;
+    NvU32 idx;
+    NvU32 i;
+
+    portSyncRwLockAcquireWrite(pServer->pClientListLock);
+
+    pTable = pServer->pClientHashTable;
+    mask   = pTable->size - 1;
+    idx    = _serverClientHashIndex(hClient, pTable->size);
+
+    for (i = 0; i < pTable->size; i++)
+    {
+        if (pTable->pSlots[idx] == pClientEntry)
         {
-            // Not found in sorted list
-            return NV_ERR_INVALID_OBJECT;
+            portAtomicSetSize(&pTable->pSlots[idx], RS_CLIENT_HASH_TOMBSTONE);
+            pTable->numLive--;
+            break;
         }
+        NV_ASSERT_OR_ELSE(pTable->pSlots[idx] != NULL, break);
+        idx = (idx + 1) & mask;
     }
 
-    return NV_ERR_INVALID_OBJECT_HANDLE;
+    _serverClientHashReclaim(pServer);
+    portSyncRwLockReleaseWrite(pServer->pClientListLock);
+}
+
+static
+void
+_serverClientHashReclaim
+(
+    RsServer *pServer
+)
+{
+    if (pServer->pClientHashRetired == NULL)
+        return;
+
+#if PORT_IS_FUNC_SUPPORTED(portSyncExRwLockReadSectionsDrained)
+    //
+    // The tables were unpublished before this check, so a lookup that is
+    // still walking one of them holds a read section. Try again on the next
+    // write otherwise; lookups are short.
+    //
+    if (!portSyncExRwLockReadSectionsDrained(pServer->pClientListLock))
+        return;
+#endif
+
+    while (pServer->pClientHashRetired != NULL)
+    {
+        RS_CLIENT_HASH_TABLE *pRetired = pServer->pClientHashRetired;
+        pServer->pClientHashRetired = pRetired->pNextRetired;
+        PORT_FREE(pServer->pAllocator, pRetired);
+    }
+}
+
+static
+void
+_serverPutClientEntry
+(
+    RsServer     *pServer,
+    CLIENT_ENTRY *pClientEntry
+)
+{
+    if (portAtomicDecrementU32(&pClientEntry->refCount) == 0)
+    {
+        portSyncRwLockDestroy(pClientEntry->pLock);
+        PORT_FREE(pServer->pAllocator, pClientEntry);
+    }
+}
+
+//
+// This is reached at raised IRQL (serverGetClientUnderLock from deferred and
+// IRQL_RAISED controls), so it must not block. The probe runs in a read
+// section of pClientListLock, which only bumps a per-CPU counter and keeps a
+// table replaced by a concurrent rebuild from being freed underneath us.
+// Callers that keep using the entry afterwards without holding a reference
+// must be serialized against client alloc and free by other means (the RM
+// API lock), as has always been the case.
+//
+static
+NV_STATUS
+_serverFindClientEntry
+(
+    RsServer      *pServer,
+    NvHandle       hClient,
+    NvBool         bFindPartial,
+    CLIENT_ENTRY **ppClientEntry
+)
+{
+    NV_STATUS status;
+#if PORT_IS_FUNC_SUPPORTED(portSyncExRwLockEnterReadSection)
+    NvU32 shard;
+
+    shard = portSyncExRwLockEnterReadSection(pServer->pClientListLock);
+    status = _serverFindClientEntry_underlock(pServer, hClient, bFindPartial, ppClientEntry);
+    portSyncExRwLockExitReadSection(pServer->pClientListLock, shard);
+#else
+    portSyncRwLockAcquireRead(pServer->pClientListLock);
+    status = _serverFindClientEntry_underlock(pServer, hClient, bFindPartial, ppClientEntry);
+    portSyncRwLockReleaseRead(pServer->pClientListLock);
+#endif
+
+    return status;
+}
+
+static
+NV_STATUS
+_serverFindClientEntry_underlock
+(
+    RsServer      *pServer,
+    NvHandle       hClient,
+    NvBool         bFindPartial,
+    CLIENT_ENTRY **ppClientEntry
+)
+{
+    CLIENT_ENTRY *pClientEntry;
+
+    if (ppClientEntry != NULL)
+        *ppClientEntry = NULL;
+
+    if (hClient == 0)
+        return NV_ERR_INVALID_OBJECT_HANDLE;
+
+    pClientEntry = _serverClientHashLookup(pServer, hClient);
+    if (pClientEntry == NULL)
+        return NV_ERR_INVALID_OBJECT_HANDLE;
+
+    // Client may not have finished constructing yet
+    if (pClientEntry->pClient == NULL && !bFindPartial)
+        return NV_ERR_INVALID_OBJECT_HANDLE;
+
+    if (ppClientEntry != NULL)
+        *ppClientEntry = pClientEntry;
+
+    return NV_OK;
 }
 
 static
@@ -2006,6 +2347,7 @@ _serverInsertClientEntry
     RsClientList  *pClientList;
     CLIENT_ENTRY **ppClientEntry;
     NvHandle       hClient = pClientEntry->hClient;
+    NV_STATUS      status;
 
     if (hClient == 0)
     {
@@ -2022,8 +2364,19 @@ _serverInsertClientEntry
     {
         ppClientEntry = (CLIENT_ENTRY **)listInsertNew(pClientList, ppClientNext);
     }
+    if (ppClientEntry == NULL)
+    {
+        return NV_ERR_INSUFFICIENT_RESOURCES;
+    }
     *ppClientEntry = pClientEntry;
 
+    status = _serverClientHashInsert(pServer, pClientEntry);
+    if (status != NV_OK)
+    {
+        listRemove(pClientList, ppClientEntry);
+        return status;
+    }
+
     return NV_OK;
 }
 
@@ -2181,6 +2534,7 @@ _serverCreateEntryAndLockForNewClient
 
     pClientEntry->hClient = hClient;
     pClientEntry->pLock = pLock;
+    pClientEntry->refCount = 1;
 
 
     RS_LOCK_VALIDATOR_INIT(&pClientEntry->lockVal,
@@ -2222,7 +2576,17 @@ _serverLockClient
     CLIENT_ENTRY *pClientEntry = NULL;
     NV_STATUS status = NV_OK;
 
-    status =_serverFindClientEntry(pServer, hClient, NV_FALSE, &pClientEntry);
+    //
+    // The entry may be freed while we block on its lock, so pin it first.
+    // Holding pClientListLock for read keeps it in the hash until the pin is
+    // taken; this path blocks on the client lock anyway.
+    //
+    portSyncRwLockAcquireRead(pServer->pClientListLock);
+    status = _serverFindClientEntry_underlock(pServer, hClient, NV_FALSE, &pClientEntry);
+    if (status == NV_OK)
+        portAtomicIncrementU32(&pClientEntry->refCount);
+    portSyncRwLockReleaseRead(pServer->pClientListLock);
+
     if (status != NV_OK)
     {
         return status;
@@ -2232,6 +2596,7 @@ _serverLockClient
 
     if (pClientEntry->pLock == NULL)
     {
+        _serverPutClientEntry(pServer, pClientEntry);
         return NV_ERR_INVALID_OBJECT_HANDLE;
     }
 
@@ -2246,18 +2611,24 @@ _serverLockClient
     }
 
     pClient = pClientEntry->pClient;
-    NV_ASSERT(pClient->hClient == pClientEntry->hClient);
 
     if ((pClient == NULL) || (pClient->hClient != hClient))
     {
+        // Client was freed while we waited for its lock
         if (access == LOCK_ACCESS_READ)
             RS_RWLOCK_RELEASE_READ(pClientEntry->pLock, &pClientEntry->lockVal);
         else
             RS_RWLOCK_RELEASE_WRITE(pClientEntry->pLock, &pClientEntry->lockVal);
 
+        _serverPutClientEntry(pServer, pClientEntry);
         return NV_ERR_INVALID_OBJECT;
     }
 
+    NV_ASSERT(pClient->hClient == pClientEntry->hClient);
+
+    // The client can't be freed while we hold its lock, so the hash keeps the entry alive
+    _serverPutClientEntry(pServer, pClientEntry);
+
     if (ppClient != NULL)
         *ppClient = pClient;
 
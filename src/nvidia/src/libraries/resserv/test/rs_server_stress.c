@@ -0,0 +1,355 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief User-space stress test for resserv client handle lookup.
+ *
+ * Built with RS_STANDALONE=1 and RS_STANDALONE_TEST=1 against the user-mode
+ * NvPort and NVOC runtime. For each client count, a set of background clients
+ * is allocated first. Worker threads then loop over:
+ *  - allocating and freeing a client of their own (alloc/free throughput), and
+ *  - looking up random background clients the way a control call does:
+ *    serverGetClientUnderLock() without the client lock, followed by
+ *    serverAcquireClient()/serverReleaseClient() (control throughput).
+ *
+ * Lookups run concurrently with the hash inserts, removals and rebuilds done
+ * by the alloc/free side, so every lookup of a background client must succeed
+ * and return the client it was asked for.
+ *
+ * Usage: rs_server_stress [numThreads] [iterationsPerThread]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "nvport/nvport.h"
+#include "resserv/resserv.h"
+#include "resserv/rs_server.h"
+#include "resserv/rs_client.h"
+#include "resserv/rs_resource.h"
+#include "class/cl0000.h"
+
+int g_debugLevel = 0;
+
+static RsServer g_server;
+
+static const NvU32 g_clientCounts[] = { 1, 16, 256, 4096, 16384 };
+
+#define RS_STRESS_LOOKUPS_PER_ALLOC 16
+
+typedef struct
+{
+    NvHandle *pClients;
+    NvU32     numClients;
+    NvU32     numIterations;
+    NvU32     seed;
+    NvU64     numAllocs;
+    NvU64     numLookups;
+    NvU64     allocNs;
+    NvU64     lookupNs;
+    NvU32     numErrors;
+} RS_STRESS_THREAD;
+
+//
+// Hooks resserv expects from the application
+//
+NV_STATUS
+resservClientFactory
+(
+    PORT_MEM_ALLOCATOR *pAllocator,
+    RS_RES_ALLOC_PARAMS_INTERNAL *pParams,
+    RsClient **ppRsClient
+)
+{
+    return objCreate(ppRsClient, NVOC_NULL_OBJECT, RsClient, pAllocator, pParams);
+}
+
+NV_STATUS
+resservResourceFactory
+(
+    PORT_MEM_ALLOCATOR *pAllocator,
+    CALL_CONTEXT *pCallContext,
+    RS_RES_ALLOC_PARAMS_INTERNAL *pParams,
+    RsResource **ppResource
+)
+{
+    RsClientResource *pClientResource;
+    NV_STATUS status;
+
+    // The only resource allocated here is the client's own proxy resource
+    status = objCreate(&pClientResource, NVOC_NULL_OBJECT, RsClientResource, pCallContext, pParams);
+    if (status != NV_OK)
+        return status;
+
+    *ppResource = staticCast(pClientResource, RsResource);
+    return NV_OK;
+}
+
+NV_STATUS
+osValidateClientTokens
+(
+    PSECURITY_TOKEN pClientToken,
+    PSECURITY_TOKEN pCurrentToken
+)
+{
+    return NV_OK;
+}
+
+PSECURITY_TOKEN
+osGetSecurityToken(void)
+{
+    return NULL;
+}
+
+static NvU64
+_rsStressNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (NvU64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static NV_STATUS
+_rsStressAllocClient
+(
+    NvHandle *phClient
+)
+{
+    RS_RES_ALLOC_PARAMS params;
+    RS_LOCK_INFO        lockInfo;
+    API_SECURITY_INFO   secInfo;
+    NV_STATUS           status;
+
+    portMemSet(&params, 0, sizeof(params));
+    portMemSet(&lockInfo, 0, sizeof(lockInfo));
+    portMemSet(&secInfo, 0, sizeof(secInfo));
+
+    secInfo.privLevel       = RS_PRIV_LEVEL_KERNEL;
+    secInfo.paramLocation   = PARAM_LOCATION_KERNEL;
+    params.externalClassId  = NV01_ROOT;
+    params.pLockInfo        = &lockInfo;
+    params.pSecInfo         = &secInfo;
+
+    status = serverAllocResource(&g_server, &params);
+    *phClient = params.hClient;
+    return status;
+}
+
+static NV_STATUS
+_rsStressFreeClient
+(
+    NvHandle hClient
+)
+{
+    RS_RES_FREE_PARAMS freeParams;
+    RS_LOCK_INFO       lockInfo;
+
+    portMemSet(&lockInfo, 0, sizeof(lockInfo));
+    serverInitFreeParams_Recursive(hClient, hClient, &lockInfo, &freeParams);
+    return serverFreeResourceTree(&g_server, &freeParams);
+}
+
+static NvBool
+_rsStressLookupClient
+(
+    NvHandle hClient
+)
+{
+    RsClient *pClient;
+    RsClient *pLockedClient;
+
+    // Lookup done by controls that run without the client lock
+    if ((serverGetClientUnderLock(&g_server, hClient, &pClient) != NV_OK) ||
+        (pClient->hClient != hClient))
+    {
+        return NV_FALSE;
+    }
+
+    // Lookup and pin done by controls that take the client lock
+    if (serverAcquireClient(&g_server, hClient, LOCK_ACCESS_READ, &pLockedClient) != NV_OK)
+        return NV_FALSE;
+
+    serverReleaseClient(&g_server, LOCK_ACCESS_READ, pLockedClient);
+    return pLockedClient == pClient;
+}
+
+static void *
+_rsStressThread
+(
+    void *pArg
+)
+{
+    RS_STRESS_THREAD *pThread = pArg;
+    NvU32 i, j;
+
+    for (i = 0; i < pThread->numIterations; i++)
+    {
+        NvHandle hClient;
+        NvU64 start;
+
+        start = _rsStressNowNs();
+        if (_rsStressAllocClient(&hClient) == NV_OK)
+        {
+            if (_rsStressFreeClient(hClient) != NV_OK)
+                pThread->numErrors++;
+            pThread->numAllocs++;
+        }
+        else
+        {
+            pThread->numErrors++;
+        }
+        pThread->allocNs += _rsStressNowNs() - start;
+
+        start = _rsStressNowNs();
+        for (j = 0; j < RS_STRESS_LOOKUPS_PER_ALLOC; j++)
+        {
+            NvU32 idx = rand_r(&pThread->seed) % pThread->numClients;
+
+            if (!_rsStressLookupClient(pThread->pClients[idx]))
+                pThread->numErrors++;
+            pThread->numLookups++;
+        }
+        pThread->lookupNs += _rsStressNowNs() - start;
+    }
+
+    return NULL;
+}
+
+static NvU32
+_rsStressRun
+(
+    NvU32 numClients,
+    NvU32 numThreads,
+    NvU32 numIterations
+)
+{
+    NvHandle         *pClients;
+    RS_STRESS_THREAD *pThreads;
+    pthread_t        *pTids;
+    NvU64             numAllocs = 0, numLookups = 0;
+    NvU64             allocNs = 0, lookupNs = 0;
+    NvU32             numErrors = 0;
+    NvU32             i;
+
+    pClients = calloc(numClients, sizeof(*pClients));
+    pThreads = calloc(numThreads, sizeof(*pThreads));
+    pTids    = calloc(numThreads, sizeof(*pTids));
+    if ((pClients == NULL) || (pThreads == NULL) || (pTids == NULL))
+    {
+        fprintf(stderr, "rs_server_stress: out of memory\n");
+        exit(1);
+    }
+
+    for (i = 0; i < numClients; i++)
+    {
+        if (_rsStressAllocClient(&pClients[i]) != NV_OK)
+        {
+            fprintf(stderr, "rs_server_stress: failed to allocate client %u\n", i);
+            exit(1);
+        }
+    }
+
+    for (i = 0; i < numThreads; i++)
+    {
+        pThreads[i].pClients      = pClients;
+        pThreads[i].numClients    = numClients;
+        pThreads[i].numIterations = numIterations;
+        pThreads[i].seed          = i + 1;
+        pthread_create(&pTids[i], NULL, _rsStressThread, &pThreads[i]);
+    }
+
+    for (i = 0; i < numThreads; i++)
+    {
+        pthread_join(pTids[i], NULL);
+        numAllocs  += pThreads[i].numAllocs;
+        numLookups += pThreads[i].numLookups;
+        allocNs    += pThreads[i].allocNs;
+        lookupNs   += pThreads[i].lookupNs;
+        numErrors  += pThreads[i].numErrors;
+    }
+
+    // Rates are per thread, averaged over all threads
+    printf("clients %6u threads %3u: alloc+free %10.0f/s  control lookup %10.0f/s  errors %u\n",
+           numClients, numThreads,
+           allocNs ? (double)numAllocs * 1e9 / allocNs : 0.0,
+           lookupNs ? (double)numLookups * 1e9 / lookupNs : 0.0,
+           numErrors);
+
+    for (i = 0; i < numClients; i++)
+    {
+        if (_rsStressFreeClient(pClients[i]) != NV_OK)
+            numErrors++;
+    }
+
+    if (serverGetClientCount(&g_server) != 0)
+    {
+        fprintf(stderr, "rs_server_stress: %u clients leaked\n", serverGetClientCount(&g_server));
+        numErrors++;
+    }
+
+    free(pTids);
+    free(pThreads);
+    free(pClients);
+
+    return numErrors;
+}
+
+int
+main
+(
+    int argc,
+    char **argv
+)
+{
+    NvU32 numThreads    = (argc > 1) ? (NvU32)atoi(argv[1]) : 8;
+    NvU32 numIterations = (argc > 2) ? (NvU32)atoi(argv[2]) : 10000;
+    NvU32 numErrors     = 0;
+    NvU32 i;
+
+    if ((numThreads == 0) || (numIterations == 0))
+    {
+        fprintf(stderr, "usage: %s [numThreads] [iterationsPerThread]\n", argv[0]);
+        return 1;
+    }
+
+    if (portInitialize() != NV_OK)
+        return 1;
+
+    if (serverConstruct(&g_server, RS_PRIV_LEVEL_KERNEL, 0) != NV_OK)
+    {
+        fprintf(stderr, "rs_server_stress: serverConstruct failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(g_clientCounts) / sizeof(g_clientCounts[0]); i++)
+        numErrors += _rsStressRun(g_clientCounts[i], numThreads, numIterations);
+
+    serverDestruct(&g_server);
+    portShutdown();
+
+    return (numErrors == 0) ? 0 : 1;
+}